@@ -91,6 +91,12 @@ else()
   message(STATUS "Build git_id          : No  (default)")
 endif()
 
+if(BUILD_BENCHMARKS)
+  message(STATUS "Build benchmarks      : Yes")
+else()
+  message(STATUS "Build benchmarks      : No  (default)")
+endif()
+
 if(CMAKE_INTERPROCEDURAL_OPTIMIZATION)
   message(STATUS "Link-time optimizations : Yes")
 else()
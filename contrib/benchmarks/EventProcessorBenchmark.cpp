@@ -0,0 +1,323 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Replays a unit event load against EventProcessor and against the std::multimap queue it replaced, checks that
+// both execute and abort the same events at the same times and in the same order, and reports their run times.
+//
+// Usage: event_processor_benchmark [repeats]
+
+#include "Utilities/EventProcessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // the queue EventProcessor used before the timer wheel, kept as reference for order and speed
+    class MultimapEventProcessor
+    {
+        public:
+            ~MultimapEventProcessor() { KillAllEvents(true); }
+
+            void Update(uint32 p_time)
+            {
+                m_time += p_time;
+
+                std::multimap<uint64, BasicEvent*>::iterator i;
+                while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+                {
+                    BasicEvent* Event = i->second;
+                    m_events.erase(i);
+
+                    if (!Event->to_Abort)
+                    {
+                        if (Event->Execute(m_time, p_time))
+                            delete Event;
+                    }
+                    else
+                    {
+                        Event->Abort(m_time);
+                        delete Event;
+                    }
+                }
+            }
+
+            void KillAllEvents(bool force)
+            {
+                for (auto i = m_events.begin(); i != m_events.end();)
+                {
+                    auto i_old = i;
+                    ++i;
+
+                    i_old->second->to_Abort = true;
+                    i_old->second->Abort(m_time);
+                    if (force || i_old->second->IsDeletable())
+                    {
+                        delete i_old->second;
+
+                        if (!force)
+                            m_events.erase(i_old);
+                    }
+                }
+
+                if (force)
+                    m_events.clear();
+            }
+
+            void KillEvent(BasicEvent* event)
+            {
+                for (auto iter = m_events.begin(); iter != m_events.end();)
+                {
+                    if (iter->second == event)
+                    {
+                        delete iter->second;
+                        iter = m_events.erase(iter);
+                    }
+                    else ++iter;
+                }
+            }
+
+            void AddEvent(BasicEvent* Event, uint64 e_time)
+            {
+                Event->m_addTime = m_time;
+                Event->m_execTime = e_time;
+                m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+            }
+
+            void ModifyEventTime(BasicEvent* Event, uint64 msTime)
+            {
+                for (auto itr = m_events.begin(); itr != m_events.end(); ++itr)
+                {
+                    if (itr->second != Event)
+                        continue;
+
+                    Event->m_execTime = msTime;
+                    m_events.erase(itr);
+                    m_events.insert(std::pair<uint64, BasicEvent*>(msTime, Event));
+                    break;
+                }
+            }
+
+            uint64 CalculateTime(uint64 t_offset) const { return m_time + t_offset; }
+
+        private:
+            uint64 m_time = 0;
+            std::multimap<uint64, BasicEvent*> m_events;
+    };
+
+    // what happened to which event when, compared between the queues
+    typedef std::vector<uint64> Trace;
+
+    void Record(Trace& trace, uint32 id, uint64 time, bool aborted)
+    {
+        trace.push_back((time << 33) | (uint64(id) << 1) | (aborted ? 1 : 0));
+    }
+
+    template<class Processor>
+    struct Owner
+    {
+        std::unique_ptr<Processor> events = std::make_unique<Processor>();
+        BasicEvent* notify = nullptr;                       // pending AI notify, replaced by newer ones
+        BasicEvent* spellHit = nullptr;                     // pending spell hit, may be delayed
+    };
+
+    template<class Processor>
+    struct Replay
+    {
+        Trace trace;
+        uint32 nextId = 0;
+    };
+
+    template<class Processor>
+    class TracedEvent : public BasicEvent
+    {
+        public:
+            enum Kind { ONESHOT, NOTIFY, SPELL_HIT, PERIODIC, CHAIN };
+
+            TracedEvent(Replay<Processor>& replay, Owner<Processor>& owner, Kind kind, uint32 value = 0)
+                : m_replay(replay), m_owner(owner), m_kind(kind), m_value(value), m_id(replay.nextId++) {}
+
+            bool Execute(uint64 e_time, uint32 /*p_time*/) override
+            {
+                Record(m_replay.trace, m_id, e_time, false);
+                switch (m_kind)
+                {
+                    case NOTIFY:
+                        m_owner.notify = nullptr;
+                        break;
+                    case SPELL_HIT:
+                        m_owner.spellHit = nullptr;
+                        break;
+                    case PERIODIC:                          // re-added by itself, as a periodic script timer
+                        m_owner.events->AddEvent(this, m_owner.events->CalculateTime(m_value));
+                        return false;
+                    case CHAIN:                             // triggers the next step without delay
+                        if (m_value)
+                            m_owner.events->AddEvent(new TracedEvent(m_replay, m_owner, CHAIN, m_value - 1), m_owner.events->CalculateTime(0));
+                        break;
+                    default:
+                        break;
+                }
+                return true;
+            }
+
+            void Abort(uint64 e_time) override
+            {
+                Record(m_replay.trace, m_id, e_time, true);
+            }
+
+        private:
+            Replay<Processor>& m_replay;
+            Owner<Processor>& m_owner;
+            Kind m_kind;
+            uint32 m_value;
+            uint32 m_id;
+    };
+
+    struct Scenario
+    {
+        char const* name;
+        uint32 owners;
+        uint32 ticks;
+        uint32 activity;                                    // percent chance per owner and tick to queue something
+        uint32 periodicPerOwner;
+    };
+
+    template<class Processor>
+    Trace Run(Scenario const& scenario, double& elapsedMs)
+    {
+        typedef TracedEvent<Processor> Event;
+
+        Replay<Processor> replay;
+        replay.trace.reserve(scenario.owners * scenario.ticks / 2);
+        std::vector<Owner<Processor>> owners(scenario.owners);
+        std::mt19937 random(12345);
+        auto roll = [&random](uint32 max) { return uint32(random() % max); };
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (Owner<Processor>& owner : owners)
+            for (uint32 i = 0; i < scenario.periodicPerOwner; ++i)
+                owner.events->AddEvent(new Event(replay, owner, Event::PERIODIC, 1000 + roll(4000)), owner.events->CalculateTime(roll(5000)));
+
+        for (uint32 tick = 0; tick < scenario.ticks; ++tick)
+        {
+            // map update diffs, sometimes an object is updated twice in one tick or skipped for a while
+            uint32 diff = roll(20) == 0 ? 0 : (roll(50) == 0 ? 200 + roll(800) : 40 + roll(30));
+
+            for (Owner<Processor>& owner : owners)
+            {
+                Processor& events = *owner.events;
+                if (roll(100) < scenario.activity)
+                {
+                    switch (roll(8))
+                    {
+                        case 0:                             // AI notify, a newer one replaces the pending one
+                        case 1:
+                            if (owner.notify)
+                                events.KillEvent(owner.notify);
+                            owner.notify = new Event(replay, owner, Event::NOTIFY);
+                            events.AddEvent(owner.notify, events.CalculateTime(roll(500)));
+                            break;
+                        case 2:                             // delayed spell hit, pushed back now and then
+                            if (owner.spellHit)
+                                events.ModifyEventTime(owner.spellHit, events.CalculateTime(roll(1500)));
+                            else
+                            {
+                                owner.spellHit = new Event(replay, owner, Event::SPELL_HIT);
+                                events.AddEvent(owner.spellHit, events.CalculateTime(100 + roll(2000)));
+                            }
+                            break;
+                        case 3:                             // chain of zero delay events
+                            events.AddEvent(new Event(replay, owner, Event::CHAIN, 3), events.CalculateTime(0));
+                            break;
+                        case 4:                             // despawn and respawn timers, some beyond the wheel
+                            events.AddEvent(new Event(replay, owner, Event::ONESHOT), events.CalculateTime(300000 + roll(20000000)));
+                            break;
+                        case 5:                             // owner died, its events are aborted and it starts over
+                            if (roll(20) == 0)
+                            {
+                                events.KillAllEvents(false);
+                                owner.events = std::make_unique<Processor>();
+                                owner.notify = owner.spellHit = nullptr;
+                                break;
+                            }
+                            [[fallthrough]];
+                        default:                            // short one shot timers
+                            events.AddEvent(new Event(replay, owner, Event::ONESHOT), events.CalculateTime(roll(3000)));
+                            break;
+                    }
+                }
+                owner.events->Update(diff);
+            }
+        }
+
+        for (Owner<Processor>& owner : owners)
+            owner.events->KillAllEvents(true);
+
+        elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return replay.trace;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int repeats = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5;
+
+    Scenario const scenarios[] =
+    {
+        { "many owners, few events",  3000, 2000,  5,  1 },
+        { "few owners, many events",    30, 2000, 100, 40 },
+    };
+
+    bool identical = true;
+    std::printf("%-26s %14s %14s\n", "scenario (best of runs)", "multimap ms", "wheel ms");
+    for (Scenario const& scenario : scenarios)
+    {
+        double bestMultimap = 1e30;
+        double bestWheel = 1e30;
+        for (int run = 0; run < repeats; ++run)
+        {
+            double elapsed;
+            Trace reference = Run<MultimapEventProcessor>(scenario, elapsed);
+            bestMultimap = std::min(bestMultimap, elapsed);
+            Trace wheel = Run<EventProcessor>(scenario, elapsed);
+            bestWheel = std::min(bestWheel, elapsed);
+
+            if (reference != wheel)
+                identical = false;
+        }
+
+        std::printf("%-26s %14.1f %14.1f\n", scenario.name, bestMultimap, bestWheel);
+    }
+
+    if (!identical)
+    {
+        std::printf("execution traces differ\n");
+        return 1;
+    }
+
+    std::printf("execution traces identical\n");
+    return 0;
+}
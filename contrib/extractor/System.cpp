@@ -96,6 +96,9 @@ float CONF_float_to_int16_limit = 2048.0f;   // Max accuracy = val/65536
 float CONF_flat_height_delta_limit = 0.005f; // If max - min less this value - surface is flat
 float CONF_flat_liquid_delta_limit = 0.001f; // If max - min less this value - liquid surface is flat
 
+// This option stores map files in the aligned format that the server maps into memory
+bool  CONF_aligned_maps = false;
+
 // List MPQ for extract from
 const char* CONF_mpq_list[] =
 {
@@ -136,6 +139,7 @@ void Usage(char* prg)
         "-o set output path\n"\
         "-e extract only MAP(1)/DBC(2)/Camera(4) - standard: all(7)\n"\
         "-f height stored as int (less map size but lost some accuracy) 1 by default\n"\
+        "-a store maps in the aligned format used in place by the server (1) or the packed format (0) - 0 by default\n"\
         "Example: %s -f 0 -i \"c:\\games\\game\"", prg, prg);
     exit(1);
 }
@@ -148,6 +152,7 @@ void HandleArgs(int argc, char* arg[])
         // o - output path
         // e - extract only MAP(1)/DBC(2) - standard both(3)
         // f - use float to int conversion
+        // a - aligned map files
         // h - limit minimum height
         if (arg[c][0] != '-')
             Usage(arg[0]);
@@ -172,6 +177,12 @@ void HandleArgs(int argc, char* arg[])
                 else
                     Usage(arg[0]);
                 break;
+            case 'a':
+                if (c + 1 < argc)                           // all ok
+                    CONF_aligned_maps = atoi(arg[(c++) + 1]) != 0;
+                else
+                    Usage(arg[0]);
+                break;
             case 'e':
                 if (c + 1 < argc)                           // all ok
                 {
@@ -260,6 +271,7 @@ void ReadLiquidTypeTableDBC()
 // Map file format data
 static char const* MAP_MAGIC         = "MAPS";
 static char const* MAP_VERSION_MAGIC = "z1.4";
+static char const* MAP_ALIGNED_VERSION_MAGIC = "a1.4";
 static char const* MAP_AREA_MAGIC    = "AREA";
 static char const* MAP_HEIGHT_MAGIC  = "MHGT";
 static char const* MAP_LIQUID_MAGIC  = "MLIQ";
@@ -288,6 +300,17 @@ uint8 liquid_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
 bool  liquid_show[ADT_GRID_SIZE][ADT_GRID_SIZE];
 float liquid_height[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];
 
+// pads the output up to the next section start of aligned map files
+void AlignMapOutput(FILE* output)
+{
+    if (!CONF_aligned_maps)
+        return;
+
+    static char const padding[MAP_SECTION_ALIGNMENT] = {};
+    if (long rest = ftell(output) % MAP_SECTION_ALIGNMENT)
+        fwrite(padding, 1, MAP_SECTION_ALIGNMENT - rest, output);
+}
+
 bool ConvertADT(char* filename, char* filename2, int cell_y, int cell_x)
 {
     ADT_file adt;
@@ -309,7 +332,7 @@ bool ConvertADT(char* filename, char* filename2, int cell_y, int cell_x)
     // Prepare map header
     GridMapFileHeader map;
     map.mapMagic = *(uint32 const*)MAP_MAGIC;
-    map.versionMagic = *(uint32 const*)MAP_VERSION_MAGIC;
+    map.versionMagic = *(uint32 const*)(CONF_aligned_maps ? MAP_ALIGNED_VERSION_MAGIC : MAP_VERSION_MAGIC);
 
     // Get area flags data
     for (int i = 0; i < ADT_CELLS_PER_GRID; i++)
@@ -786,52 +809,78 @@ bool ConvertADT(char* filename, char* filename2, int cell_y, int cell_x)
         printf("Can't create the output file '%s'\n", filename2);
         return false;
     }
+    // section offsets and sizes are taken from the written file, aligned files pad between headers and arrays
     fwrite(&map, sizeof(map), 1, output);
     // Store area data
+    AlignMapOutput(output);
+    map.areaMapOffset = ftell(output);
     fwrite(&areaHeader, sizeof(areaHeader), 1, output);
     if (!(areaHeader.flags & MAP_AREA_NO_AREA))
+    {
+        AlignMapOutput(output);
         fwrite(area_flags, sizeof(area_flags), 1, output);
+    }
+    map.areaMapSize = ftell(output) - map.areaMapOffset;
 
     // Store height data
+    AlignMapOutput(output);
+    map.heightMapOffset = ftell(output);
     fwrite(&heightHeader, sizeof(heightHeader), 1, output);
     if (!(heightHeader.flags & MAP_HEIGHT_NO_HEIGHT))
     {
+        AlignMapOutput(output);
         if (heightHeader.flags & MAP_HEIGHT_AS_INT16)
         {
             fwrite(uint16_V9, sizeof(uint16_V9), 1, output);
+            AlignMapOutput(output);
             fwrite(uint16_V8, sizeof(uint16_V8), 1, output);
         }
         else if (heightHeader.flags & MAP_HEIGHT_AS_INT8)
         {
             fwrite(uint8_V9, sizeof(uint8_V9), 1, output);
+            AlignMapOutput(output);
             fwrite(uint8_V8, sizeof(uint8_V8), 1, output);
         }
         else
         {
             fwrite(V9, sizeof(V9), 1, output);
+            AlignMapOutput(output);
             fwrite(V8, sizeof(V8), 1, output);
         }
     }
+    map.heightMapSize = ftell(output) - map.heightMapOffset;
 
     // Store liquid data if need
     if (map.liquidMapOffset)
     {
+        AlignMapOutput(output);
+        map.liquidMapOffset = ftell(output);
         fwrite(&liquidHeader, sizeof(liquidHeader), 1, output);
         if (!(liquidHeader.flags & MAP_LIQUID_NO_TYPE))
         {
+            AlignMapOutput(output);
             fwrite(liquid_entry, sizeof(liquid_entry), 1, output);
+            AlignMapOutput(output);
             fwrite(liquid_flags, sizeof(liquid_flags), 1, output);
         }
         if (!(liquidHeader.flags & MAP_LIQUID_NO_HEIGHT))
         {
+            AlignMapOutput(output);
             for (int y = 0; y < liquidHeader.height; y++)
                 fwrite(&liquid_height[y + liquidHeader.offsetY][liquidHeader.offsetX], sizeof(float), liquidHeader.width, output);
         }
+        map.liquidMapSize = ftell(output) - map.liquidMapOffset;
     }
 
     // store hole data
+    AlignMapOutput(output);
+    map.holesOffset = ftell(output);
     fwrite(holes, map.holesSize, 1, output);
 
+    // rewrite the header with the final offsets
+    fseek(output, 0, SEEK_SET);
+    fwrite(&map, sizeof(map), 1, output);
+
     fclose(output);
 
     return true;
@@ -90,13 +90,21 @@ namespace MMAP
         GridMapFileHeader fheader;
         fread(&fheader, sizeof(GridMapFileHeader), 1, mapFile);
 
-        if (fheader.versionMagic != *((uint32 const*)(MAP_VERSION_MAGIC)))
+        bool aligned = fheader.versionMagic == *((uint32 const*)(MAP_ALIGNED_VERSION_MAGIC));
+        if (fheader.versionMagic != *((uint32 const*)(MAP_VERSION_MAGIC)) && !aligned)
         {
             fclose(mapFile);
             printf("%s is the wrong version, please extract new .map files\n", mapFileName);
             return false;
         }
 
+        // arrays of aligned map files start at the next aligned offset
+        auto skipPadding = [aligned, mapFile]()
+        {
+            if (long rest = aligned ? ftell(mapFile) % MAP_SECTION_ALIGNMENT : 0)
+                fseek(mapFile, MAP_SECTION_ALIGNMENT - rest, SEEK_CUR);
+        };
+
         GridMapHeightHeader hheader;
         fseek(mapFile, fheader.heightMapOffset, SEEK_SET);
         fread(&hheader, sizeof(GridMapHeightHeader), 1, mapFile);
@@ -133,7 +141,9 @@ namespace MMAP
             {
                 uint8 v9[V9_SIZE_SQ];
                 uint8 v8[V8_SIZE_SQ];
+                skipPadding();
                 fread(v9, sizeof(uint8), V9_SIZE_SQ, mapFile);
+                skipPadding();
                 fread(v8, sizeof(uint8), V8_SIZE_SQ, mapFile);
                 heightMultiplier = (hheader.gridMaxHeight - hheader.gridHeight) / 255;
 
@@ -147,7 +157,9 @@ namespace MMAP
             {
                 uint16 v9[V9_SIZE_SQ];
                 uint16 v8[V8_SIZE_SQ];
+                skipPadding();
                 fread(v9, sizeof(uint16), V9_SIZE_SQ, mapFile);
+                skipPadding();
                 fread(v8, sizeof(uint16), V8_SIZE_SQ, mapFile);
                 heightMultiplier = (hheader.gridMaxHeight - hheader.gridHeight) / 65535;
 
@@ -159,7 +171,9 @@ namespace MMAP
             }
             else
             {
+                skipPadding();
                 fread(V9, sizeof(float), V9_SIZE_SQ, mapFile);
+                skipPadding();
                 fread(V8, sizeof(float), V8_SIZE_SQ, mapFile);
             }
 
@@ -214,9 +228,13 @@ namespace MMAP
             {
                 if (!(lheader.flags & MAP_LIQUID_NO_TYPE))
                 {
-                    if (fread(liquid_entry, sizeof(liquid_entry), 1, mapFile) == 1 &&
-                            fread(liquid_flags, sizeof(liquid_flags), 1, mapFile) == 1)
-                        liquid_type_loaded = true;
+                    skipPadding();
+                    if (fread(liquid_entry, sizeof(liquid_entry), 1, mapFile) == 1)
+                    {
+                        skipPadding();
+                        if (fread(liquid_flags, sizeof(liquid_flags), 1, mapFile) == 1)
+                            liquid_type_loaded = true;
+                    }
                 }
                 else
                 {
@@ -228,6 +246,7 @@ namespace MMAP
                 {
                     uint32 dataSize = lheader.width * lheader.height;
                     liquid_map = new float[dataSize];
+                    skipPadding();
                     if (fread(liquid_map, sizeof(float), dataSize, mapFile) != dataSize)
                     {
                         delete[] liquid_map;
@@ -61,6 +61,7 @@ namespace MMAP
     // contrib/extractor/system.cpp
     // src/game/GridMap.cpp
     static char const* MAP_VERSION_MAGIC = "z1.4";
+    static char const* MAP_ALIGNED_VERSION_MAGIC = "a1.4";
     
     struct MeshData
     {
@@ -17,11 +17,27 @@
  */
 
 #include "EventProcessor.h"
+#include "ObjectPool.h"
 
-EventProcessor::EventProcessor()
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+static ObjectPool s_eventPool("BasicEvent");
+
+void* BasicEvent::operator new(size_t size)
+{
+    return s_eventPool.Allocate(size);
+}
+
+void BasicEvent::operator delete(void* ptr, size_t size)
+{
+    s_eventPool.Deallocate(ptr, size);
+}
+
+EventProcessor::EventProcessor() : m_time(0), m_aborting(false), m_shortQueue(nullptr), m_useWheel(false), m_wheelTime(0),
+    m_nextSlotTime(std::numeric_limits<uint64>::max()), m_eventCount(0)
 {
-    m_time = 0;
-    m_aborting = false;
 }
 
 EventProcessor::~EventProcessor()
@@ -34,28 +50,36 @@ void EventProcessor::Update(uint32 p_time)
     // update time
     m_time += p_time;
 
-    // main event loop
-    EventList::iterator i;
-    while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+    // a short queue runs in time order, until an executed event adds so many that it moves to the wheel
+    while (!m_useWheel && m_shortQueue && m_shortQueue->m_execTime <= m_time)
     {
-        // get and remove event from queue
-        BasicEvent* Event = i->second;
-        m_events.erase(i);
+        BasicEvent* Event = m_shortQueue;
+        Unlink(Event);
+        --m_eventCount;
+        ExecuteEvent(Event, p_time);
+    }
 
-        if (!Event->to_Abort)
-        {
-            if (Event->Execute(m_time, p_time))
-            {
-                // completely destroy event if it is not re-added
-                delete Event;
-            }
-        }
-        else
-        {
-            Event->Abort(m_time);
-            delete Event;
-        }
+    // main event loop, jumps from one used slot of the wheel to the next up to m_time
+    while (m_useWheel && m_eventCount && m_nextSlotTime <= m_time)
+    {
+        uint64 next = m_nextSlotTime = GetNextSlotTime();
+        if (next > m_time)
+            break;
+
+        // a level 0 slot has its events due at next, else next starts a higher level slot which is spread
+        bool levelZero = next - m_wheelTime < WHEEL_SLOTS - (m_wheelTime & (WHEEL_SLOTS - 1));
+        AdvanceWheel(next);
+        if (levelZero)
+            ProcessSlot(uint32(next & (WHEEL_SLOTS - 1)), p_time);
     }
+
+    // all used slots start after m_time now. The wheel stays at m_time, so events added until the next update
+    // with an execution time up to m_time go to its slot and run even on an update without time passing
+    m_wheelTime = m_time;
+
+    // the wheel is empty, new events start a short queue again
+    if (m_useWheel && !m_eventCount)
+        m_useWheel = false;
 }
 
 void EventProcessor::KillAllEvents(bool force)
@@ -63,39 +87,44 @@ void EventProcessor::KillAllEvents(bool force)
     // prevent event insertions
     m_aborting = true;
 
-    // first, abort all existing events
-    for (EventList::iterator i = m_events.begin(); i != m_events.end();)
+    if (!m_eventCount)
+        return;
+
+    // take all events out first, aborting an event may queue others. They are aborted by execution time,
+    // events of the same time are in one slot in queue order, which the stable sort keeps
+    EventList events = GetEvents();
+    std::stable_sort(events.begin(), events.end(), [](BasicEvent const* left, BasicEvent const* right)
     {
-        EventList::iterator i_old = i;
-        ++i;
+        return left->m_execTime < right->m_execTime;
+    });
+    for (BasicEvent* event : events)
+        Unlink(event);
+    m_eventCount = 0;
 
-        i_old->second->to_Abort = true;
-        i_old->second->Abort(m_time);
-        if (force || i_old->second->IsDeletable())
+    // first, abort all existing events
+    for (BasicEvent* event : events)
+    {
+        event->to_Abort = true;
+        event->Abort(m_time);
+        if (force || event->IsDeletable())
+            delete event;
+        else                                                // kept until its time, then deleted without execution
         {
-            delete i_old->second;
-
-            if (!force)                                     // need per-element cleanup
-                m_events.erase(i_old);
+            Queue(event);
+            ++m_eventCount;
         }
     }
-
-    // fast clear event list (in force case)
-    if (force)
-        m_events.clear();
 }
 
 void EventProcessor::KillEvent(BasicEvent* event)
 {
-    for (EventList::iterator iter = m_events.begin(); iter != m_events.end();)
-    {
-        if (iter->second == event)
-        {
-            delete iter->second;
-            iter = m_events.erase(iter);
-        }
-        else ++iter;
-    }
+    // events not queued (e.g. the one being executed) are left to their owner
+    if (event->m_wheelSlot == BasicEvent::NOT_QUEUED)
+        return;
+
+    Unlink(event);
+    --m_eventCount;
+    delete event;
 }
 
 void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
@@ -104,24 +133,292 @@ void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime
         Event->m_addTime = m_time;
 
     Event->m_execTime = e_time;
-    m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+
+    Queue(Event);
+    ++m_eventCount;
 }
 
 void EventProcessor::ModifyEventTime(BasicEvent* Event, uint64 msTime)
 {
-    for (auto itr = m_events.begin(); itr != m_events.end(); ++itr)
-    {
-        if (itr->second != Event)
-            continue;
+    if (Event->m_wheelSlot == BasicEvent::NOT_QUEUED)
+        return;
 
-        Event->m_execTime = msTime;
-        m_events.erase(itr);
-        m_events.insert(std::pair<uint64, BasicEvent*>(msTime, Event));
-        break;
-    }
+    Event->m_execTime = msTime;
+    Unlink(Event);
+    Queue(Event);
 }
 
 uint64 EventProcessor::CalculateTime(uint64 t_offset) const
 {
     return m_time + t_offset;
 }
+
+EventList EventProcessor::GetEvents() const
+{
+    EventList events;
+    events.reserve(m_eventCount);
+
+    auto addSlot = [&events](BasicEvent* head)
+    {
+        if (!head)
+            return;
+
+        BasicEvent* event = head;
+        do
+        {
+            events.push_back(event);
+            event = event->m_wheelNext;
+        }
+        while (event != head);
+    };
+
+    addSlot(m_shortQueue);
+    if (m_wheel)
+        for (BasicEvent* head : m_wheel->slots)
+            addSlot(head);
+
+    return events;
+}
+
+void EventProcessor::Queue(BasicEvent* event)
+{
+    if (!m_useWheel)
+    {
+        if (m_eventCount < SHORT_QUEUE_SIZE)
+        {
+            InsertShort(event);
+            return;
+        }
+        SwitchToWheel();
+    }
+
+    Link(event);
+}
+
+void EventProcessor::InsertShort(BasicEvent* event)
+{
+    event->m_wheelSlot = SHORT_QUEUE_SLOT;
+    if (!m_shortQueue)
+    {
+        m_shortQueue = event;
+        event->m_wheelPrev = event;
+        event->m_wheelNext = event;
+        return;
+    }
+
+    // sorted by execution time, after the events of the same time. Searched from the nearer end, long timers such
+    // as despawns gather at the tail while most new events are due soon
+    BasicEvent* head = m_shortQueue;
+    BasicEvent* tail = head->m_wheelPrev;
+    bool first = false;
+    BasicEvent* prev;
+    if (event->m_execTime < head->m_execTime)
+    {
+        prev = tail;
+        first = true;
+    }
+    else if (event->m_execTime - head->m_execTime < tail->m_execTime - std::min(tail->m_execTime, event->m_execTime))
+    {
+        prev = head;
+        while (prev->m_wheelNext != head && prev->m_wheelNext->m_execTime <= event->m_execTime)
+            prev = prev->m_wheelNext;
+    }
+    else
+    {
+        prev = tail;
+        while (prev->m_execTime > event->m_execTime)
+            prev = prev->m_wheelPrev;
+    }
+
+    event->m_wheelPrev = prev;
+    event->m_wheelNext = prev->m_wheelNext;
+    prev->m_wheelNext->m_wheelPrev = event;
+    prev->m_wheelNext = event;
+    if (first)
+        m_shortQueue = event;
+}
+
+void EventProcessor::SwitchToWheel()
+{
+    if (!m_wheel)
+        m_wheel = std::make_unique<Wheel>();
+
+    // the wheel is empty, so it can start at the current time. Events in queue order, Link keeps due ones in order
+    m_useWheel = true;
+    m_wheelTime = m_time;
+    m_nextSlotTime = std::numeric_limits<uint64>::max();
+    while (BasicEvent* event = m_shortQueue)
+    {
+        Unlink(event);
+        Link(event);
+    }
+}
+
+void EventProcessor::Link(BasicEvent* event)
+{
+    // events already due go to the slot being processed, they still run in this update
+    uint64 time = std::max(event->m_execTime, m_wheelTime);
+
+    // the lowest level whose slots still belong to the current block of the level above
+    uint64 diff = time ^ m_wheelTime;
+    uint32 level = 0;
+    while (level < WHEEL_LEVELS && (diff >> ((level + 1) * WHEEL_SLOT_BITS)) != 0)
+        ++level;
+
+    uint32 slot;
+    uint64 slotTime;
+    if (level < WHEEL_LEVELS)
+    {
+        uint32 shift = level * WHEEL_SLOT_BITS;
+        slot = level * WHEEL_SLOTS + uint32((time >> shift) & (WHEEL_SLOTS - 1));
+        slotTime = (time >> shift) << shift;
+        m_wheel->occupied[level] |= 1 << (slot % WHEEL_SLOTS);
+    }
+    else
+    {
+        uint32 shift = WHEEL_LEVELS * WHEEL_SLOT_BITS;
+        slot = WHEEL_OVERFLOW_SLOT;
+        slotTime = ((m_wheelTime >> shift) + 1) << shift;
+    }
+    m_nextSlotTime = std::min(m_nextSlotTime, slotTime);
+
+    // circular list, the head's prev is the tail so events of one slot keep their order
+    BasicEvent*& head = m_wheel->slots[slot];
+    event->m_wheelSlot = slot;
+    if (!head)
+    {
+        head = event;
+        event->m_wheelPrev = event;
+        event->m_wheelNext = event;
+        return;
+    }
+
+    // overdue events still run in time order, before the events due at this slot
+    BasicEvent* next = head;
+    if (event->m_execTime < m_wheelTime)
+    {
+        while (next->m_execTime <= event->m_execTime && next->m_wheelNext != head)
+            next = next->m_wheelNext;
+        if (next->m_execTime <= event->m_execTime)
+            next = head;                                    // append
+        else if (next == head)
+            head = event;
+    }
+
+    event->m_wheelPrev = next->m_wheelPrev;
+    event->m_wheelNext = next;
+    next->m_wheelPrev->m_wheelNext = event;
+    next->m_wheelPrev = event;
+}
+
+void EventProcessor::Unlink(BasicEvent* event)
+{
+    uint32 slot = event->m_wheelSlot;
+    BasicEvent*& head = slot == SHORT_QUEUE_SLOT ? m_shortQueue : m_wheel->slots[slot];
+    if (event->m_wheelNext == event)
+    {
+        head = nullptr;
+        if (slot < WHEEL_OVERFLOW_SLOT)
+            m_wheel->occupied[slot / WHEEL_SLOTS] &= ~(1 << (slot % WHEEL_SLOTS));
+    }
+    else
+    {
+        event->m_wheelPrev->m_wheelNext = event->m_wheelNext;
+        event->m_wheelNext->m_wheelPrev = event->m_wheelPrev;
+        if (head == event)
+            head = event->m_wheelNext;
+    }
+    event->m_wheelSlot = BasicEvent::NOT_QUEUED;
+}
+
+uint64 EventProcessor::GetNextSlotTime() const
+{
+    // used level 0 slot of the current block
+    uint32 index = uint32(m_wheelTime & (WHEEL_SLOTS - 1));
+    if (uint32 pending = m_wheel->occupied[0] & ~((1u << index) - 1))
+        return (m_wheelTime & ~uint64(WHEEL_SLOTS - 1)) | std::countr_zero(pending);
+
+    // else the start of the first used higher level slot, slots up to the current one are already spread
+    for (uint32 level = 1; level < WHEEL_LEVELS; ++level)
+    {
+        uint32 shift = level * WHEEL_SLOT_BITS;
+        index = uint32((m_wheelTime >> shift) & (WHEEL_SLOTS - 1));
+        if (uint32 pending = m_wheel->occupied[level] & ~((2u << index) - 1))
+            return ((m_wheelTime >> (shift + WHEEL_SLOT_BITS)) << (shift + WHEEL_SLOT_BITS)) | (uint64(std::countr_zero(pending)) << shift);
+    }
+
+    // overflow events are spread at the start of each wheel turn
+    uint32 shift = WHEEL_LEVELS * WHEEL_SLOT_BITS;
+    if (m_wheel->slots[WHEEL_OVERFLOW_SLOT])
+        return ((m_wheelTime >> shift) + 1) << shift;
+
+    return std::numeric_limits<uint64>::max();
+}
+
+void EventProcessor::Redistribute(uint32 slot)
+{
+    BasicEvent* head = m_wheel->slots[slot];
+    if (!head)
+        return;
+
+    m_wheel->slots[slot] = nullptr;
+    if (slot < WHEEL_OVERFLOW_SLOT)
+        m_wheel->occupied[slot / WHEEL_SLOTS] &= ~(1 << (slot % WHEEL_SLOTS));
+
+    // spread the events over the lower levels in queue order, far events go back to the overflow list
+    BasicEvent* event = head;
+    do
+    {
+        BasicEvent* next = event->m_wheelNext;
+        Link(event);
+        event = next;
+    }
+    while (event != head);
+}
+
+void EventProcessor::AdvanceWheel(uint64 time)
+{
+    m_wheelTime = time;
+    if (time & (WHEEL_SLOTS - 1))
+        return;
+
+    // entering a new block of level 0 and maybe of higher levels, highest first
+    if ((time & ((uint64(1) << (WHEEL_LEVELS * WHEEL_SLOT_BITS)) - 1)) == 0)
+        Redistribute(WHEEL_OVERFLOW_SLOT);
+
+    for (uint32 level = WHEEL_LEVELS - 1; level > 0; --level)
+    {
+        uint32 shift = level * WHEEL_SLOT_BITS;
+        if ((time & ((uint64(1) << shift) - 1)) == 0)
+            Redistribute(level * WHEEL_SLOTS + uint32((time >> shift) & (WHEEL_SLOTS - 1)));
+    }
+}
+
+void EventProcessor::ProcessSlot(uint32 slot, uint32 p_time)
+{
+    // events queued for this millisecond while executing are appended and run as well
+    while (BasicEvent* Event = m_wheel->slots[slot])
+    {
+        // get and remove event from queue
+        Unlink(Event);
+        --m_eventCount;
+        ExecuteEvent(Event, p_time);
+    }
+}
+
+void EventProcessor::ExecuteEvent(BasicEvent* Event, uint32 p_time)
+{
+    if (!Event->to_Abort)
+    {
+        if (Event->Execute(m_time, p_time))
+        {
+            // completely destroy event if it is not re-added
+            delete Event;
+        }
+    }
+    else
+    {
+        Event->Abort(m_time);
+        delete Event;
+    }
+}
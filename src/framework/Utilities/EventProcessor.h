@@ -21,16 +21,19 @@
 
 #include "Platform/Define.h"
 
-#include <map>
+#include <memory>
+#include <vector>
 
 // Note. All times are in milliseconds here.
 
 class BasicEvent
 {
+        friend class EventProcessor;
+
     public:
 
         BasicEvent()
-            : to_Abort(false)
+            : to_Abort(false), m_wheelPrev(nullptr), m_wheelNext(nullptr), m_wheelSlot(NOT_QUEUED)
         {
         }
 
@@ -38,6 +41,10 @@ class BasicEvent
         {
         };
 
+        // events of all types are allocated from a pool, see ObjectPool
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
+
         // this method executes when the event is triggered
         // return false if event does not want to be deleted
         // e_time is execution time, p_time is update interval
@@ -53,9 +60,17 @@ class BasicEvent
         // these can be used for time offset control
         uint64 m_addTime;                                   // time when the event was added to queue, filled by event handler
         uint64 m_execTime;                                  // planned time of next execution, filled by event handler
+
+    private:
+        static uint32 const NOT_QUEUED = uint32(-1);
+
+        // intrusive links of the timer wheel slot holding the event, managed by EventProcessor
+        BasicEvent* m_wheelPrev;
+        BasicEvent* m_wheelNext;
+        uint32 m_wheelSlot;
 };
 
-typedef std::multimap<uint64, BasicEvent*> EventList;
+typedef std::vector<BasicEvent*> EventList;
 
 class EventProcessor
 {
@@ -70,13 +85,51 @@ class EventProcessor
         void AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime = true);
         void ModifyEventTime(BasicEvent* event, uint64 msTime);
         uint64 CalculateTime(uint64 t_offset) const;
-        EventList& GetEvents() { return m_events; }
+
+        bool HasEvents() const { return m_eventCount != 0; }
+        // snapshot of the queued events, events must not be removed while it is walked
+        EventList GetEvents() const;
 
     protected:
 
         uint64 m_time;
-        EventList m_events;
         bool m_aborting;
+
+    private:
+        // hierarchical timer wheel: level 0 has one slot per millisecond, a slot of each next level spans a whole
+        // lower level. Slots are intrusive lists, so adding, moving and killing an event never searches or allocates.
+        // Owners with only a few events keep them in one short sorted list instead, which is cheaper to walk than
+        // the wheel to spread, until more are added. The wheel is used until it runs empty.
+        static uint32 const WHEEL_SLOT_BITS = 4;
+        static uint32 const WHEEL_SLOTS = 1 << WHEEL_SLOT_BITS;
+        static uint32 const WHEEL_LEVELS = 6;                // covers 2^24 ms (4.6 hours)
+        static uint32 const WHEEL_OVERFLOW_SLOT = WHEEL_LEVELS * WHEEL_SLOTS; // events further away than that
+        static uint32 const SHORT_QUEUE_SLOT = WHEEL_OVERFLOW_SLOT + 1;
+        static uint32 const SHORT_QUEUE_SIZE = 32;
+
+        struct Wheel
+        {
+            BasicEvent* slots[WHEEL_OVERFLOW_SLOT + 1] = {};
+            uint16 occupied[WHEEL_LEVELS] = {};             // non empty slots per level
+        };
+
+        void Queue(BasicEvent* event);                      // queues at m_execTime, in the short list or the wheel
+        void InsertShort(BasicEvent* event);
+        void SwitchToWheel();
+        void Link(BasicEvent* event);                       // queues at m_execTime in the wheel
+        void Unlink(BasicEvent* event);
+        void Redistribute(uint32 slot);
+        uint64 GetNextSlotTime() const;
+        void AdvanceWheel(uint64 time);
+        void ProcessSlot(uint32 slot, uint32 p_time);
+        void ExecuteEvent(BasicEvent* Event, uint32 p_time);
+
+        BasicEvent* m_shortQueue;                           // sorted by execution time, while the wheel is not used
+        bool m_useWheel;
+        std::unique_ptr<Wheel> m_wheel;                     // allocated when a short queue first overflows
+        uint64 m_wheelTime;                                 // next millisecond the wheel processes
+        uint64 m_nextSlotTime;                              // no slot needs processing before this time
+        uint32 m_eventCount;
 };
 
 #endif
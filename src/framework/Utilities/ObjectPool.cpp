@@ -0,0 +1,287 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ObjectPool.h"
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+
+namespace
+{
+    size_t const SIZE_CLASS_STEP = 16;                      // keeps the default new alignment
+    size_t const SIZE_CLASSES = ObjectPool::MAX_OBJECT_SIZE / SIZE_CLASS_STEP;
+    size_t const SLAB_SIZE = 16 * 1024;
+    uint32 const BATCH_SIZE = 32;                           // free objects moved between a thread and the depot at once
+
+    struct FreeObject
+    {
+        FreeObject* next;
+    };
+
+    struct FreeChain
+    {
+        FreeObject* head;
+        uint32 count;
+    };
+
+    // free objects and unused slab memory of one size class, owned by a thread
+    struct SizeClassCache
+    {
+        FreeObject* free;
+        uint32 freeCount;
+        char* slabPos;
+        char* slabEnd;
+    };
+
+    // free objects shared by all threads
+    struct Depot
+    {
+        std::mutex lock;
+        std::vector<FreeChain> chains[SIZE_CLASSES];
+        std::atomic<uint32> chainCount[SIZE_CLASSES] = {};
+        std::atomic<uint64> reserved{0};
+    };
+
+    // never destroyed, pooled objects may still be freed during static destruction
+    Depot& GetDepot()
+    {
+        static Depot* depot = new Depot();
+        return *depot;
+    }
+
+    std::mutex& GetRegistryLock()
+    {
+        static std::mutex* lock = new std::mutex();
+        return *lock;
+    }
+
+    std::vector<ObjectPool*>& GetRegistry()
+    {
+        static std::vector<ObjectPool*>* pools = new std::vector<ObjectPool*>();
+        return *pools;
+    }
+
+    void PushToDepot(size_t sizeClass, FreeChain chain)
+    {
+        Depot& depot = GetDepot();
+        std::lock_guard<std::mutex> guard(depot.lock);
+        depot.chains[sizeClass].push_back(chain);
+        depot.chainCount[sizeClass].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool PopFromDepot(size_t sizeClass, FreeChain& chain)
+    {
+        Depot& depot = GetDepot();
+        if (!depot.chainCount[sizeClass].load(std::memory_order_relaxed))
+            return false;
+
+        std::lock_guard<std::mutex> guard(depot.lock);
+        if (depot.chains[sizeClass].empty())
+            return false;
+
+        chain = depot.chains[sizeClass].back();
+        depot.chains[sizeClass].pop_back();
+        depot.chainCount[sizeClass].fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    thread_local SizeClassCache t_cache[SIZE_CLASSES];
+    thread_local bool t_cacheClosed = false;
+
+    // gives the cached memory of an exiting thread to the depot
+    struct ThreadCacheGuard
+    {
+        ~ThreadCacheGuard()
+        {
+            t_cacheClosed = true;
+            for (size_t sizeClass = 0; sizeClass < SIZE_CLASSES; ++sizeClass)
+            {
+                SizeClassCache& entry = t_cache[sizeClass];
+                FreeChain chain = { entry.free, entry.freeCount };
+
+                size_t objectSize = (sizeClass + 1) * SIZE_CLASS_STEP;
+                for (; entry.slabPos + objectSize <= entry.slabEnd; entry.slabPos += objectSize)
+                {
+                    FreeObject* object = reinterpret_cast<FreeObject*>(entry.slabPos);
+                    object->next = chain.head;
+                    chain.head = object;
+                    ++chain.count;
+                }
+
+                if (chain.count)
+                    PushToDepot(sizeClass, chain);
+                entry = SizeClassCache();
+            }
+        }
+    };
+
+    SizeClassCache* GetThreadCache()
+    {
+        if (t_cacheClosed)
+            return nullptr;
+
+        static thread_local ThreadCacheGuard guard;
+        return t_cache;
+    }
+
+    void* AllocateObject(size_t sizeClass, bool& recycled)
+    {
+        size_t objectSize = (sizeClass + 1) * SIZE_CLASS_STEP;
+        SizeClassCache* cache = GetThreadCache();
+        if (!cache)                                         // thread exiting
+        {
+            FreeChain chain;
+            if ((recycled = PopFromDepot(sizeClass, chain)))
+            {
+                if (chain.count > 1)
+                    PushToDepot(sizeClass, { chain.head->next, chain.count - 1 });
+                return chain.head;
+            }
+
+            GetDepot().reserved.fetch_add(objectSize, std::memory_order_relaxed);
+            return ::operator new(objectSize);
+        }
+
+        SizeClassCache& entry = cache[sizeClass];
+        if (!entry.free)
+        {
+            FreeChain chain;
+            if (PopFromDepot(sizeClass, chain))
+            {
+                entry.free = chain.head;
+                entry.freeCount = chain.count;
+            }
+        }
+
+        if (FreeObject* object = entry.free)
+        {
+            entry.free = object->next;
+            --entry.freeCount;
+            recycled = true;
+            return object;
+        }
+
+        recycled = false;
+        if (entry.slabPos + objectSize > entry.slabEnd)
+        {
+            size_t slabSize = std::max(SLAB_SIZE, objectSize * 8);
+            entry.slabPos = static_cast<char*>(::operator new(slabSize));
+            entry.slabEnd = entry.slabPos + slabSize;
+            GetDepot().reserved.fetch_add(slabSize, std::memory_order_relaxed);
+        }
+
+        void* object = entry.slabPos;
+        entry.slabPos += objectSize;
+        return object;
+    }
+
+    void DeallocateObject(void* ptr, size_t sizeClass)
+    {
+        FreeObject* object = static_cast<FreeObject*>(ptr);
+        SizeClassCache* cache = GetThreadCache();
+        if (!cache)                                         // thread exiting
+        {
+            object->next = nullptr;
+            PushToDepot(sizeClass, { object, 1 });
+            return;
+        }
+
+        SizeClassCache& entry = cache[sizeClass];
+        object->next = entry.free;
+        entry.free = object;
+
+        // keep the cache bounded, a thread may free many objects allocated by others
+        if (++entry.freeCount < 2 * BATCH_SIZE)
+            return;
+
+        FreeChain chain = { entry.free, BATCH_SIZE };
+        FreeObject* last = entry.free;
+        for (uint32 i = 1; i < BATCH_SIZE; ++i)
+            last = last->next;
+        entry.free = last->next;
+        entry.freeCount -= BATCH_SIZE;
+        last->next = nullptr;
+        PushToDepot(sizeClass, chain);
+    }
+}
+
+ObjectPool::ObjectPool(char const* name) : m_name(name), m_live(0), m_highWater(0), m_allocations(0), m_recycled(0)
+{
+    std::lock_guard<std::mutex> guard(GetRegistryLock());
+    GetRegistry().push_back(this);
+}
+
+void* ObjectPool::Allocate(size_t size)
+{
+    void* ptr;
+    bool recycled = false;
+    if (size > MAX_OBJECT_SIZE)
+        ptr = ::operator new(size);
+    else
+        ptr = AllocateObject(size ? (size - 1) / SIZE_CLASS_STEP : 0, recycled);
+
+    uint64 live = m_live.fetch_add(1, std::memory_order_relaxed) + 1;
+    uint64 highWater = m_highWater.load(std::memory_order_relaxed);
+    while (live > highWater && !m_highWater.compare_exchange_weak(highWater, live, std::memory_order_relaxed));
+
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (recycled)
+        m_recycled.fetch_add(1, std::memory_order_relaxed);
+
+    return ptr;
+}
+
+void ObjectPool::Deallocate(void* ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    if (size > MAX_OBJECT_SIZE)
+        ::operator delete(ptr);
+    else
+        DeallocateObject(ptr, size ? (size - 1) / SIZE_CLASS_STEP : 0);
+
+    m_live.fetch_sub(1, std::memory_order_relaxed);
+}
+
+ObjectPoolStats ObjectPool::GetStats() const
+{
+    ObjectPoolStats stats;
+    stats.name = m_name;
+    stats.live = m_live.load(std::memory_order_relaxed);
+    stats.highWater = m_highWater.load(std::memory_order_relaxed);
+    stats.allocations = m_allocations.load(std::memory_order_relaxed);
+    stats.recycled = m_recycled.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::vector<ObjectPoolStats> ObjectPool::GetAllStats()
+{
+    std::lock_guard<std::mutex> guard(GetRegistryLock());
+    std::vector<ObjectPoolStats> result;
+    result.reserve(GetRegistry().size());
+    for (ObjectPool const* pool : GetRegistry())
+        result.push_back(pool->GetStats());
+    return result;
+}
+
+uint64 ObjectPool::GetReservedBytes()
+{
+    return GetDepot().reserved.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,65 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_OBJECTPOOL_H
+#define MANGOS_OBJECTPOOL_H
+
+#include "Platform/Define.h"
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+struct ObjectPoolStats
+{
+    char const* name;
+    uint64 live;                                            // objects currently allocated
+    uint64 highWater;                                       // most objects allocated at the same time
+    uint64 allocations;                                     // total allocations
+    uint64 recycled;                                        // allocations that reused a freed object
+};
+
+// Allocator for small, short lived objects, used by the class operator new/delete of hot types.
+// Memory is carved from slabs by size class, freed objects go to a per thread free list and are reused
+// by the next object of the same size class. Threads exchange batches of free objects through a shared
+// depot, so objects freed by another thread than the one that allocated them are not lost.
+// Slab memory is never given back to the system.
+class ObjectPool
+{
+    public:
+        explicit ObjectPool(char const* name);
+
+        void* Allocate(size_t size);
+        void Deallocate(void* ptr, size_t size);
+
+        ObjectPoolStats GetStats() const;
+
+        static std::vector<ObjectPoolStats> GetAllStats();
+        static uint64 GetReservedBytes();                   // slab memory of all pools
+
+        static size_t const MAX_OBJECT_SIZE = 4096;         // larger objects use the global allocator
+
+    private:
+        char const* m_name;
+        std::atomic<uint64> m_live;
+        std::atomic<uint64> m_highWater;
+        std::atomic<uint64> m_allocations;
+        std::atomic<uint64> m_recycled;
+};
+
+#endif
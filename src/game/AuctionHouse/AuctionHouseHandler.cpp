@@ -479,9 +479,11 @@ void WorldSession::HandleAuctionListBidderItems(WorldPacket& recv_data)
     recv_data >> auctioneerGuid;
     recv_data >> listfrom;                                  // start, used for page control listing by 50 elements
     recv_data >> outbiddedCount;
-    if (recv_data.size() != (16 + outbiddedCount * 4))
+    // in size_t, a huge count must not wrap around to the packet size
+    size_t const expectedSize = 16 + size_t(outbiddedCount) * 4;
+    if (recv_data.size() != expectedSize)
     {
-        sLog.outError("Client sent bad opcode!!! with count: %u and size : %u (must be: %u)", outbiddedCount, (uint32)recv_data.size(), (16 + outbiddedCount * 4));
+        sLog.outError("Client sent bad opcode!!! with count: %u and size : " SIZEFMTD " (must be: " SIZEFMTD ")", outbiddedCount, recv_data.size(), expectedSize);
         outbiddedCount = 0;
     }
 
@@ -492,28 +494,11 @@ void WorldSession::HandleAuctionListBidderItems(WorldPacket& recv_data)
     // always return pointer
     AuctionHouseObject* auctionHouse = sAuctionMgr.GetAuctionsMap(auctionHouseEntry);
 
-    WorldPacket data(SMSG_AUCTION_BIDDER_LIST_RESULT, (4 + 4 + 4));
-    Player* pl = GetPlayer();
-    data << uint32(0);                                      // add 0 as count
-    uint32 count = 0;
-    uint32 totalcount = 0;
-    while (outbiddedCount > 0)                              // add all data, which client requires
-    {
-        --outbiddedCount;
-        uint32 outbiddedAuctionId;
+    std::vector<uint32> outbidded(outbiddedCount);
+    for (uint32& outbiddedAuctionId : outbidded)            // add all data, which client requires
         recv_data >> outbiddedAuctionId;
-        AuctionEntry* auction = auctionHouse->GetAuction(outbiddedAuctionId);
-        if (auction && auction->BuildAuctionInfo(data))
-        {
-            ++totalcount;
-            ++count;
-        }
-    }
 
-    auctionHouse->BuildListBidderItems(data, pl, listfrom, count, totalcount);
-    data.put<uint32>(0, count);                             // add count to placeholder
-    data << uint32(totalcount);
-    SendPacket(data);
+    sWorld.GetAuctionHouseSearch().QueryBidderItems(this, auctionHouse->GetHouseType(), outbidded, listfrom);
 }
 
 // this void sends player info about his auctions
@@ -534,16 +519,7 @@ void WorldSession::HandleAuctionListOwnerItems(WorldPacket& recv_data)
     // always return pointer
     AuctionHouseObject* auctionHouse = sAuctionMgr.GetAuctionsMap(auctionHouseEntry);
 
-    WorldPacket data(SMSG_AUCTION_OWNER_LIST_RESULT, (4 + 4));
-    data << (uint32) 0;                                     // amount place holder
-
-    uint32 count = 0;
-    uint32 totalcount = 0;
-
-    auctionHouse->BuildListOwnerItems(data, _player, listfrom, count, totalcount);
-    data.put<uint32>(0, count);
-    data << uint32(totalcount);
-    SendPacket(data);
+    sWorld.GetAuctionHouseSearch().QueryOwnerItems(this, auctionHouse->GetHouseType(), listfrom);
 }
 
 // this void is called when player clicks on search button
@@ -574,11 +550,6 @@ void WorldSession::HandleAuctionListItems(WorldPacket& recv_data)
     // DEBUG_LOG("Auctionhouse search %s list from: %u, searchedname: %s, levelmin: %u, levelmax: %u, auctionSlotID: %u, auctionMainCategory: %u, auctionSubCategory: %u, quality: %u, usable: %u",
     //  auctioneerGuid.GetString().c_str(), listfrom, searchedname.c_str(), levelmin, levelmax, auctionSlotID, auctionMainCategory, auctionSubCategory, quality, usable);
 
-    WorldPacket data(SMSG_AUCTION_LIST_RESULT, (4 + 4));
-    uint32 count = 0;
-    uint32 totalcount = 0;
-    data << uint32(0);
-
     // converting string that we try to find to lower case
     std::wstring wsearchedname;
     if (!Utf8toWStr(searchedname, wsearchedname))
@@ -586,12 +557,6 @@ void WorldSession::HandleAuctionListItems(WorldPacket& recv_data)
 
     wstrToLower(wsearchedname);
 
-    auctionHouse->BuildListAuctionItems(data, _player,
-                                        wsearchedname, listfrom, levelmin, levelmax, usable,
-                                        auctionSlotID, auctionMainCategory, auctionSubCategory, quality,
-                                        count, totalcount);
-
-    data.put<uint32>(0, count);
-    data << uint32(totalcount);
-    SendPacket(data);
+    AuctionSearchQuery query = { wsearchedname, levelmin, levelmax, usable, auctionSlotID, auctionMainCategory, auctionSubCategory, quality };
+    sWorld.GetAuctionHouseSearch().QueryAuctionItems(this, auctionHouse->GetHouseType(), query, listfrom);
 }
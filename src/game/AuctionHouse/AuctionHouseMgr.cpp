@@ -40,6 +40,8 @@ INSTANTIATE_SINGLETON_1(AuctionHouseMgr);
 
 AuctionHouseMgr::AuctionHouseMgr()
 {
+    for (uint32 i = 0; i < MAX_AUCTION_HOUSE_TYPE; ++i)
+        mAuctions[i].SetHouseType(AuctionHouseType(i));
 }
 
 AuctionHouseMgr::~AuctionHouseMgr()
@@ -540,118 +542,61 @@ void AuctionHouseObject::Update()
 
             itr->second->DeleteFromDB();
             sAuctionMgr.RemoveAItem(itr->second->itemGuidLow);
+            sWorld.GetAuctionHouseSearch().WithdrawAuction(m_houseType, itr->first);
             delete itr->second;
             AuctionsMap.erase(itr++);
         }
     }
 }
 
-void AuctionHouseObject::BuildListBidderItems(WorldPacket& data, Player* player, uint32 listfrom, uint32& count, uint32& totalcount)
+void AuctionHouseObject::AddAuction(AuctionEntry* ah)
 {
-    for (AuctionEntryMap::const_iterator itr = AuctionsMap.begin(); itr != AuctionsMap.end(); ++itr)
-    {
-        AuctionEntry* Aentry = itr->second;
-        if (Aentry->bidder == player->GetGUIDLow())
-        {
-            if (count < MAX_AUCTION_ITEMS_CLIENT_UI_PAGE && totalcount >= listfrom)
-            {
-                if (!Aentry->BuildAuctionInfo(data))
-                    continue;
-                ++count;
-            }
-            ++totalcount;
-        }
-    }
+    MANGOS_ASSERT(ah);
+    AuctionsMap[ah->Id] = ah;
+    sWorld.GetAuctionHouseSearch().PublishAuction(m_houseType, *ah);
 }
 
-void AuctionHouseObject::BuildListOwnerItems(WorldPacket& data, Player* player, uint32 listfrom, uint32& count, uint32& totalcount)
+bool AuctionHouseObject::RemoveAuction(uint32 id)
 {
-    for (AuctionEntryMap::const_iterator itr = AuctionsMap.begin(); itr != AuctionsMap.end(); ++itr)
-    {
-        AuctionEntry* Aentry = itr->second;
-        if (Aentry->owner == player->GetGUIDLow())
-        {
-            if (count < MAX_AUCTION_ITEMS_CLIENT_UI_PAGE && totalcount >= listfrom)
-            {
-                if (!Aentry->BuildAuctionInfo(data))
-                    continue;
-                ++count;
-            }
-            ++totalcount;
-        }
-    }
+    if (!AuctionsMap.erase(id))
+        return false;
+
+    sWorld.GetAuctionHouseSearch().WithdrawAuction(m_houseType, id);
+    return true;
 }
 
-void AuctionHouseObject::BuildListAuctionItems(WorldPacket& data, Player* player,
-        std::wstring const& wsearchedname, uint32 listfrom, uint32 levelmin, uint32 levelmax, uint32 usable,
-        uint32 inventoryType, uint32 itemClass, uint32 itemSubClass, uint32 quality,
-        uint32& count, uint32& totalcount)
+void AuctionHouseObject::UpdateAuction(AuctionEntry const* auction) const
 {
-    int loc_idx = player->GetSession()->GetSessionDbLocaleIndex();
+    sWorld.GetAuctionHouseSearch().PublishAuction(m_houseType, *auction);
+}
 
-    for (auto& AentryItr : AuctionsMap)
+void AuctionHouseObject::SelectUsableItems(Player* player, std::vector<uint32>& auctions) const
+{
+    auctions.erase(std::remove_if(auctions.begin(), auctions.end(), [this, player](uint32 auctionId)
     {
-        auto Aentry = AentryItr.second;
+        AuctionEntry* Aentry = GetAuction(auctionId);
+        if (!Aentry)
+            return true;
+
         Item* item = sAuctionMgr.GetAItem(Aentry->itemGuidLow);
         if (!item)
-            continue;
-
-        {
-            ItemPrototype const* proto = item->GetProto();
-
-            if (itemClass != 0xffffffff && proto->Class != itemClass)
-                continue;
-
-            if (itemSubClass != 0xffffffff && proto->SubClass != itemSubClass)
-                continue;
+            return true;
 
-            if (inventoryType != 0xffffffff && proto->InventoryType != inventoryType)
-            {
-                if (inventoryType != INVTYPE_CHEST || proto->InventoryType != INVTYPE_ROBE)
-                {
-                    // if inventory type is chest, we want to return robes too
-                    // i.e. cloth chests are in most cases robes by definition
-
-                    continue;
-                }
-            }
-
-            if (quality != 0xffffffff && proto->Quality < quality)
-                continue;
+        if (player->CanUseItem(item) != EQUIP_ERR_OK)
+            return true;
 
-            if (levelmin != 0x00 && (proto->RequiredLevel < levelmin || (levelmax != 0x00 && proto->RequiredLevel > levelmax)))
-                continue;
-
-            if (usable != 0x00)
-            {
-                if (player->CanUseItem(item) != EQUIP_ERR_OK)
-                    continue;
-
-                if (proto->Class == ITEM_CLASS_RECIPE)
-                {
-                    if (SpellEntry const* spell = sSpellTemplate.LookupEntry<SpellEntry>(proto->Spells[0].SpellId))
-                    {
-                        if (player->HasSpell(spell->EffectTriggerSpell[EFFECT_INDEX_0]))
-                            continue;
-                    }
-                }
-            }
-
-            std::string name = proto->Name1;
-            sObjectMgr.GetItemLocaleStrings(proto->ItemId, loc_idx, &name);
-
-            if (!wsearchedname.empty() && !Utf8FitTo(name, wsearchedname))
-                continue;
-
-            if (count < MAX_AUCTION_ITEMS_CLIENT_UI_PAGE && totalcount >= listfrom)
+        ItemPrototype const* proto = item->GetProto();
+        if (proto->Class == ITEM_CLASS_RECIPE)
+        {
+            if (SpellEntry const* spell = sSpellTemplate.LookupEntry<SpellEntry>(proto->Spells[0].SpellId))
             {
-                ++count;
-                Aentry->BuildAuctionInfo(data);
+                if (player->HasSpell(spell->EffectTriggerSpell[EFFECT_INDEX_0]))
+                    return true;
             }
         }
 
-        ++totalcount;
-    }
+        return false;
+    }), auctions.end());
 }
 
 AuctionEntry* AuctionHouseObject::AddAuction(AuctionHouseEntry const* auctionHouseEntry, Item* newItem, uint32 etime, uint32 bid, uint32 buyout, uint32 deposit, Player* pl /*= nullptr*/)
@@ -673,10 +618,11 @@ AuctionEntry* AuctionHouseObject::AddAuction(AuctionHouseEntry const* auctionHou
     AH->deposit = deposit;
     AH->auctionHouseEntry = auctionHouseEntry;
 
-    AddAuction(AH);
-
+    // the item is listed with the auction
     sAuctionMgr.AddAItem(newItem);
 
+    AddAuction(AH);
+
     if (pl)
         pl->MoveItemFromInventory(newItem->GetBagSlot(), newItem->GetSlot(), true);
 
@@ -799,6 +745,9 @@ bool AuctionEntry::UpdateBid(uint32 newbid, Player* newbidder /*=nullptr*/)
     bidder = newbidder ? newbidder->GetGUIDLow() : 0;
     bid = newbid;
 
+    if ((newbid < buyout) || (buyout == 0))
+        sAuctionMgr.GetAuctionsMap(auctionHouseEntry)->UpdateAuction(this);
+
     if ((newbid < buyout) || (buyout == 0))                 // bid
     {
         if (auction_owner && newbidder) // don't send notification unless newbidder is set (AHBot bidding), otherwise player will be told auction was sold when it was just a bid
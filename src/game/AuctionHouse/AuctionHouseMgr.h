@@ -79,11 +79,18 @@ struct AuctionEntry
     bool UpdateBid(uint32 newbid, Player* newbidder = nullptr);// true if normal bid, false if buyout, bidder==nullptr for generated bid
 };
 
+enum AuctionHouseType
+{
+    AUCTION_HOUSE_ALLIANCE  = 0,
+    AUCTION_HOUSE_HORDE     = 1,
+    AUCTION_HOUSE_NEUTRAL   = 2
+};
+
 // this class is used as auctionhouse instance
 class AuctionHouseObject
 {
     public:
-        AuctionHouseObject() {}
+        AuctionHouseObject() : m_houseType(AUCTION_HOUSE_NEUTRAL) {}
         ~AuctionHouseObject()
         {
             for (AuctionEntryMap::const_iterator itr = AuctionsMap.begin(); itr != AuctionsMap.end(); ++itr)
@@ -93,16 +100,15 @@ class AuctionHouseObject
         typedef std::map<uint32, AuctionEntry*> AuctionEntryMap;
         typedef std::pair<AuctionEntryMap::const_iterator, AuctionEntryMap::const_iterator> AuctionEntryMapBounds;
 
+        void SetHouseType(AuctionHouseType houseType) { m_houseType = houseType; }
+        AuctionHouseType GetHouseType() const { return m_houseType; }
+
         uint32 GetCount() const { return AuctionsMap.size(); }
 
         AuctionEntryMap const& GetAuctions() const { return AuctionsMap; }
         AuctionEntryMapBounds GetAuctionsBounds() const {return AuctionEntryMapBounds(AuctionsMap.begin(), AuctionsMap.end()); }
 
-        void AddAuction(AuctionEntry* ah)
-        {
-            MANGOS_ASSERT(ah);
-            AuctionsMap[ah->Id] = ah;
-        }
+        void AddAuction(AuctionEntry* ah);
 
         AuctionEntry* GetAuction(uint32 id) const
         {
@@ -110,26 +116,18 @@ class AuctionHouseObject
             return itr != AuctionsMap.end() ? itr->second : nullptr;
         }
 
-        bool RemoveAuction(uint32 id) { return !!AuctionsMap.erase(id); }
+        bool RemoveAuction(uint32 id);
+        // passes a changed bid on to the auction lists
+        void UpdateAuction(AuctionEntry const* auction) const;
 
         void Update();
 
-        void BuildListBidderItems(WorldPacket& data, Player* player, uint32 listfrom, uint32& count, uint32& totalcount);
-        void BuildListOwnerItems(WorldPacket& data, Player* player, uint32 listfrom, uint32& count, uint32& totalcount);
-        void BuildListAuctionItems(WorldPacket& data, Player* player,
-                                   std::wstring const& searchedname, uint32 listfrom, uint32 levelmin, uint32 levelmax, uint32 usable,
-                                   uint32 inventoryType, uint32 itemClass, uint32 itemSubClass, uint32 quality,
-                                   uint32& count, uint32& totalcount);
+        // the usable check of a browse query, keeps the auctions the search thread found for the other filters which player can use
+        void SelectUsableItems(Player* player, std::vector<uint32>& auctions) const;
         AuctionEntry* AddAuction(AuctionHouseEntry const* auctionHouseEntry, Item* newItem, uint32 etime, uint32 bid, uint32 buyout = 0, uint32 deposit = 0, Player* pl = nullptr);
     private:
         AuctionEntryMap AuctionsMap;
-};
-
-enum AuctionHouseType
-{
-    AUCTION_HOUSE_ALLIANCE  = 0,
-    AUCTION_HOUSE_HORDE     = 1,
-    AUCTION_HOUSE_NEUTRAL   = 2
+        AuctionHouseType m_houseType;
 };
 
 #define MAX_AUCTION_HOUSE_TYPE 3
@@ -0,0 +1,509 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "AuctionHouse/AuctionHouseSearch.h"
+#include "Entities/Item.h"
+#include "Entities/Player.h"
+#include "Globals/ObjectMgr.h"
+#include "Server/WorldPacket.h"
+#include "Server/WorldSession.h"
+#include "World/World.h"
+
+#include <algorithm>
+
+// time a browse result is kept for the next page
+static const std::chrono::seconds AUCTION_SEARCH_RESULT_LIFETIME(60);
+
+AuctionListing::AuctionListing(AuctionEntry const& auction, Item const& item, std::shared_ptr<AuctionSearchNames const> searchNames) :
+    id(auction.Id), proto(item.GetProto()),
+    enchantmentId(item.GetEnchantmentId(EnchantmentSlot(PERM_ENCHANTMENT_SLOT))), randomPropertyId(item.GetItemRandomPropertyId()),
+    suffixFactor(item.GetItemSuffixFactor()), count(item.GetCount()), charges(item.GetSpellCharges()),
+    owner(auction.owner), startbid(auction.startbid), bid(auction.bid), outbid(auction.bid ? auction.GetAuctionOutBid() : 0),
+    buyout(auction.buyout), expireTime(auction.expireTime), bidder(auction.bidder), searchNames(std::move(searchNames))
+{
+}
+
+// same as AuctionEntry::BuildAuctionInfo
+void AuctionListing::BuildAuctionInfo(WorldPacket& data) const
+{
+    data << uint32(id);
+    data << uint32(proto->ItemId);
+    data << uint32(enchantmentId);
+    data << uint32(randomPropertyId);                       // random item property id
+    data << uint32(suffixFactor);                           // SuffixFactor
+    data << uint32(count);                                  // item->count
+    data << uint32(charges);                                // item->charge FFFFFFF
+    data << ObjectGuid(HIGHGUID_PLAYER, owner);             // Auction->owner
+    data << uint32(startbid);                               // Auction->startbid (not sure if useful)
+    data << uint32(outbid);                                 // minimal outbid
+    data << uint32(buyout);                                 // auction->buyout
+    data << uint32((expireTime - time(nullptr))*IN_MILLISECONDS); // time left
+    data << ObjectGuid(HIGHGUID_PLAYER, bidder);            // auction->bidder current
+    data << uint32(bid);                                    // current bid
+}
+
+// hands a reply to the world thread, sessions are only touched there
+static void SendReply(uint32 accountId, ObjectGuid playerGuid, WorldPacket const& data)
+{
+    sWorld.GetMessager().AddMessage([accountId, playerGuid, data](World* world)
+    {
+        WorldSession* session = world->FindSession(accountId);
+        if (session && session->GetPlayer() && session->GetPlayer()->GetObjectGuid() == playerGuid)
+            session->SendPacket(data);
+    });
+}
+
+static bool ListingIdLess(AuctionListing const* left, AuctionListing const* right)
+{
+    return left->id < right->id;
+}
+
+void AuctionHouseSearch::Update()
+{
+    while (!World::IsStopped())
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_wakeLock);
+            m_wakeCondition.wait_for(lock, std::chrono::milliseconds(500), [this] { return m_wake; });
+            m_wake = false;
+        }
+
+        m_messager.Execute(this);
+        RemoveOldSearchResults();
+    }
+}
+
+void AuctionHouseSearch::AddMessage(std::function<void(AuctionHouseSearch*)> const& message)
+{
+    m_messager.AddMessage(message);
+    {
+        std::lock_guard<std::mutex> guard(m_wakeLock);
+        m_wake = true;
+    }
+    m_wakeCondition.notify_one();
+}
+
+void AuctionHouseSearch::PublishAuction(AuctionHouseType houseType, AuctionEntry const& auction)
+{
+    // auctions without item are not listed
+    Item* item = sAuctionMgr.GetAItem(auction.itemGuidLow);
+    if (!item)
+        return;
+
+    AddMessage([houseType, listing = AuctionListing(auction, *item, GetSearchNames(item->GetProto()))](AuctionHouseSearch* search)
+    {
+        search->SetListing(houseType, listing);
+    });
+}
+
+void AuctionHouseSearch::WithdrawAuction(AuctionHouseType houseType, uint32 auctionId)
+{
+    AddMessage([houseType, auctionId](AuctionHouseSearch* search)
+    {
+        search->RemoveListing(houseType, auctionId);
+    });
+}
+
+void AuctionHouseSearch::QueryAuctionItems(WorldSession const* session, AuctionHouseType houseType, AuctionSearchQuery const& query, uint32 listfrom)
+{
+    AddMessage([accountId = session->GetAccountId(), playerGuid = session->GetPlayer()->GetObjectGuid(), locIdx = session->GetSessionDbLocaleIndex(),
+                houseType, query, listfrom](AuctionHouseSearch* search)
+    {
+        search->ListAuctionItems(accountId, playerGuid, locIdx, houseType, query, listfrom);
+    });
+}
+
+void AuctionHouseSearch::QueryOwnerItems(WorldSession const* session, AuctionHouseType houseType, uint32 listfrom)
+{
+    AddMessage([accountId = session->GetAccountId(), playerGuid = session->GetPlayer()->GetObjectGuid(), houseType, listfrom](AuctionHouseSearch* search)
+    {
+        search->ListOwnerItems(accountId, playerGuid, houseType, listfrom);
+    });
+}
+
+void AuctionHouseSearch::QueryBidderItems(WorldSession const* session, AuctionHouseType houseType, std::vector<uint32> const& outbidded, uint32 listfrom)
+{
+    AddMessage([accountId = session->GetAccountId(), playerGuid = session->GetPlayer()->GetObjectGuid(), houseType, outbidded, listfrom](AuctionHouseSearch* search)
+    {
+        search->ListBidderItems(accountId, playerGuid, houseType, outbidded, listfrom);
+    });
+}
+
+void AuctionHouseSearch::ReloadSearchNames()
+{
+    m_searchNames.clear();
+
+    // the listings get the new names, their indexes stay the same
+    for (uint32 houseType = 0; houseType < MAX_AUCTION_HOUSE_TYPE; ++houseType)
+        for (auto const& itr : sAuctionMgr.GetAuctionsMap(AuctionHouseType(houseType))->GetAuctions())
+            PublishAuction(AuctionHouseType(houseType), *itr.second);
+}
+
+std::shared_ptr<AuctionSearchNames const> AuctionHouseSearch::GetSearchNames(ItemPrototype const* proto)
+{
+    auto itr = m_searchNames.find(proto->ItemId);
+    if (itr != m_searchNames.end())
+        return itr->second;
+
+    // a name not converting never matches, as an empty one
+    auto toSearchName = [](std::string const& name)
+    {
+        std::wstring wname;
+        if (Utf8toWStr(name, wname))
+            wstrToLower(wname);
+        else
+            wname.clear();
+        return wname;
+    };
+
+    auto names = std::make_shared<AuctionSearchNames>();
+    names->push_back(toSearchName(proto->Name1));
+    if (ItemLocale const* locale = sObjectMgr.GetItemLocale(proto->ItemId))
+        for (std::string const& name : locale->Name)
+            names->push_back(name.empty() ? names->front() : toSearchName(name));
+
+    m_searchNames[proto->ItemId] = names;
+    return names;
+}
+
+void AuctionHouseSearch::SetListing(AuctionHouseType houseType, AuctionListing const& listing)
+{
+    AuctionHouseCopy& house = m_houses[houseType];
+    auto result = house.listings.emplace(listing.id, listing);
+    // a new bid, the item and so the indexes stay the same
+    if (!result.second)
+    {
+        result.first->second = listing;
+        return;
+    }
+
+    AuctionListing const* entry = &result.first->second;
+    ItemPrototype const* proto = entry->proto;
+
+    // new auctions get the highest id, so this is an append nearly always
+    auto insert = [entry](AuctionIndexList& list)
+    {
+        list.insert(std::upper_bound(list.begin(), list.end(), entry, ListingIdLess), entry);
+    };
+
+    insert(house.classIndex[proto->Class]);
+    insert(house.subClassIndex[proto->Class << 16 | proto->SubClass]);
+    insert(house.inventoryTypeIndex[proto->InventoryType]);
+    insert(house.qualityIndex[proto->Quality]);
+    insert(house.requiredLevelIndex[proto->RequiredLevel]);
+}
+
+void AuctionHouseSearch::RemoveListing(AuctionHouseType houseType, uint32 auctionId)
+{
+    AuctionHouseCopy& house = m_houses[houseType];
+    auto itr = house.listings.find(auctionId);
+    if (itr == house.listings.end())
+        return;
+
+    AuctionListing const* entry = &itr->second;
+    ItemPrototype const* proto = entry->proto;
+
+    auto remove = [entry](AuctionIndexList& list)
+    {
+        auto itr = std::lower_bound(list.begin(), list.end(), entry, ListingIdLess);
+        if (itr != list.end() && *itr == entry)
+            list.erase(itr);
+    };
+
+    remove(house.classIndex[proto->Class]);
+    remove(house.subClassIndex[proto->Class << 16 | proto->SubClass]);
+    remove(house.inventoryTypeIndex[proto->InventoryType]);
+    remove(house.qualityIndex[proto->Quality]);
+    remove(house.requiredLevelIndex[proto->RequiredLevel]);
+
+    house.listings.erase(itr);
+}
+
+void AuctionHouseSearch::ListAuctionItems(uint32 accountId, ObjectGuid playerGuid, int32 locIdx, AuctionHouseType houseType, AuctionSearchQuery const& query, uint32 listfrom)
+{
+    AuctionHouseCopy& house = m_houses[houseType];
+    auto now = std::chrono::steady_clock::now();
+
+    // the client asks for the first page on a new search, the other pages reuse its result
+    AuctionSearchResult& result = house.searchResults[playerGuid.GetCounter()];
+    if (listfrom == 0 || !(result.query == query) || now - result.searchTime > AUCTION_SEARCH_RESULT_LIFETIME)
+    {
+        result.query = query;
+        result.auctions.clear();
+        result.usableChecked = false;
+        FindAuctions(house, locIdx, query, result.auctions);
+    }
+    result.searchTime = now;
+
+    // the usable check needs the player, the world thread does it once for the whole result and passes it back
+    if (query.usable != 0x00 && !result.usableChecked)
+    {
+        sWorld.GetMessager().AddMessage([accountId, playerGuid, houseType, query, auctions = result.auctions, listfrom](World* world) mutable
+        {
+            WorldSession* session = world->FindSession(accountId);
+            Player* player = session ? session->GetPlayer() : nullptr;
+            if (!player || player->GetObjectGuid() != playerGuid)
+                return;
+
+            sAuctionMgr.GetAuctionsMap(houseType)->SelectUsableItems(player, auctions);
+
+            world->GetAuctionHouseSearch().AddMessage([accountId, playerGuid, houseType, query, auctions = std::move(auctions), listfrom](AuctionHouseSearch* search)
+            {
+                search->ListUsableAuctionItems(accountId, playerGuid, houseType, query, auctions, listfrom);
+            });
+        });
+        return;
+    }
+
+    SendAuctionItems(accountId, playerGuid, house, result.auctions, listfrom);
+}
+
+void AuctionHouseSearch::ListUsableAuctionItems(uint32 accountId, ObjectGuid playerGuid, AuctionHouseType houseType, AuctionSearchQuery const& query, std::vector<uint32> const& auctions, uint32 listfrom)
+{
+    AuctionHouseCopy& house = m_houses[houseType];
+
+    // the next pages of the same search are listed from here, unless the player searched again meanwhile
+    auto itr = house.searchResults.find(playerGuid.GetCounter());
+    if (itr != house.searchResults.end() && itr->second.query == query && !itr->second.usableChecked)
+    {
+        itr->second.auctions = auctions;
+        itr->second.usableChecked = true;
+    }
+
+    SendAuctionItems(accountId, playerGuid, house, auctions, listfrom);
+}
+
+void AuctionHouseSearch::SendAuctionItems(uint32 accountId, ObjectGuid playerGuid, AuctionHouseCopy const& house, std::vector<uint32> const& auctions, uint32 listfrom) const
+{
+    WorldPacket data(SMSG_AUCTION_LIST_RESULT, (4 + 4));
+    uint32 count = 0;
+    data << uint32(0);
+
+    for (size_t i = listfrom; i < auctions.size() && count < MAX_AUCTION_ITEMS_CLIENT_UI_PAGE; ++i)
+    {
+        // sold or expired since the search
+        auto itr = house.listings.find(auctions[i]);
+        if (itr == house.listings.end())
+            continue;
+
+        ++count;
+        itr->second.BuildAuctionInfo(data);
+    }
+
+    data.put<uint32>(0, count);
+    data << uint32(auctions.size());
+    SendReply(accountId, playerGuid, data);
+}
+
+void AuctionHouseSearch::ListOwnerItems(uint32 accountId, ObjectGuid playerGuid, AuctionHouseType houseType, uint32 listfrom)
+{
+    WorldPacket data(SMSG_AUCTION_OWNER_LIST_RESULT, (4 + 4));
+    data << (uint32) 0;                                     // amount place holder
+
+    uint32 count = 0;
+    uint32 totalcount = 0;
+
+    for (auto const& itr : m_houses[houseType].listings)
+    {
+        AuctionListing const& listing = itr.second;
+        if (listing.owner == playerGuid.GetCounter())
+        {
+            if (count < MAX_AUCTION_ITEMS_CLIENT_UI_PAGE && totalcount >= listfrom)
+            {
+                listing.BuildAuctionInfo(data);
+                ++count;
+            }
+            ++totalcount;
+        }
+    }
+
+    data.put<uint32>(0, count);
+    data << uint32(totalcount);
+    SendReply(accountId, playerGuid, data);
+}
+
+void AuctionHouseSearch::ListBidderItems(uint32 accountId, ObjectGuid playerGuid, AuctionHouseType houseType, std::vector<uint32> const& outbidded, uint32 listfrom)
+{
+    AuctionHouseCopy const& house = m_houses[houseType];
+
+    WorldPacket data(SMSG_AUCTION_BIDDER_LIST_RESULT, (4 + 4 + 4));
+    data << uint32(0);                                      // add 0 as count
+    uint32 count = 0;
+    uint32 totalcount = 0;
+
+    for (uint32 outbiddedAuctionId : outbidded)             // add all data, which client requires
+    {
+        auto itr = house.listings.find(outbiddedAuctionId);
+        if (itr != house.listings.end())
+        {
+            itr->second.BuildAuctionInfo(data);
+            ++totalcount;
+            ++count;
+        }
+    }
+
+    for (auto const& itr : house.listings)
+    {
+        AuctionListing const& listing = itr.second;
+        if (listing.bidder == playerGuid.GetCounter())
+        {
+            if (count < MAX_AUCTION_ITEMS_CLIENT_UI_PAGE && totalcount >= listfrom)
+            {
+                listing.BuildAuctionInfo(data);
+                ++count;
+            }
+            ++totalcount;
+        }
+    }
+
+    data.put<uint32>(0, count);                             // add count to placeholder
+    data << uint32(totalcount);
+    SendReply(accountId, playerGuid, data);
+}
+
+void AuctionHouseSearch::FindAuctions(AuctionHouseCopy const& house, int32 locIdx, AuctionSearchQuery const& query, std::vector<uint32>& auctions)
+{
+    // the index lists holding all auctions that pass one filter, the filter leaving the fewest auctions to check is used
+    std::vector<AuctionIndexList const*> candidates;
+    size_t candidateCount = house.listings.size();
+    bool indexed = false;
+    auto narrow = [&](std::vector<AuctionIndexList const*> const& lists)
+    {
+        size_t size = 0;
+        for (AuctionIndexList const* list : lists)
+            size += list->size();
+
+        if (size < candidateCount || !indexed)
+        {
+            candidates = lists;
+            candidateCount = size;
+            indexed = true;
+        }
+    };
+    auto lookup = [](AuctionIndexMap const& index, uint32 key)
+    {
+        static AuctionIndexList const emptyList;
+        AuctionIndexMap::const_iterator itr = index.find(key);
+        return itr != index.end() ? &itr->second : &emptyList;
+    };
+
+    if (query.itemClass != 0xffffffff)
+        narrow({ query.itemSubClass != 0xffffffff ? lookup(house.subClassIndex, query.itemClass << 16 | query.itemSubClass) : lookup(house.classIndex, query.itemClass) });
+
+    if (query.inventoryType != 0xffffffff)
+    {
+        // if inventory type is chest, we want to return robes too
+        if (query.inventoryType == INVTYPE_CHEST)
+            narrow({ lookup(house.inventoryTypeIndex, INVTYPE_CHEST), lookup(house.inventoryTypeIndex, INVTYPE_ROBE) });
+        else
+            narrow({ lookup(house.inventoryTypeIndex, query.inventoryType) });
+    }
+
+    if (query.quality != 0xffffffff)
+    {
+        std::vector<AuctionIndexList const*> lists;
+        for (auto itr = house.qualityIndex.lower_bound(query.quality); itr != house.qualityIndex.end(); ++itr)
+            lists.push_back(&itr->second);
+        narrow(lists);
+    }
+
+    if (query.levelmin != 0x00)
+    {
+        std::vector<AuctionIndexList const*> lists;
+        for (auto itr = house.requiredLevelIndex.lower_bound(query.levelmin); itr != house.requiredLevelIndex.end(); ++itr)
+        {
+            if (query.levelmax != 0x00 && itr->first > query.levelmax)
+                break;
+            lists.push_back(&itr->second);
+        }
+        narrow(lists);
+    }
+
+    // the remaining filters are checked on every candidate
+    auto check = [&](AuctionListing const& listing)
+    {
+        ItemPrototype const* proto = listing.proto;
+
+        if (query.itemClass != 0xffffffff && proto->Class != query.itemClass)
+            return;
+
+        if (query.itemSubClass != 0xffffffff && proto->SubClass != query.itemSubClass)
+            return;
+
+        if (query.inventoryType != 0xffffffff && proto->InventoryType != query.inventoryType)
+        {
+            if (query.inventoryType != INVTYPE_CHEST || proto->InventoryType != INVTYPE_ROBE)
+                return;
+        }
+
+        if (query.quality != 0xffffffff && proto->Quality < query.quality)
+            return;
+
+        if (query.levelmin != 0x00 && (proto->RequiredLevel < query.levelmin || (query.levelmax != 0x00 && proto->RequiredLevel > query.levelmax)))
+            return;
+
+        if (!query.name.empty())
+        {
+            // locales without own name use the default one
+            AuctionSearchNames const& names = *listing.searchNames;
+            size_t nameIndex = size_t(locIdx + 1) < names.size() ? locIdx + 1 : 0;
+            if (names[nameIndex].find(query.name) == std::wstring::npos)
+                return;
+        }
+
+        auctions.push_back(listing.id);
+    };
+
+    if (!indexed)
+    {
+        for (auto const& itr : house.listings)
+            check(itr.second);
+    }
+    else if (candidates.size() == 1)
+    {
+        for (AuctionListing const* listing : *candidates.front())
+            check(*listing);
+    }
+    else
+    {
+        // lists of one index never share an auction
+        AuctionIndexList merged;
+        merged.reserve(candidateCount);
+        for (AuctionIndexList const* list : candidates)
+            merged.insert(merged.end(), list->begin(), list->end());
+        std::sort(merged.begin(), merged.end(), ListingIdLess);
+
+        for (AuctionListing const* listing : merged)
+            check(*listing);
+    }
+}
+
+void AuctionHouseSearch::RemoveOldSearchResults()
+{
+    auto now = std::chrono::steady_clock::now();
+    for (AuctionHouseCopy& house : m_houses)
+    {
+        for (auto itr = house.searchResults.begin(); itr != house.searchResults.end();)
+        {
+            if (now - itr->second.searchTime > AUCTION_SEARCH_RESULT_LIFETIME)
+                itr = house.searchResults.erase(itr);
+            else
+                ++itr;
+        }
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUCTION_HOUSE_SEARCH_H
+#define _AUCTION_HOUSE_SEARCH_H
+
+#include "Common.h"
+#include "AuctionHouse/AuctionHouseMgr.h"
+#include "Entities/ObjectGuid.h"
+#include "Multithreading/Messager.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+struct ItemPrototype;
+class WorldSession;
+
+// filters of an auction house browse query
+struct AuctionSearchQuery
+{
+    std::wstring name;                                      // lower case
+    uint32 levelmin;
+    uint32 levelmax;
+    uint32 usable;
+    uint32 inventoryType;
+    uint32 itemClass;
+    uint32 itemSubClass;
+    uint32 quality;
+
+    bool operator==(AuctionSearchQuery const& other) const
+    {
+        return name == other.name && levelmin == other.levelmin && levelmax == other.levelmax && usable == other.usable &&
+               inventoryType == other.inventoryType && itemClass == other.itemClass && itemSubClass == other.itemSubClass && quality == other.quality;
+    }
+};
+
+// lower case item names searched by browse queries, by storage locale index + 1 (0 is the default name)
+typedef std::vector<std::wstring> AuctionSearchNames;
+
+// what the auction lists show of an auction, copied on the world thread whenever the auction changes
+struct AuctionListing
+{
+    AuctionListing(AuctionEntry const& auction, Item const& item, std::shared_ptr<AuctionSearchNames const> searchNames);
+
+    void BuildAuctionInfo(WorldPacket& data) const;
+
+    uint32 id;
+    ItemPrototype const* proto;
+    uint32 enchantmentId;
+    int32 randomPropertyId;
+    uint32 suffixFactor;
+    uint32 count;
+    uint32 charges;
+    uint32 owner;
+    uint32 startbid;
+    uint32 bid;
+    uint32 outbid;
+    uint32 buyout;
+    time_t expireTime;
+    uint32 bidder;
+    std::shared_ptr<AuctionSearchNames const> searchNames;  // shared by all listings of the item entry
+};
+
+// Answers the auction list queries of the sessions on its own thread, from a copy of the auction houses. The world
+// thread stays the owner of the auctions and passes every change on as a message, queued in order with the queries,
+// so a query sees the auction houses as they were when it was made. Replies go back through the world messager and
+// are sent if the session still plays the same character.
+class AuctionHouseSearch
+{
+    public:
+        void Update();
+
+        // called on the world thread
+        void PublishAuction(AuctionHouseType houseType, AuctionEntry const& auction);
+        void WithdrawAuction(AuctionHouseType houseType, uint32 auctionId);
+        void QueryAuctionItems(WorldSession const* session, AuctionHouseType houseType, AuctionSearchQuery const& query, uint32 listfrom);
+        void QueryOwnerItems(WorldSession const* session, AuctionHouseType houseType, uint32 listfrom);
+        void QueryBidderItems(WorldSession const* session, AuctionHouseType houseType, std::vector<uint32> const& outbidded, uint32 listfrom);
+        // the item locales changed, takes the new names to all listings
+        void ReloadSearchNames();
+
+    private:
+        // auctions sorted by id, the order browse results are listed in
+        typedef std::vector<AuctionListing const*> AuctionIndexList;
+        typedef std::unordered_map<uint32, AuctionIndexList> AuctionIndexMap;
+
+        // ids of the auctions found by the last browse query of a player, to page through without searching again
+        struct AuctionSearchResult
+        {
+            AuctionSearchQuery query;
+            std::chrono::steady_clock::time_point searchTime;
+            std::vector<uint32> auctions;
+            bool usableChecked;                             // the world thread removed the auctions the player cannot use
+        };
+
+        struct AuctionHouseCopy
+        {
+            std::map<uint32, AuctionListing> listings;
+
+            // item template fields searched by browse queries
+            AuctionIndexMap classIndex;
+            AuctionIndexMap subClassIndex;                  // by class << 16 | subclass
+            AuctionIndexMap inventoryTypeIndex;
+            std::map<uint32, AuctionIndexList> qualityIndex;
+            std::map<uint32, AuctionIndexList> requiredLevelIndex;
+
+            std::unordered_map<uint32, AuctionSearchResult> searchResults; // by player low guid
+        };
+
+        void AddMessage(std::function<void(AuctionHouseSearch*)> const& message);
+
+        void SetListing(AuctionHouseType houseType, AuctionListing const& listing);
+        void RemoveListing(AuctionHouseType houseType, uint32 auctionId);
+        void ListAuctionItems(uint32 accountId, ObjectGuid playerGuid, int32 locIdx, AuctionHouseType houseType, AuctionSearchQuery const& query, uint32 listfrom);
+        void ListUsableAuctionItems(uint32 accountId, ObjectGuid playerGuid, AuctionHouseType houseType, AuctionSearchQuery const& query, std::vector<uint32> const& auctions, uint32 listfrom);
+        void SendAuctionItems(uint32 accountId, ObjectGuid playerGuid, AuctionHouseCopy const& house, std::vector<uint32> const& auctions, uint32 listfrom) const;
+        void ListOwnerItems(uint32 accountId, ObjectGuid playerGuid, AuctionHouseType houseType, uint32 listfrom);
+        void ListBidderItems(uint32 accountId, ObjectGuid playerGuid, AuctionHouseType houseType, std::vector<uint32> const& outbidded, uint32 listfrom);
+
+        void FindAuctions(AuctionHouseCopy const& house, int32 locIdx, AuctionSearchQuery const& query, std::vector<uint32>& auctions);
+        void RemoveOldSearchResults();
+
+        // item names in all locales, built on the world thread which owns the locales
+        std::shared_ptr<AuctionSearchNames const> GetSearchNames(ItemPrototype const* proto);
+
+        AuctionHouseCopy m_houses[MAX_AUCTION_HOUSE_TYPE];
+        std::unordered_map<uint32, std::shared_ptr<AuctionSearchNames const>> m_searchNames; // by item entry, world thread only
+
+        Messager<AuctionHouseSearch> m_messager;
+        std::mutex m_wakeLock;
+        std::condition_variable m_wakeCondition;
+        bool m_wake = false;
+};
+
+#endif
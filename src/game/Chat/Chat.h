@@ -314,6 +314,7 @@ class ChatHandler
         bool HandleDebugIncPacketHistory(char* args);
 
         bool HandleDebugTransports(char* args);
+        bool HandleDebugPoolsCommand(char* args);
 
         bool HandleDebugSpawnsList(char* args);
         bool HandleDebugRespawnDynguid(char* args);
@@ -952,6 +952,7 @@ bool ChatHandler::HandleReloadLocalesItemCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading Locales Item ... ");
     sObjectMgr.LoadItemLocales();
+    sWorld.GetAuctionHouseSearch().ReloadSearchNames();
     SendGlobalSysMessage("DB table `locales_item` reloaded.");
     return true;
 }
@@ -4601,9 +4602,10 @@ bool ChatHandler::HandleResetAllCommand(char* args)
     }
 
     CharacterDatabase.PExecute("UPDATE characters SET at_login = at_login | '%u' WHERE (at_login & '%u') = '0'", atLogin, atLogin);
-    HashMapHolder<Player>::MapType const& plist = sObjectAccessor.GetPlayers();
-    for (const auto& itr : plist)
-        itr.second->SetAtLoginFlag(atLogin);
+    sObjectAccessor.ExecuteForAllPlayers([atLogin](Player* player)
+    {
+        player->SetAtLoginFlag(atLogin);
+    });
 
     return true;
 }
@@ -36,6 +36,7 @@
 #include "Maps/InstanceData.h"
 #include "Cinematics/M2Stores.h"
 #include "Entities/Transports.h"
+#include "Utilities/ObjectPool.h"
 #include <string>
 
 bool ChatHandler::HandleDebugSendSpellFailCommand(char* args)
@@ -1736,6 +1737,15 @@ bool ChatHandler::HandleDebugTransports(char* args)
     return true;
 }
 
+bool ChatHandler::HandleDebugPoolsCommand(char* /*args*/)
+{
+    PSendSysMessage("Object pools, " UI64FMTD " KB reserved:", ObjectPool::GetReservedBytes() / 1024);
+    for (ObjectPoolStats const& stats : ObjectPool::GetAllStats())
+        PSendSysMessage("%s: live " UI64FMTD " high water " UI64FMTD " allocations " UI64FMTD " recycled %.1f%%", stats.name,
+                        stats.live, stats.highWater, stats.allocations, stats.allocations ? stats.recycled * 100.0 / stats.allocations : 0.0);
+    return true;
+}
+
 bool ChatHandler::HandleDebugSpawnsList(char* args)
 {
     Player* player = GetSession()->GetPlayer();
@@ -1878,7 +1878,10 @@ void Creature::SetDeathState(DeathState s)
         {
             m_respawnTime = std::numeric_limits<time_t>::max();
             if (m_respawnDelay && s == JUST_DIED && !GetCreatureGroup())
-                GetMap()->GetSpawnManager().AddCreature(GetDbGuid());
+            {
+                uint32 dbGuid = GetDbGuid();
+                GetMap()->ExecuteOrDefer([dbGuid](Map* map) { map->GetSpawnManager().AddCreature(dbGuid); });
+            }
         }
     }
 
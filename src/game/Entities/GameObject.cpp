@@ -583,7 +583,7 @@ void GameObject::Update(const uint32 diff)
             switch (GetGoType())
             {
                 case GAMEOBJECT_TYPE_TRAP:
-                    if (m_events.GetEvents().size() > 0)
+                    if (m_events.HasEvents())
                     {
                         preventDespawn = true;
                         break;
@@ -706,7 +706,10 @@ void GameObject::Update(const uint32 diff)
             {
                 m_respawnTime = std::numeric_limits<time_t>::max();
                 if (m_respawnDelay && !GetGameObjectGroup())
-                    GetMap()->GetSpawnManager().AddGameObject(GetDbGuid());
+                {
+                    uint32 dbGuid = GetDbGuid();
+                    GetMap()->ExecuteOrDefer([dbGuid](Map* map) { map->GetSpawnManager().AddGameObject(dbGuid); });
+                }
 
                 if (m_respawnDelay || !m_spawnedByDefault || m_forcedDespawn)
                     AddObjectToRemoveList();
@@ -2028,7 +2031,13 @@ void GameObject::UpdateCollisionState() const
     if (!m_model || !IsInWorld())
         return;
 
-    m_model->enable(IsCollisionEnabled() ? true : false);
+    bool enabled = IsCollisionEnabled();
+    if (m_model->isEnabled() == enabled)
+        return;
+
+    m_model->enable(enabled);
+    if (GetMap()->ContainsGameObjectModel(*m_model))
+        GetMap()->InvalidateQueryCache(*m_model);
 }
 
 void GameObject::UpdateModel()
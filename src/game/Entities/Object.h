@@ -112,7 +112,7 @@ class ChatHandler;
 struct SpellEntry;
 class GenericTransport;
 
-typedef std::unordered_map<Player*, UpdateData> UpdateDataMapType;
+typedef PlayerUpdateDataMap UpdateDataMapType;
 
 class CooldownData
 {
@@ -364,6 +364,8 @@ class WorldUpdateCounter
 
 class Object
 {
+        friend class Map;
+
     public:
         virtual ~Object();
 
@@ -653,6 +655,9 @@ class Object
         bool m_inWorld;
         bool m_itsNewObject;
 
+        static uint32 const CLIENT_UPDATE_NOT_QUEUED = uint32(-1);
+        uint32 m_clientUpdateSlot;                          // index in the client update queue of the map, managed by Map
+
         PackedGuid m_PackGUID;
 
         Object(const Object&);                              // prevent generation copy constructor
@@ -73,8 +73,13 @@
 #include "playerbot/PlayerbotAIConfig.h"
 #endif
 
+#ifdef BUILD_METRICS
+#include "Metric/Metric.h"
+#endif
+
 #include <algorithm>
 #include <cmath>
+#include <type_traits>
 
 #define ZONE_UPDATE_INTERVAL (1*IN_MILLISECONDS)
 
@@ -90,6 +95,40 @@
 #define SKILL_PERM_BONUS(x)    int16(PAIR32_HIPART(x))
 #define MAKE_SKILL_BONUS(t, p) MAKE_PAIR32(t,p)
 
+// FNV-1a over the values a save would write, see Player::IsSaveGroupChanged
+class SaveHash
+{
+    public:
+        SaveHash() : m_hash(14695981039346656037ULL) {}
+
+        template<typename T>
+        SaveHash& operator<<(T value)
+        {
+            static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "SaveHash takes plain values");
+            Add(&value, sizeof(value));
+            return *this;
+        }
+
+        SaveHash& operator<<(std::string const& value)
+        {
+            Add(value.data(), value.size());
+            // separates consecutive strings
+            return *this << uint32(value.size());
+        }
+
+        uint64 Get() const { return m_hash; }
+
+    private:
+        void Add(void const* data, size_t size)
+        {
+            uint8 const* bytes = static_cast<uint8 const*>(data);
+            for (size_t i = 0; i < size; ++i)
+                m_hash = (m_hash ^ bytes[i]) * 1099511628211ULL;
+        }
+
+        uint64 m_hash;
+};
+
 #ifdef BUILD_DEPRECATED_PLAYERBOT
 extern Config botConfig;
 #endif
@@ -513,6 +552,9 @@ Player::Player(WorldSession* session): Unit(), m_taxiTracker(*this), m_mover(thi
     // randomize first save time in range [CONFIG_UINT32_INTERVAL_SAVE] around [CONFIG_UINT32_INTERVAL_SAVE]
     // this must help in case next save after mass player load after server startup
     m_nextSave = urand(m_nextSave / 2, m_nextSave * 3 / 2);
+    std::fill(std::begin(m_saveGroupHashes), std::end(m_saveGroupHashes), 0);
+    std::fill(std::begin(m_pendingSaveGroupHashes), std::end(m_pendingSaveGroupHashes), 0);
+    m_characterSaved = false;
 
     clearResurrectRequestData();
 
@@ -3679,6 +3721,24 @@ void Player::_LoadSpellCooldowns(std::unique_ptr<QueryResult> queryResult)
 
 void Player::_SaveSpellCooldowns()
 {
+    // expire times are absolute, so the rows only change with new or expired cooldowns
+    SaveHash hash;
+    for (auto& cdItr : m_cooldownMap)
+    {
+        auto& cdData = cdItr.second;
+        if (cdData->IsPermanent())
+            continue;
+
+        TimePoint sTime = TimePoint::min();
+        TimePoint cTime = TimePoint::min();
+        cdData->GetSpellCDExpireTime(sTime);
+        cdData->GetCatCDExpireTime(cTime);
+        hash << cdData->GetSpellId() << uint64(Clock::to_time_t(sTime)) << cdData->GetCategory() << uint64(Clock::to_time_t(cTime)) << cdData->GetItemId();
+    }
+
+    if (!IsSaveGroupChanged(PLAYER_SAVE_GROUP_COOLDOWNS, hash.Get()))
+        return;
+
     static SqlStatementID deleteSpellCooldown;
 
     // delete all old cooldown
@@ -14032,6 +14092,7 @@ bool Player::LoadFromDB(ObjectGuid guid, SqlQueryHolder* holder)
     }
 
     m_name = fields[2].GetCppString();
+    m_characterSaved = true;
 
     // check name limitations
     if (ObjectMgr::CheckPlayerName(m_name) != CHAR_NAME_SUCCESS ||
@@ -15541,47 +15602,109 @@ void Player::SaveToDB()
     DEBUG_FILTER_LOG(LOG_FILTER_PLAYER_STATS, "The value of player %s at save: ", m_name.c_str());
     outDebugStatsValues();
 
+#ifdef BUILD_METRICS
+    metric::duration<std::chrono::microseconds> meas("player.save", {
+        { "logout", m_session->isLogingOut() ? "1" : "0" }
+    });
+#endif
+
+    UpdateSaveGroupHashes();
+
     CharacterDatabase.BeginTransaction();
 
     UpdateHonor();
 
-    static SqlStatementID delChar ;
-    static SqlStatementID insChar ;
+    std::ostringstream ss;
+    ss << m_taxi;                                           // string with TaxiMaskSize numbers
+    std::string taxiMask = ss.str();
 
-    SqlStatement stmt = CharacterDatabase.CreateStatement(delChar, "DELETE FROM characters WHERE guid = ?");
-    stmt.PExecute(GetGUIDLow());
+    std::string taxiPath = m_taxiTracker.Save();
 
-    SqlStatement uberInsert = CharacterDatabase.CreateStatement(insChar, "INSERT INTO characters (guid,account,name,race,class,gender,level,xp,money,playerBytes,playerBytes2,playerFlags,"
-                              "map, position_x, position_y, position_z, orientation, "
-                              "taximask, online, cinematic, "
-                              "totaltime, leveltime, rest_bonus, logout_time, is_logout_resting, resettalents_cost, resettalents_time, "
-                              "trans_x, trans_y, trans_z, trans_o, transguid, extra_flags, stable_slots, at_login, zone, "
-                              "death_expire_time, taxi_path, "
-                              "honor_highest_rank, honor_standing, stored_honor_rating , stored_dishonorable_kills, stored_honorable_kills, "
-                              "watchedFaction, drunk, health, power1, power2, power3, "
-                              "power4, power5, exploredZones, equipmentCache, ammoId, actionBars, fishingSteps) "
-                              "VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?,"
-                              "?, ?, ?, ?, ?, "
-                              "?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, ?, ?, ?, "
-                              "?, ?, "
-                              "?, ?, ?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, ?) ");
+    ss.str(std::string());
+    for (uint32 i = 0; i < PLAYER_EXPLORED_ZONES_SIZE; ++i)
+        ss << GetUInt32Value(PLAYER_EXPLORED_ZONES_1 + i) << " ";
+    std::string exploredZones = ss.str();
+
+    ss.str(std::string());
+    for (uint32 i = 0; i < EQUIPMENT_SLOT_END; ++i)         // string: item id, ench (perm/temp)
+    {
+        ss << GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET) << " ";
+
+        uint32 ench1 = GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET + 1 + PERM_ENCHANTMENT_SLOT);
+        uint32 ench2 = GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET + 1 + TEMP_ENCHANTMENT_SLOT);
+        ss << uint32(MAKE_PAIR32(ench1, ench2)) << " ";
+    }
+    // 1 in tbc - 4 in wotlk
+    for (uint32 i = INVENTORY_SLOT_BAG_START; i < INVENTORY_SLOT_BAG_START + 1; ++i) // string: item id, ench (perm/temp)
+    {
+        ss << (m_items[i] ? m_items[i]->GetEntry() : 0) << " ";
+        ss << uint32(MAKE_PAIR32(0, 0)) << " ";
+    }
+    std::string equipmentCache = ss.str();
+
+    // columns that rarely change are only written when one of them did
+    SaveHash coldHash;
+    coldHash << GetSession()->GetAccountId() << m_name << getRace() << getClass() << getGender()
+             << GetUInt32Value(PLAYER_BYTES) << GetUInt32Value(PLAYER_BYTES_2) << GetUInt32Value(PLAYER_FLAGS)
+             << taxiMask << m_cinematic << m_resetTalentsCost << uint64(m_resetTalentsTime) << m_ExtraFlags << m_stableSlots << m_atLoginFlags
+             << m_highest_rank.rank << m_standing_pos << m_stored_honor << m_stored_dishonorableKills << m_stored_honorableKills
+             << GetUInt32Value(PLAYER_FIELD_WATCHED_FACTION_INDEX) << GetUInt32Value(PLAYER_BYTES_3)
+             << exploredZones << equipmentCache << GetUInt32Value(PLAYER_AMMO_ID) << GetByteValue(PLAYER_FIELD_BYTES, 2) << m_fishingSteps;
+    bool saveCold = IsSaveGroupChanged(PLAYER_SAVE_GROUP_CHARACTER, coldHash.Get()) || !m_characterSaved;
+
+    static SqlStatementID delChar ;
+    static SqlStatementID insChar ;
+    static SqlStatementID updChar ;
+    static SqlStatementID updCharHot ;
+
+    SqlStatement uberInsert = CharacterDatabase.CreateStatement(updCharHot, "UPDATE characters SET level = ?, xp = ?, money = ?, "
+                              "map = ?, position_x = ?, position_y = ?, position_z = ?, orientation = ?, "
+                              "online = ?, totaltime = ?, leveltime = ?, rest_bonus = ?, logout_time = ?, is_logout_resting = ?, "
+                              "trans_x = ?, trans_y = ?, trans_z = ?, trans_o = ?, transguid = ?, zone = ?, death_expire_time = ?, taxi_path = ?, "
+                              "health = ?, power1 = ?, power2 = ?, power3 = ?, power4 = ?, power5 = ? "
+                              "WHERE guid = ?");
+    if (!m_characterSaved)
+    {
+        // characters created by this session have no row yet
+        SqlStatement stmt = CharacterDatabase.CreateStatement(delChar, "DELETE FROM characters WHERE guid = ?");
+        stmt.PExecute(GetGUIDLow());
+
+        uberInsert = CharacterDatabase.CreateStatement(insChar, "INSERT INTO characters (level, xp, money, "
+                     "map, position_x, position_y, position_z, orientation, "
+                     "online, totaltime, leveltime, rest_bonus, logout_time, is_logout_resting, "
+                     "trans_x, trans_y, trans_z, trans_o, transguid, zone, death_expire_time, taxi_path, "
+                     "health, power1, power2, power3, power4, power5, "
+                     "account, name, race, class, gender, playerBytes, playerBytes2, playerFlags, "
+                     "taximask, cinematic, resettalents_cost, resettalents_time, extra_flags, stable_slots, at_login, "
+                     "honor_highest_rank, honor_standing, stored_honor_rating, stored_dishonorable_kills, stored_honorable_kills, "
+                     "watchedFaction, drunk, exploredZones, equipmentCache, ammoId, actionBars, fishingSteps, guid) "
+                     "VALUES (?, ?, ?, "
+                     "?, ?, ?, ?, ?, "
+                     "?, ?, ?, ?, ?, ?, "
+                     "?, ?, ?, ?, ?, ?, ?, ?, "
+                     "?, ?, ?, ?, ?, ?, "
+                     "?, ?, ?, ?, ?, ?, ?, ?, "
+                     "?, ?, ?, ?, ?, ?, ?, "
+                     "?, ?, ?, ?, ?, "
+                     "?, ?, ?, ?, ?, ?, ?, ?)");
+    }
+    else if (saveCold)
+    {
+        uberInsert = CharacterDatabase.CreateStatement(updChar, "UPDATE characters SET level = ?, xp = ?, money = ?, "
+                     "map = ?, position_x = ?, position_y = ?, position_z = ?, orientation = ?, "
+                     "online = ?, totaltime = ?, leveltime = ?, rest_bonus = ?, logout_time = ?, is_logout_resting = ?, "
+                     "trans_x = ?, trans_y = ?, trans_z = ?, trans_o = ?, transguid = ?, zone = ?, death_expire_time = ?, taxi_path = ?, "
+                     "health = ?, power1 = ?, power2 = ?, power3 = ?, power4 = ?, power5 = ?, "
+                     "account = ?, name = ?, race = ?, class = ?, gender = ?, playerBytes = ?, playerBytes2 = ?, playerFlags = ?, "
+                     "taximask = ?, cinematic = ?, resettalents_cost = ?, resettalents_time = ?, extra_flags = ?, stable_slots = ?, at_login = ?, "
+                     "honor_highest_rank = ?, honor_standing = ?, stored_honor_rating = ?, stored_dishonorable_kills = ?, stored_honorable_kills = ?, "
+                     "watchedFaction = ?, drunk = ?, exploredZones = ?, equipmentCache = ?, ammoId = ?, actionBars = ?, fishingSteps = ? "
+                     "WHERE guid = ?");
+    }
 
-    uberInsert.addUInt32(GetGUIDLow());
-    uberInsert.addUInt32(GetSession()->GetAccountId());
-    uberInsert.addString(m_name);
-    uberInsert.addUInt8(getRace());
-    uberInsert.addUInt8(getClass());
-    uberInsert.addUInt8(getGender());
     uberInsert.addUInt32(GetLevel());
     uberInsert.addUInt32(GetUInt32Value(PLAYER_XP));
     uberInsert.addUInt32(GetMoney());
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_BYTES));
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_BYTES_2));
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_FLAGS));
 
     if (!IsBeingTeleported())
     {
@@ -15600,14 +15723,8 @@ void Player::SaveToDB()
         uberInsert.addFloat(finiteAlways(GetTeleportDest().orientation));
     }
 
-    std::ostringstream ss;
-    ss << m_taxi;                                   // string with TaxiMaskSize numbers
-    uberInsert.addString(ss);
-
     uberInsert.addUInt32(IsInWorld() ? 1 : 0);
 
-    uberInsert.addUInt32(m_cinematic);
-
     uberInsert.addUInt32(m_Played_time[PLAYED_TIME_TOTAL]);
     uberInsert.addUInt32(m_Played_time[PLAYED_TIME_LEVEL]);
 
@@ -15616,8 +15733,6 @@ void Player::SaveToDB()
     uberInsert.addUInt32(HasFlag(PLAYER_FLAGS, PLAYER_FLAGS_RESTING) ? 1 : 0);
     // save, far from tavern/city
     // save, but in tavern/city
-    uberInsert.addUInt32(m_resetTalentsCost);
-    uberInsert.addUInt64(uint64(m_resetTalentsTime));
 
     Position const& transportPosition = m_movementInfo.GetTransportPos();
     uberInsert.addFloat(finiteAlways(transportPosition.x));
@@ -15630,62 +15745,64 @@ void Player::SaveToDB()
     else
         uberInsert.addUInt32(0);
 
-    uberInsert.addUInt32(m_ExtraFlags);
-
-    uberInsert.addUInt32(uint32(m_stableSlots));            // to prevent save uint8 as char
-
-    uberInsert.addUInt32(uint32(m_atLoginFlags));
-
     uberInsert.addUInt32(IsInWorld() ? GetZoneId() : GetCachedZoneId());
 
     uberInsert.addUInt64(uint64(m_deathExpireTime));
 
-    ss << m_taxiTracker.Save();
-    uberInsert.addString(ss);
-
-    uberInsert.addUInt32(uint32(m_highest_rank.rank));
-    uberInsert.addInt32(m_standing_pos);
-    uberInsert.addFloat(finiteAlways(m_stored_honor));
-    uberInsert.addUInt32(m_stored_dishonorableKills);
-    uberInsert.addUInt32(m_stored_honorableKills);
-
-    // FIXME: at this moment send to DB as unsigned, including unit32(-1)
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_FIELD_WATCHED_FACTION_INDEX));
-
-    uberInsert.addUInt16(uint16(GetUInt32Value(PLAYER_BYTES_3) & 0xFFFE));
+    uberInsert.addString(taxiPath);
 
     uberInsert.addUInt32(GetHealth());
 
     for (uint32 i = 0; i < MAX_POWERS; ++i)
         uberInsert.addUInt32(GetPower(Powers(i)));
 
-    for (uint32 i = 0; i < PLAYER_EXPLORED_ZONES_SIZE; ++i) // string
+    if (saveCold)
     {
-        ss << GetUInt32Value(PLAYER_EXPLORED_ZONES_1 + i) << " ";
-    }
-    uberInsert.addString(ss);
+        uberInsert.addUInt32(GetSession()->GetAccountId());
+        uberInsert.addString(m_name);
+        uberInsert.addUInt8(getRace());
+        uberInsert.addUInt8(getClass());
+        uberInsert.addUInt8(getGender());
+        uberInsert.addUInt32(GetUInt32Value(PLAYER_BYTES));
+        uberInsert.addUInt32(GetUInt32Value(PLAYER_BYTES_2));
+        uberInsert.addUInt32(GetUInt32Value(PLAYER_FLAGS));
 
-    for (uint32 i = 0; i < EQUIPMENT_SLOT_END; ++i)         // string: item id, ench (perm/temp)
-    {
-        ss << GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET) << " ";
+        uberInsert.addString(taxiMask);
 
-        uint32 ench1 = GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET + 1 + PERM_ENCHANTMENT_SLOT);
-        uint32 ench2 = GetUInt32Value(PLAYER_VISIBLE_ITEM_1_0 + i * MAX_VISIBLE_ITEM_OFFSET + 1 + TEMP_ENCHANTMENT_SLOT);
-        ss << uint32(MAKE_PAIR32(ench1, ench2)) << " ";
-    }
-    // 1 in tbc - 4 in wotlk
-    for (uint32 i = INVENTORY_SLOT_BAG_START; i < INVENTORY_SLOT_BAG_START + 1; ++i) // string: item id, ench (perm/temp)
-    {
-        ss << (m_items[i] ? m_items[i]->GetEntry() : 0) << " ";
-        ss << uint32(MAKE_PAIR32(0, 0)) << " ";
-    }
-    uberInsert.addString(ss);
+        uberInsert.addUInt32(m_cinematic);
+
+        uberInsert.addUInt32(m_resetTalentsCost);
+        uberInsert.addUInt64(uint64(m_resetTalentsTime));
+
+        uberInsert.addUInt32(m_ExtraFlags);
+
+        uberInsert.addUInt32(uint32(m_stableSlots));        // to prevent save uint8 as char
+
+        uberInsert.addUInt32(uint32(m_atLoginFlags));
+
+        uberInsert.addUInt32(uint32(m_highest_rank.rank));
+        uberInsert.addInt32(m_standing_pos);
+        uberInsert.addFloat(finiteAlways(m_stored_honor));
+        uberInsert.addUInt32(m_stored_dishonorableKills);
+        uberInsert.addUInt32(m_stored_honorableKills);
+
+        // FIXME: at this moment send to DB as unsigned, including unit32(-1)
+        uberInsert.addUInt32(GetUInt32Value(PLAYER_FIELD_WATCHED_FACTION_INDEX));
+
+        uberInsert.addUInt16(uint16(GetUInt32Value(PLAYER_BYTES_3) & 0xFFFE));
+
+        uberInsert.addString(exploredZones);
 
-    uberInsert.addUInt32(GetUInt32Value(PLAYER_AMMO_ID));
+        uberInsert.addString(equipmentCache);
 
-    uberInsert.addUInt32(uint32(GetByteValue(PLAYER_FIELD_BYTES, 2)));
+        uberInsert.addUInt32(GetUInt32Value(PLAYER_AMMO_ID));
 
-    uberInsert.addUInt8(m_fishingSteps);
+        uberInsert.addUInt32(uint32(GetByteValue(PLAYER_FIELD_BYTES, 2)));
+
+        uberInsert.addUInt8(m_fishingSteps);
+    }
+
+    uberInsert.addUInt32(GetGUIDLow());
 
     uberInsert.Execute();
 
@@ -15706,7 +15823,12 @@ void Player::SaveToDB()
     _SaveHonorCP();
     GetSession()->SaveTutorialsData();                      // changed only while character in game
 
-    CharacterDatabase.CommitTransaction();
+#ifdef BUILD_METRICS
+    meas.add_field("queued_statements", std::to_string(CharacterDatabase.GetTransactionSize()));
+#endif
+
+    m_saveResult = std::make_shared<SqlTransactionResult>();
+    CharacterDatabase.CommitTransaction(m_saveResult);
 
     // check if stats should only be saved on logout
     // save stats can be out of transaction
@@ -15785,71 +15907,125 @@ void Player::_SaveActions()
 
 void Player::_SaveAuras()
 {
+    struct AuraRow
+    {
+        SpellAuraHolder const* holder;
+        int32  damage[MAX_EFFECT_INDEX];
+        uint32 periodicTime[MAX_EFFECT_INDEX];
+        uint32 effIndexMask;
+    };
+
+    std::vector<AuraRow> rows;
+    SaveHash hash;
+    for (const auto& auraHolder : GetSpellAuraHolderMap())
+    {
+        SpellAuraHolder* holder = auraHolder.second;
+        // skip all holders from spells that are passive or channeled
+        // save singleTarget auras if self cast.
+        if (!holder->IsSaveToDbHolder())
+            continue;
+
+        AuraRow row;
+        row.holder = holder;
+        row.effIndexMask = 0;
+
+        for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+        {
+            row.damage[i] = 0;
+            row.periodicTime[i] = 0;
+
+            if (Aura* aur = holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
+            {
+                // don't save not own area auras
+                if (!aur->IsSaveToDbAura())
+                    continue;
+
+                row.damage[i] = aur->GetModifier()->m_amount;
+                row.periodicTime[i] = aur->GetModifier()->periodictime;
+                row.effIndexMask |= (1 << i);
+            }
+        }
+
+        if (!row.effIndexMask)
+            continue;
+
+        hash << holder->GetCasterGuid().GetRawValue() << holder->GetCastItemGuid().GetCounter() << holder->GetId() << holder->GetStackAmount()
+             << holder->GetAuraCharges() << holder->GetAuraMaxDuration() << holder->GetAuraDuration() << row.effIndexMask;
+        for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
+            hash << row.damage[i] << row.periodicTime[i];
+
+        rows.push_back(row);
+    }
+
+    // unchanged since last save, auras without duration usually are
+    if (!IsSaveGroupChanged(PLAYER_SAVE_GROUP_AURAS, hash.Get()))
+        return;
+
     static SqlStatementID deleteAuras ;
     static SqlStatementID insertAuras ;
 
     SqlStatement stmt = CharacterDatabase.CreateStatement(deleteAuras, "DELETE FROM character_aura WHERE guid = ?");
     stmt.PExecute(GetGUIDLow());
 
-    SpellAuraHolderMap const& auraHolders = GetSpellAuraHolderMap();
-
-    if (auraHolders.empty())
+    if (rows.empty())
         return;
 
     stmt = CharacterDatabase.CreateStatement(insertAuras, "INSERT INTO character_aura (guid, caster_guid, item_guid, spell, stackcount, remaincharges, "
             "basepoints0, basepoints1, basepoints2, periodictime0, periodictime1, periodictime2, maxduration, remaintime, effIndexMask) "
             "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
 
-    for (const auto& auraHolder : auraHolders)
+    for (AuraRow const& row : rows)
     {
-        SpellAuraHolder* holder = auraHolder.second;
-        // skip all holders from spells that are passive or channeled
-        // save singleTarget auras if self cast.
-        if (holder->IsSaveToDbHolder())
-        {
-            int32  damage[MAX_EFFECT_INDEX];
-            uint32 periodicTime[MAX_EFFECT_INDEX];
-            uint32 effIndexMask = 0;
-
-            for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
-            {
-                damage[i] = 0;
-                periodicTime[i] = 0;
-
-                if (Aura* aur = holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
-                {
-                    // don't save not own area auras
-                    if (!aur->IsSaveToDbAura())
-                        continue;
+        SpellAuraHolder const* holder = row.holder;
+        stmt.addUInt32(GetGUIDLow());
+        stmt.addUInt64(holder->GetCasterGuid().GetRawValue());
+        stmt.addUInt32(holder->GetCastItemGuid().GetCounter());
+        stmt.addUInt32(holder->GetId());
+        stmt.addUInt32(holder->GetStackAmount());
+        stmt.addUInt8(holder->GetAuraCharges());
 
-                    damage[i] = aur->GetModifier()->m_amount;
-                    periodicTime[i] = aur->GetModifier()->periodictime;
-                    effIndexMask |= (1 << i);
-                }
-            }
+        for (int i : row.damage)
+            stmt.addInt32(i);
 
-            if (!effIndexMask)
-                continue;
+        for (unsigned int i : row.periodicTime)
+            stmt.addUInt32(i);
 
-            stmt.addUInt32(GetGUIDLow());
-            stmt.addUInt64(holder->GetCasterGuid().GetRawValue());
-            stmt.addUInt32(holder->GetCastItemGuid().GetCounter());
-            stmt.addUInt32(holder->GetId());
-            stmt.addUInt32(holder->GetStackAmount());
-            stmt.addUInt8(holder->GetAuraCharges());
+        stmt.addInt32(holder->GetAuraMaxDuration());
+        stmt.addInt32(holder->GetAuraDuration());
+        stmt.addUInt32(row.effIndexMask);
+        stmt.Execute();
+    }
+}
 
-            for (int i : damage)
-                stmt.addInt32(i);
+bool Player::IsSaveGroupChanged(PlayerSaveGroup group, uint64 hash)
+{
+    // a previous save still queued may write other values, it then also has to have the same
+    bool changed = m_saveGroupHashes[group] != hash || (m_saveResult && m_pendingSaveGroupHashes[group] != hash);
+    m_pendingSaveGroupHashes[group] = hash;
+    return changed;
+}
 
-            for (unsigned int i : periodicTime)
-                stmt.addUInt32(i);
+void Player::UpdateSaveGroupHashes()
+{
+    if (!m_saveResult)
+        return;
 
-            stmt.addInt32(holder->GetAuraMaxDuration());
-            stmt.addInt32(holder->GetAuraDuration());
-            stmt.addUInt32(effIndexMask);
-            stmt.Execute();
-        }
+    switch (m_saveResult->GetState())
+    {
+        case SqlTransactionResult::PENDING:
+            return;
+        case SqlTransactionResult::COMMITTED:
+            std::copy(std::begin(m_pendingSaveGroupHashes), std::end(m_pendingSaveGroupHashes), std::begin(m_saveGroupHashes));
+            m_characterSaved = true;
+            break;
+        case SqlTransactionResult::FAILED:
+            // an earlier save that was still queued may have been stored, so nothing is known to be in the database
+            std::fill(std::begin(m_saveGroupHashes), std::end(m_saveGroupHashes), 0);
+            sLog.outError("Player::SaveToDB: saving %s failed, its next save writes all data", GetGuidStr().c_str());
+            break;
     }
+
+    m_saveResult.reset();
 }
 
 void Player::_SaveInventory()
@@ -20383,6 +20559,13 @@ void Player::_LoadCreatedInstanceTimers()
 
 void Player::_SaveNewInstanceIdTimer()
 {
+    SaveHash hash;
+    for (auto enterInstItr : m_enteredInstances)
+        hash << enterInstItr.first << uint64(Clock::to_time_t(enterInstItr.second));
+
+    if (!IsSaveGroupChanged(PLAYER_SAVE_GROUP_INSTANCE_TIMERS, hash.Get()))
+        return;
+
     CharacterDatabase.PExecute("DELETE FROM account_instances_entered WHERE AccountId = '%u'", m_session->GetAccountId());
 
     if (m_enteredInstances.empty())
@@ -721,6 +721,16 @@ enum PlayerDelayedOperations
     DELAYED_END
 };
 
+// data saved only when it differs from the last save, see Player::IsSaveGroupChanged
+enum PlayerSaveGroup
+{
+    PLAYER_SAVE_GROUP_CHARACTER     = 0,                    // characters columns that rarely change
+    PLAYER_SAVE_GROUP_AURAS         = 1,
+    PLAYER_SAVE_GROUP_COOLDOWNS     = 2,
+    PLAYER_SAVE_GROUP_INSTANCE_TIMERS = 3,
+    MAX_PLAYER_SAVE_GROUPS
+};
+
 enum ReputationSource
 {
     REPUTATION_SOURCE_KILL,
@@ -2310,6 +2320,10 @@ class Player : public Unit
         void _SaveSpells();
         void _SaveBGData();
         void _SaveStats();
+        // remembers the hash of the group's data for this save, true if it differs from the stored data
+        bool IsSaveGroupChanged(PlayerSaveGroup group, uint64 hash);
+        // takes over the hashes of the last save once its transaction was committed
+        void UpdateSaveGroupHashes();
 
         /*********************************************************/
         /***              ENVIRONMENTAL SYSTEM                 ***/
@@ -2352,6 +2366,10 @@ class Player : public Unit
 
         Team m_team;
         uint32 m_nextSave;
+        uint64 m_saveGroupHashes[MAX_PLAYER_SAVE_GROUPS];    // of the data in the database
+        uint64 m_pendingSaveGroupHashes[MAX_PLAYER_SAVE_GROUPS]; // of the last save, until its transaction is executed
+        SqlTransactionResultPtr m_saveResult;
+        bool m_characterSaved;                              // characters row exists, later saves update it
         time_t m_speakTime;
         uint32 m_speakCount;
         uint32 m_atLoginFlags;
@@ -10979,8 +10979,14 @@ void Unit::OnRelocated()
         m_last_notified_position.y = GetPositionY();
         m_last_notified_position.z = GetPositionZ();
 
-        GetViewPoint().Call_UpdateVisibilityForOwner();
-        UpdateObjectVisibility();
+        // in world units are updated together with everything else moved this tick by the map
+        if (IsInWorld() && sWorld.getConfig(CONFIG_BOOL_VISIBILITY_BATCH_RELOCATION))
+            GetMap()->AddRelocatedUnit(this);
+        else
+        {
+            GetViewPoint().Call_UpdateVisibilityForOwner();
+            UpdateObjectVisibility();
+        }
     }
     ScheduleAINotify(World::GetRelocationAINotifyDelay());
 }
@@ -11803,8 +11809,8 @@ void Unit::InterruptSpellsCastedOnMe(bool killDelayed)
         if (!killDelayed)
             continue;
         // 2/ Interrupt spells that are not referenced but that still have an event (like delayed spellInfo)
-        for (auto i_events = target->m_events.GetEvents().begin(); i_events != target->m_events.GetEvents().end(); ++i_events)
-            if (SpellEvent* event = dynamic_cast<SpellEvent*>(i_events->second))
+        for (BasicEvent* i_event : target->m_events.GetEvents())
+            if (SpellEvent* event = dynamic_cast<SpellEvent*>(i_event))
                 if (event && event->GetSpell()->m_targets.getUnitTargetGuid() == GetObjectGuid())
                     if (event->GetSpell()->getState() != SPELL_STATE_FINISHED)
                         event->GetSpell()->cancel();
@@ -17,6 +17,9 @@
  */
 
 #include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 
 #include "Common.h"
 #include "Entities/UpdateData.h"
@@ -60,29 +63,79 @@ void UpdateData::AddUpdateBlock(const ByteBuffer& block)
     }
 }
 
-void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
+namespace
 {
-    z_stream c_stream;
+    // deflate state kept per thread and reset between packets instead of paying deflateInit/deflateEnd for each one
+    struct UpdateDeflateStream
+    {
+        z_stream stream;
+        int level = -1;
+
+        ~UpdateDeflateStream()
+        {
+            if (level >= 0)
+                deflateEnd(&stream);
+        }
+
+        bool Prepare(int newLevel)
+        {
+            if (level == newLevel)
+            {
+                int z_res = deflateReset(&stream);
+                if (z_res == Z_OK)
+                    return true;
+
+                sLog.outError("Can't compress update packet (zlib: deflateReset) Error code: %i (%s)", z_res, zError(z_res));
+            }
+
+            // first use on this thread, level changed by config reload or reset failed
+            if (level >= 0)
+            {
+                deflateEnd(&stream);
+                level = -1;
+            }
+
+            stream.zalloc = (alloc_func)nullptr;
+            stream.zfree = (free_func)nullptr;
+            stream.opaque = (voidpf)nullptr;
+
+            int z_res = deflateInit(&stream, newLevel);
+            if (z_res != Z_OK)
+            {
+                sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+                return false;
+            }
 
-    c_stream.zalloc = (alloc_func)nullptr;
-    c_stream.zfree = (free_func)nullptr;
-    c_stream.opaque = (voidpf)nullptr;
+            level = newLevel;
+            return true;
+        }
+    };
 
+    thread_local UpdateDeflateStream t_deflateStream;
+
+    std::atomic<uint64> s_compressedPackets(0);
+    std::atomic<uint64> s_compressedBytesIn(0);
+    std::atomic<uint64> s_compressedBytesOut(0);
+    std::atomic<uint64> s_compressionTimeUs(0);
+}
+
+void UpdateData::Compress(void* dst, uint32* dst_size, ByteBuffer const& header, ByteBuffer const& body)
+{
     // default Z_BEST_SPEED (1)
-    int z_res = deflateInit(&c_stream, sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
-    if (z_res != Z_OK)
+    if (!t_deflateStream.Prepare(sWorld.getConfig(CONFIG_UINT32_COMPRESSION)))
     {
-        sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
         *dst_size = 0;
         return;
     }
 
+    z_stream& c_stream = t_deflateStream.stream;
+
     c_stream.next_out = (Bytef*)dst;
     c_stream.avail_out = *dst_size;
-    c_stream.next_in = (Bytef*)src;
-    c_stream.avail_in = (uInt)src_size;
+    c_stream.next_in = (Bytef*)header.contents();
+    c_stream.avail_in = (uInt)header.wpos();
 
-    z_res = deflate(&c_stream, Z_NO_FLUSH);
+    int z_res = deflate(&c_stream, Z_NO_FLUSH);
     if (z_res != Z_OK)
     {
         sLog.outError("Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
@@ -97,6 +150,10 @@ void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
         return;
     }
 
+    // block data is fed straight from the update buffer, no intermediate copy
+    c_stream.next_in = body.wpos() ? (Bytef*)body.contents() : nullptr;
+    c_stream.avail_in = (uInt)body.wpos();
+
     z_res = deflate(&c_stream, Z_FINISH);
     if (z_res != Z_STREAM_END)
     {
@@ -105,14 +162,6 @@ void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
         return;
     }
 
-    z_res = deflateEnd(&c_stream);
-    if (z_res != Z_OK)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflateEnd) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
-
     *dst_size = c_stream.total_out;
 }
 
@@ -121,49 +170,71 @@ WorldPacket UpdateData::BuildPacket(size_t index, bool hasTransport)
     WorldPacket packet;
     MANGOS_ASSERT(packet.empty());                         // shouldn't happen
 
-    ByteBuffer buf(4 + 1 + (m_outOfRangeGUIDs.empty() ? 0 : 1 + 4 + 9 * m_outOfRangeGUIDs.size()) + m_data[index].m_buffer.wpos());
+    ByteBuffer header(4 + 1 + (m_outOfRangeGUIDs.empty() ? 0 : 1 + 4 + 9 * m_outOfRangeGUIDs.size()));
 
-    buf << (uint32)(!m_outOfRangeGUIDs.empty() ? m_data[index].m_blockCount + 1 : m_data[index].m_blockCount);
-    buf << (uint8)(hasTransport ? 1 : 0);
+    header << (uint32)(!m_outOfRangeGUIDs.empty() ? m_data[index].m_blockCount + 1 : m_data[index].m_blockCount);
+    header << (uint8)(hasTransport ? 1 : 0);
 
     if (!m_outOfRangeGUIDs.empty())
     {
-        buf << (uint8) UPDATETYPE_OUT_OF_RANGE_OBJECTS;
-        buf << (uint32) m_outOfRangeGUIDs.size();
+        header << (uint8) UPDATETYPE_OUT_OF_RANGE_OBJECTS;
+        header << (uint32) m_outOfRangeGUIDs.size();
 
         for (auto m_outOfRangeGUID : m_outOfRangeGUIDs)
-            buf << m_outOfRangeGUID.WriteAsPacked();
+            header << m_outOfRangeGUID.WriteAsPacked();
     }
 
-    buf.append(m_data[index].m_buffer);
+    ByteBuffer const& body = m_data[index].m_buffer;
 
-    size_t pSize = buf.wpos();                              // use real used data size
+    size_t pSize = header.wpos() + body.wpos();             // use real used data size
 
-    if (pSize > 100)                                        // compress large packets
+    if (pSize > sWorld.getConfig(CONFIG_UINT32_COMPRESSION_THRESHOLD)) // compress large packets
     {
         uint32 destsize = compressBound(pSize);
         packet.resize(destsize + sizeof(uint32));
 
         packet.put<uint32>(0, pSize);
-        Compress(const_cast<uint8*>(packet.contents()) + sizeof(uint32), &destsize, (void*)buf.contents(), pSize);
+
+        auto startTime = std::chrono::steady_clock::now();
+        Compress(const_cast<uint8*>(packet.contents()) + sizeof(uint32), &destsize, header, body);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
         if (destsize == 0)
             return packet;
 
+        ++s_compressedPackets;
+        s_compressedBytesIn += pSize;
+        s_compressedBytesOut += destsize;
+        s_compressionTimeUs += elapsed;
+
         packet.resize(destsize + sizeof(uint32));
         packet.SetOpcode(SMSG_COMPRESSED_UPDATE_OBJECT);
     }
     else                                                    // send small packets without compression
     {
-        packet.append(buf);
+        packet.reserve(pSize);
+        packet.append(header);
+        packet.append(body);
         packet.SetOpcode(SMSG_UPDATE_OBJECT);
     }
 
     return packet;
 }
 
+UpdateCompressionStats UpdateData::GetCompressionStats(bool reset)
+{
+    if (reset)
+        return { s_compressedPackets.exchange(0), s_compressedBytesIn.exchange(0), s_compressedBytesOut.exchange(0), s_compressionTimeUs.exchange(0) };
+
+    return { s_compressedPackets.load(), s_compressedBytesIn.load(), s_compressedBytesOut.load(), s_compressionTimeUs.load() };
+}
+
 void UpdateData::Clear()
 {
-    m_data.clear();
+    // keep the first buffer and its capacity so the object can be filled again
+    m_data.resize(1);
+    m_data[0].m_buffer.clear();
+    m_data[0].m_blockCount = 0;
+    m_currentIndex = 0;
     m_outOfRangeGUIDs.clear();
 }
 
@@ -175,3 +246,62 @@ void UpdateData::SendData(WorldSession& session)
         session.SendPacket(packet);
     }
 }
+
+UpdateData& PlayerUpdateDataMap::Get(Player* player)
+{
+    // keep the index at most half full
+    if ((m_size + 1) * 2 > m_index.size())
+        Rehash(std::max<size_t>(64, m_index.size() * 2));
+
+    size_t const mask = m_index.size() - 1;
+    for (size_t i = Hash(player) & mask;; i = (i + 1) & mask)
+    {
+        uint32 const slot = m_index[i];
+        if (!slot)
+        {
+            if (m_size == m_entries.size())
+                m_entries.emplace_back();
+
+            Entry& entry = m_entries[m_size++];
+            entry.player = player;
+            m_index[i] = uint32(m_size);
+            return entry.data;
+        }
+
+        if (m_entries[slot - 1].player == player)
+            return m_entries[slot - 1].data;
+    }
+}
+
+void PlayerUpdateDataMap::Clear()
+{
+    if (!m_size)
+        return;
+
+    for (size_t i = 0; i < m_size; ++i)
+        m_entries[i].data.Clear();
+
+    m_size = 0;
+    std::fill(m_index.begin(), m_index.end(), 0);
+}
+
+void PlayerUpdateDataMap::Rehash(size_t indexSize)
+{
+    m_index.assign(indexSize, 0);
+
+    size_t const mask = indexSize - 1;
+    for (size_t pos = 0; pos < m_size; ++pos)
+    {
+        size_t i = Hash(m_entries[pos].player) & mask;
+        while (m_index[i])
+            i = (i + 1) & mask;
+
+        m_index[i] = uint32(pos + 1);
+    }
+}
+
+size_t PlayerUpdateDataMap::Hash(Player const* player)
+{
+    uint64 h = uint64(reinterpret_cast<uintptr_t>(player)) * 0x9E3779B97F4A7C15ULL;
+    return size_t(h ^ (h >> 32));
+}
@@ -24,6 +24,7 @@
 
 class WorldPacket;
 class WorldSession;
+class Player;
 
 enum ObjectUpdateType
 {
@@ -48,6 +49,14 @@ enum ObjectUpdateFlags
     UPDATEFLAG_HAS_POSITION = 0x0040
 };
 
+struct UpdateCompressionStats
+{
+    uint64 packets;                                         // compressed packets built
+    uint64 bytesIn;                                         // payload size before compression
+    uint64 bytesOut;                                        // payload size after compression
+    uint64 timeUs;                                          // time spent in deflate
+};
+
 struct BufferPair
 {
     ByteBuffer m_buffer;
@@ -71,11 +80,44 @@ class UpdateData
 
         void SendData(WorldSession& session);
 
+        // totals since the last reset, collected from all threads building update packets
+        static UpdateCompressionStats GetCompressionStats(bool reset = false);
+
     protected:
         GuidSet m_outOfRangeGUIDs;
         std::vector<BufferPair> m_data;
         uint32 m_currentIndex;
 
-        static void Compress(void* dst, uint32* dst_size, void* src, int src_size);
+        static void Compress(void* dst, uint32* dst_size, ByteBuffer const& header, ByteBuffer const& body);
+};
+
+// Update data per receiving player, indexed by an open addressing table.
+// Cleared entries keep their buffers so a container reused every tick stops allocating once warmed up.
+class PlayerUpdateDataMap
+{
+    public:
+        struct Entry
+        {
+            Player* player;
+            UpdateData data;
+        };
+
+        typedef std::vector<Entry>::iterator iterator;
+
+        UpdateData& Get(Player* player);                    // finds or adds the entry for player
+        void Clear();
+
+        iterator begin() { return m_entries.begin(); }
+        iterator end() { return m_entries.begin() + m_size; }
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+    private:
+        void Rehash(size_t indexSize);
+        static size_t Hash(Player const* player);
+
+        std::vector<Entry> m_entries;                       // only the first m_size entries are in use
+        std::vector<uint32> m_index;                        // entry position + 1, 0 for free slots
+        size_t m_size = 0;
 };
 #endif
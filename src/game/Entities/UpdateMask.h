@@ -20,32 +20,64 @@
 #define __UPDATEMASK_H
 
 #include "Util/Errors.h"
+#include "Entities/UpdateFields.h"
+
+#include <bit>
+#include <cstring>
 
 class UpdateMask
 {
     public:
-        UpdateMask() : mHasData(false), mCount(0), mBlocks(0), mUpdateMask(nullptr) { }
-        UpdateMask(const UpdateMask& mask) : mUpdateMask(nullptr) { *this = mask; }
+        // players have the largest values array of all type ids, every mask fits inline
+        static uint32 const MAX_COUNT = PLAYER_END;
+        static uint32 const MAX_BLOCKS = (MAX_COUNT + 31) / 32;
 
-        ~UpdateMask()
-        {
-            delete[] mUpdateMask;
-        }
+        UpdateMask() : mHasData(false), mCount(0), mBlocks(0) { }
+        UpdateMask(const UpdateMask& mask) { *this = mask; }
 
         void SetBit(uint32 index)
         {
-            ((uint8*)mUpdateMask)[ index >> 3 ] |= 1 << (index & 0x7);
+            mUpdateMask[index >> 5] |= 1u << (index & 0x1F);
             mHasData = true;
         }
 
         void UnsetBit(uint32 index)
         {
-            ((uint8*)mUpdateMask)[ index >> 3 ] &= (0xff ^ (1 << (index & 0x7)));
+            mUpdateMask[index >> 5] &= ~(1u << (index & 0x1F));
         }
 
         bool GetBit(uint32 index) const
         {
-            return (((uint8*)mUpdateMask)[ index >> 3 ] & (1 << (index & 0x7))) != 0;
+            return (mUpdateMask[index >> 5] & (1u << (index & 0x1F))) != 0;
+        }
+
+        // index of the first set bit at or after index, GetCount() if there is none
+        uint32 GetNextSetBit(uint32 index) const
+        {
+            uint32 block = index >> 5;
+            if (block >= mBlocks)
+                return mCount;
+
+            uint32 bits = mUpdateMask[block] & (~0u << (index & 0x1F));
+            while (!bits)
+            {
+                if (++block >= mBlocks)
+                    return mCount;
+
+                bits = mUpdateMask[block];
+            }
+
+            return (block << 5) + std::countr_zero(bits);
+        }
+
+        uint32 GetFirstSetBit() const { return GetNextSetBit(0); }
+
+        uint32 GetSetBitCount() const
+        {
+            uint32 count = 0;
+            for (uint32 i = 0; i < mBlocks; ++i)
+                count += std::popcount(mUpdateMask[i]);
+            return count;
         }
 
         uint32 GetBlockCount() const { return mBlocks; }
@@ -56,25 +88,26 @@ class UpdateMask
 
         void SetCount(uint32 valuesCount)
         {
-            delete[] mUpdateMask;
+            MANGOS_ASSERT(valuesCount <= MAX_COUNT);
 
             mCount = valuesCount;
             mBlocks = (valuesCount + 31) / 32;
 
-            mUpdateMask = new uint32[mBlocks];
             memset(mUpdateMask, 0, mBlocks << 2);
+            mHasData = false;
         }
 
         void Clear()
         {
-            if (mUpdateMask)
-                memset(mUpdateMask, 0, mBlocks << 2);
+            memset(mUpdateMask, 0, mBlocks << 2);
             mHasData = false;
         }
 
         UpdateMask& operator = (const UpdateMask& mask)
         {
-            SetCount(mask.mCount);
+            mHasData = mask.mHasData;
+            mCount = mask.mCount;
+            mBlocks = mask.mBlocks;
             memcpy(mUpdateMask, mask.mUpdateMask, mBlocks << 2);
 
             return *this;
@@ -83,15 +116,18 @@ class UpdateMask
         void operator &= (const UpdateMask& mask)
         {
             MANGOS_ASSERT(mask.mCount <= mCount);
-            for (uint32 i = 0; i < mBlocks; ++i)
+            for (uint32 i = 0; i < mask.mBlocks; ++i)
                 mUpdateMask[i] &= mask.mUpdateMask[i];
+            for (uint32 i = mask.mBlocks; i < mBlocks; ++i)
+                mUpdateMask[i] = 0;
         }
 
         void operator |= (const UpdateMask& mask)
         {
             MANGOS_ASSERT(mask.mCount <= mCount);
-            for (uint32 i = 0; i < mBlocks; ++i)
+            for (uint32 i = 0; i < mask.mBlocks; ++i)
                 mUpdateMask[i] |= mask.mUpdateMask[i];
+            mHasData = mHasData || mask.mHasData;
         }
 
         UpdateMask operator & (const UpdateMask& mask) const
@@ -118,6 +154,6 @@ class UpdateMask
         bool mHasData;
         uint32 mCount;
         uint32 mBlocks;
-        uint32* mUpdateMask;
+        uint32 mUpdateMask[MAX_BLOCKS];
 };
 #endif
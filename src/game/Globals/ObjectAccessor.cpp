@@ -38,31 +38,28 @@ INSTANTIATE_CLASS_MUTEX(ObjectAccessor, std::mutex);
 template<class T>
 void HashMapHolder<T>::Insert(T* o)
 {
-    WriteGuard guard(i_lock);
-    m_objectMap[o->GetObjectGuid()] = o;
+    Shard& shard = GetShard(o->GetObjectGuid());
+    WriteGuard guard(shard.lock);
+    shard.objects[o->GetObjectGuid()] = o;
 }
 
 template<class T>
 void HashMapHolder<T>::Remove(T* o)
 {
-    WriteGuard guard(i_lock);
-    m_objectMap.erase(o->GetObjectGuid());
+    Shard& shard = GetShard(o->GetObjectGuid());
+    WriteGuard guard(shard.lock);
+    shard.objects.erase(o->GetObjectGuid());
 }
 
 template<class T>
 T* HashMapHolder<T>::Find(ObjectGuid guid)
 {
-    ReadGuard guard(i_lock);
-    typename MapType::iterator itr = m_objectMap.find(guid);
-    return (itr != m_objectMap.end()) ? itr->second : nullptr;
+    Shard& shard = GetShard(guid);
+    ReadGuard guard(shard.lock);
+    typename MapType::iterator itr = shard.objects.find(guid);
+    return (itr != shard.objects.end()) ? itr->second : nullptr;
 }
 
-template<class T>
-typename HashMapHolder<T>::MapType& HashMapHolder<T>::GetContainer() { return m_objectMap; }
-
-template<class T>
-typename HashMapHolder<T>::LockType& HashMapHolder<T>::GetLock() { return i_lock; }
-
 ObjectAccessor::ObjectAccessor() {}
 ObjectAccessor::~ObjectAccessor()
 {
@@ -113,11 +110,15 @@ Player* ObjectAccessor::FindPlayer(ObjectGuid guid, bool inWorld /*= true*/)
 
 Player* ObjectAccessor::FindPlayerByName(const char* name)
 {
-    HashMapHolder<Player>::ReadGuard g(HashMapHolder<Player>::GetLock());
-    HashMapHolder<Player>::MapType& m = sObjectAccessor.GetPlayers();
-    for (HashMapHolder<Player>::MapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-        if (iter->second->IsInWorld() && (::strcmp(name, iter->second->GetName()) == 0))
-            return iter->second;
+    std::string normalizedName = name;
+    if (!normalizePlayerName(normalizedName))
+        return nullptr;
+
+    ObjectAccessor& accessor = sObjectAccessor;
+    std::shared_lock<std::shared_mutex> guard(accessor.i_playerNameGuard);
+    auto itr = accessor.i_playerNames.find(normalizedName);
+    if (itr != accessor.i_playerNames.end() && itr->second->IsInWorld())
+        return itr->second;
 
     return nullptr;
 }
@@ -125,19 +126,36 @@ Player* ObjectAccessor::FindPlayerByName(const char* name)
 void
 ObjectAccessor::SaveAllPlayers() const
 {
-    HashMapHolder<Player>::ReadGuard g(HashMapHolder<Player>::GetLock());
-    HashMapHolder<Player>::MapType& m = sObjectAccessor.GetPlayers();
-    for (auto& itr : m)
+    ExecuteForAllPlayers([](Player* player)
     {
-        if (itr.second->IsInWorld())
-            itr.second->GetMap()->GetMessager().AddMessage([guid = itr.second->GetObjectGuid()](Map* map)
+        if (player->IsInWorld())
+            player->GetMap()->GetMessager().AddMessage([guid = player->GetObjectGuid()](Map* map)
             {
                 if (Player* player = map->GetPlayer(guid))
                     player->SaveToDB();
             });
         else
-            itr.second->SaveToDB();
-    }
+            player->SaveToDB();
+    });
+}
+
+void ObjectAccessor::AddObject(Player* object)
+{
+    HashMapHolder<Player>::Insert(object);
+
+    std::unique_lock<std::shared_mutex> guard(i_playerNameGuard);
+    i_playerNames[object->GetName()] = object;
+}
+
+void ObjectAccessor::RemoveObject(Player* object)
+{
+    HashMapHolder<Player>::Remove(object);
+
+    std::unique_lock<std::shared_mutex> guard(i_playerNameGuard);
+    auto itr = i_playerNames.find(object->GetName());
+    // a relogging character may be added again before its old object is deleted
+    if (itr != i_playerNames.end() && itr->second == object)
+        i_playerNames.erase(itr);
 }
 
 void ObjectAccessor::KickPlayer(ObjectGuid guid)
@@ -304,8 +322,7 @@ void ObjectAccessor::RemoveOldCorpses()
 
 /// Define the static member of HashMapHolder
 
-template <class T> typename HashMapHolder<T>::MapType HashMapHolder<T>::m_objectMap;
-template <class T> std::mutex HashMapHolder<T>::i_lock;
+template <class T> typename HashMapHolder<T>::Shard HashMapHolder<T>::m_shards[HashMapHolder<T>::SHARD_COUNT];
 
 /// Global definitions for the hashmap storage
 
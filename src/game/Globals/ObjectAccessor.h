@@ -32,6 +32,7 @@
 #include "Entities/Corpse.h"
 
 #include <mutex>
+#include <shared_mutex>
 
 class Unit;
 class WorldObject;
@@ -43,9 +44,9 @@ class HashMapHolder
     public:
 
         typedef std::unordered_map<ObjectGuid, T*>   MapType;
-        typedef std::mutex LockType;
-        typedef std::lock_guard<std::mutex> ReadGuard;
-        typedef std::lock_guard<std::mutex> WriteGuard;
+        typedef std::shared_mutex LockType;
+        typedef std::shared_lock<std::shared_mutex> ReadGuard;
+        typedef std::unique_lock<std::shared_mutex> WriteGuard;
 
         static void Insert(T* o);
 
@@ -53,17 +54,35 @@ class HashMapHolder
 
         static T* Find(ObjectGuid guid);
 
-        static MapType& GetContainer();
-
-        static LockType& GetLock();
+        // executor must not look up or add objects of this type
+        template<typename F>
+        static void ExecuteForAll(F executor)
+        {
+            for (Shard& shard : m_shards)
+            {
+                ReadGuard guard(shard.lock);
+                for (auto& itr : shard.objects)
+                    executor(itr.second);
+            }
+        }
 
     private:
 
         // Non instanceable only static
         HashMapHolder() {}
 
-        static LockType i_lock;
-        static MapType  m_objectMap;
+        // objects are spread by guid, so lookups from the map threads seldom meet on one lock
+        struct alignas(64) Shard
+        {
+            LockType lock;
+            MapType objects;
+        };
+
+        static uint32 const SHARD_COUNT = 16;
+
+        static Shard& GetShard(ObjectGuid guid) { return m_shards[guid.GetCounter() % SHARD_COUNT]; }
+
+        static Shard m_shards[SHARD_COUNT];
 };
 
 class ObjectAccessor : public MaNGOS::Singleton<ObjectAccessor, MaNGOS::ClassLevelLockable<ObjectAccessor, std::mutex> >
@@ -87,9 +106,11 @@ class ObjectAccessor : public MaNGOS::Singleton<ObjectAccessor, MaNGOS::ClassLev
         static Player* FindPlayerByName(const char* name);
         static void KickPlayer(ObjectGuid guid);
 
-        HashMapHolder<Player>::MapType& GetPlayers() const
+        // executor must not look up or add players
+        template<typename F>
+        void ExecuteForAllPlayers(F executor) const
         {
-            return HashMapHolder<Player>::GetContainer();
+            HashMapHolder<Player>::ExecuteForAll(executor);
         }
 
         void SaveAllPlayers() const;
@@ -105,14 +126,18 @@ class ObjectAccessor : public MaNGOS::Singleton<ObjectAccessor, MaNGOS::ClassLev
 
         // For call from Player/Corpse AddToWorld/RemoveFromWorld only
         void AddObject(Corpse* object) { HashMapHolder<Corpse>::Insert(object); }
-        void AddObject(Player* object) { HashMapHolder<Player>::Insert(object); }
+        void AddObject(Player* object);
         void RemoveObject(Corpse* object) { HashMapHolder<Corpse>::Remove(object); }
-        void RemoveObject(Player* object) { HashMapHolder<Player>::Remove(object); }
+        void RemoveObject(Player* object);
 
     private:
 
         Player2CorpsesMapType   i_player2corpse;
 
+        // online players by name, names are stored normalized
+        std::unordered_map<std::string, Player*> i_playerNames;
+        std::shared_mutex i_playerNameGuard;
+
         typedef std::mutex LockType;
         typedef MaNGOS::GeneralLock<LockType > Guard;
 
@@ -117,6 +117,14 @@ void VisibleNotifier::Notify()
     }
 }
 
+// broadcast packets big enough to share are copied once at the first recipient, all sockets then share the body
+static SharedWorldPacket const& ShareMessage(SharedWorldPacket& sharedMessage, WorldPacket const& message)
+{
+    if (!sharedMessage && message.size() >= MIN_SHARED_PACKET_SIZE)
+        sharedMessage = std::make_shared<WorldPacket const>(message);
+    return sharedMessage;
+}
+
 void MessageDeliverer::Visit(CameraMapType& m)
 {
     for (auto& iter : m)
@@ -126,7 +134,7 @@ void MessageDeliverer::Visit(CameraMapType& m)
         if (i_toSelf || owner != &i_player)
         {
             if (WorldSession* session = owner->GetSession())
-                session->SendPacket(i_message);
+                session->SendPacket(i_message, ShareMessage(i_sharedMessage, i_message));
         }
     }
 }
@@ -141,7 +149,7 @@ void MessageDelivererExcept::Visit(CameraMapType& m)
             continue;
 
         if (WorldSession* session = owner->GetSession())
-            session->SendPacket(i_message);
+            session->SendPacket(i_message, ShareMessage(i_sharedMessage, i_message));
     }
 }
 
@@ -150,7 +158,7 @@ void ObjectMessageDeliverer::Visit(CameraMapType& m)
     for (auto& iter : m)
     {
         if (WorldSession* session = iter.getSource()->GetOwner()->GetSession())
-            session->SendPacket(i_message);
+            session->SendPacket(i_message, ShareMessage(i_sharedMessage, i_message));
     }
 }
 
@@ -165,7 +173,7 @@ void MessageDistDeliverer::Visit(CameraMapType& m)
                 (!i_dist || iter.getSource()->GetBody()->IsWithinDist(&i_player, i_dist)))
         {
             if (WorldSession* session = owner->GetSession())
-                session->SendPacket(i_message);
+                session->SendPacket(i_message, ShareMessage(i_sharedMessage, i_message));
         }
     }
 }
@@ -177,7 +185,7 @@ void ObjectMessageDistDeliverer::Visit(CameraMapType& m)
         if (!i_dist || iter.getSource()->GetBody()->IsWithinDist(&i_object, i_dist))
         {
             if (WorldSession* session = iter.getSource()->GetOwner()->GetSession())
-                session->SendPacket(i_message);
+                session->SendPacket(i_message, ShareMessage(i_sharedMessage, i_message));
         }
     }
 }
@@ -58,10 +58,25 @@ namespace MaNGOS
         GuidSet m_unvisitedGuids;
     };
 
+    // gathers the cameras of the visited cells, used when several objects share one camera search
+    struct CameraCollector
+    {
+        std::vector<Camera*>& i_cameras;
+
+        explicit CameraCollector(std::vector<Camera*>& cameras) : i_cameras(cameras) {}
+        template<class T> void Visit(GridRefManager<T>&) {}
+        void Visit(CameraMapType& m)
+        {
+            for (auto& iter : m)
+                i_cameras.push_back(iter.getSource());
+        }
+    };
+
     struct MessageDeliverer
     {
         Player const& i_player;
         WorldPacket const& i_message;
+        SharedWorldPacket i_sharedMessage;                  // copied once at first recipient
         bool i_toSelf;
         MessageDeliverer(Player const& pl, WorldPacket const& msg, bool to_self) : i_player(pl), i_message(msg), i_toSelf(to_self) {}
         void Visit(CameraMapType& m);
@@ -71,6 +86,7 @@ namespace MaNGOS
     struct MessageDelivererExcept
     {
         WorldPacket const&  i_message;
+        SharedWorldPacket i_sharedMessage;                  // copied once at first recipient
         Player const* i_skipped_receiver;
 
         MessageDelivererExcept(WorldPacket const& msg, Player const* skipped)
@@ -83,6 +99,7 @@ namespace MaNGOS
     struct ObjectMessageDeliverer
     {
         WorldPacket const& i_message;
+        SharedWorldPacket i_sharedMessage;                  // copied once at first recipient
         explicit ObjectMessageDeliverer(WorldPacket const& msg) : i_message(msg) {}
         void Visit(CameraMapType& m);
         template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
@@ -92,6 +109,7 @@ namespace MaNGOS
     {
         Player const& i_player;
         WorldPacket const& i_message;
+        SharedWorldPacket i_sharedMessage;                  // copied once at first recipient
         bool i_toSelf;
         bool i_ownTeamOnly;
         float i_dist;
@@ -106,6 +124,7 @@ namespace MaNGOS
     {
         WorldObject const& i_object;
         WorldPacket const& i_message;
+        SharedWorldPacket i_sharedMessage;                  // copied once at first recipient
         float i_dist;
         ObjectMessageDistDeliverer(WorldObject const& obj, WorldPacket const& msg, float dist) : i_object(obj), i_message(msg), i_dist(dist) {}
         void Visit(CameraMapType& m);
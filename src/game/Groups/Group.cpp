@@ -776,6 +776,8 @@ void Group::UpdateOfflineLeader(time_t time, uint32 delay)
 
 void Group::BroadcastPacket(WorldPacket const& packet, bool ignorePlayersInBGRaid, int group, ObjectGuid ignore) const
 {
+    SharedWorldPacket sharedPacket = ShareWorldPacket(packet);
+
     for (GroupReference const* itr = GetFirstMember(); itr != nullptr; itr = itr->next())
     {
         Player* pl = itr->getSource();
@@ -783,12 +785,14 @@ void Group::BroadcastPacket(WorldPacket const& packet, bool ignorePlayersInBGRai
             continue;
 
         if (pl->GetSession() && (group == -1 || itr->getSubGroup() == group))
-            pl->GetSession()->SendPacket(packet);
+            pl->GetSession()->SendPacket(packet, sharedPacket);
     }
 }
 
 void Group::BroadcastPacketInRange(WorldObject const* who, WorldPacket const& packet, bool ignorePlayersInBGRaid, int group, ObjectGuid ignore) const
 {
+    SharedWorldPacket sharedPacket = ShareWorldPacket(packet);
+
     for (auto itr = GetFirstMember(); itr != nullptr; itr = itr->next())
     {
         Player* pl = itr->getSource();
@@ -799,7 +803,7 @@ void Group::BroadcastPacketInRange(WorldObject const* who, WorldPacket const& pa
             continue;
 
         if (pl->GetSession() && (group == -1 || itr->getSubGroup() == group))
-            pl->GetSession()->SendPacket(packet);
+            pl->GetSession()->SendPacket(packet, sharedPacket);
     }
 }
 
@@ -595,23 +595,27 @@ void Guild::BroadcastToOfficers(WorldSession* session, const std::string& msg, u
 
 void Guild::BroadcastPacket(WorldPacket& packet)
 {
+    SharedWorldPacket sharedPacket = ShareWorldPacket(packet);
+
     for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
     {
         Player* player = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
         if (player)
-            player->GetSession()->SendPacket(packet);
+            player->GetSession()->SendPacket(packet, sharedPacket);
     }
 }
 
 void Guild::BroadcastPacketToRank(WorldPacket& packet, uint32 rankId)
 {
+    SharedWorldPacket sharedPacket = ShareWorldPacket(packet);
+
     for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
     {
         if (itr->second.RankId == rankId)
         {
             Player* player = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
             if (player)
-                player->GetSession()->SendPacket(packet);
+                player->GetSession()->SendPacket(packet, sharedPacket);
         }
     }
 }
@@ -28,11 +28,15 @@
 #include "World/World.h"
 #include "Policies/Singleton.h"
 #include "Util/Util.h"
+#include "Util/MappedFile.h"
+#include "Maps/GridPrefetcher.h"
 
+#include <chrono>
 #include <mutex>
 
 char const* MAP_MAGIC         = "MAPS";
 char const* MAP_VERSION_MAGIC = "z1.4";
+char const* MAP_ALIGNED_VERSION_MAGIC = "a1.4";
 char const* MAP_AREA_MAGIC    = "AREA";
 char const* MAP_HEIGHT_MAGIC  = "MHGT";
 char const* MAP_LIQUID_MAGIC  = "MLIQ";
@@ -90,6 +94,19 @@ bool GridMap::loadData(char const* filename)
     }
 
     fread(&header, sizeof(header), 1, in);
+    if (header.mapMagic     == *((uint32 const*)(MAP_MAGIC)) &&
+            header.versionMagic == *((uint32 const*)(MAP_ALIGNED_VERSION_MAGIC)))
+    {
+        fclose(in);
+        if (!loadMappedData(filename))
+        {
+            sLog.outError("Error mapping map file '%s'", filename);
+            unloadData();
+            return false;
+        }
+        return true;
+    }
+
     if (header.mapMagic     == *((uint32 const*)(MAP_MAGIC)) &&
             header.versionMagic == *((uint32 const*)(MAP_VERSION_MAGIC)))
     {
@@ -134,14 +151,161 @@ bool GridMap::loadData(char const* filename)
     return false;
 }
 
+bool GridMap::loadMappedData(char const* filename)
+{
+    m_mappedFile = std::make_unique<MappedFile>();
+    if (!m_mappedFile->Open(filename))
+        return false;
+
+    uint8 const* data = m_mappedFile->GetData();
+    size_t size = m_mappedFile->GetSize();
+
+    // every header and array starts at an aligned offset, nothing is used before its bounds are checked
+    auto section = [data, size](size_t offset, size_t length) -> uint8 const*
+    {
+        if (offset % MAP_SECTION_ALIGNMENT || offset > size || length > size - offset)
+            return nullptr;
+        return data + offset;
+    };
+    auto next = [](size_t offset, size_t length)
+    {
+        return (offset + length + MAP_SECTION_ALIGNMENT - 1) / MAP_SECTION_ALIGNMENT * MAP_SECTION_ALIGNMENT;
+    };
+
+    GridMapFileHeader header;
+    if (size < sizeof(header))
+        return false;
+    memcpy(&header, data, sizeof(header));
+
+    if (header.areaMapOffset)
+    {
+        GridMapAreaHeader areaHeader;
+        uint8 const* ptr = section(header.areaMapOffset, sizeof(areaHeader));
+        if (!ptr)
+            return false;
+
+        memcpy(&areaHeader, ptr, sizeof(areaHeader));
+        if (areaHeader.fourcc != *((uint32 const*)(MAP_AREA_MAGIC)))
+            return false;
+
+        m_gridArea = areaHeader.gridArea;
+        if (!(areaHeader.flags & MAP_AREA_NO_AREA))
+        {
+            if (!(ptr = section(next(header.areaMapOffset, sizeof(areaHeader)), 16 * 16 * sizeof(uint16))))
+                return false;
+            m_area_map = reinterpret_cast<uint16 const*>(ptr);
+        }
+    }
+
+    if (header.holesOffset)
+    {
+        uint8 const* ptr = section(header.holesOffset, sizeof(m_holes));
+        if (!ptr)
+            return false;
+        memcpy(m_holes, ptr, sizeof(m_holes));
+    }
+
+    if (header.heightMapOffset)
+    {
+        GridMapHeightHeader heightHeader;
+        uint8 const* ptr = section(header.heightMapOffset, sizeof(heightHeader));
+        if (!ptr)
+            return false;
+
+        memcpy(&heightHeader, ptr, sizeof(heightHeader));
+        if (heightHeader.fourcc != *((uint32 const*)(MAP_HEIGHT_MAGIC)))
+            return false;
+
+        m_gridHeight = heightHeader.gridHeight;
+        if (!(heightHeader.flags & MAP_HEIGHT_NO_HEIGHT))
+        {
+            size_t valueSize = (heightHeader.flags & MAP_HEIGHT_AS_INT16) ? sizeof(uint16) : (heightHeader.flags & MAP_HEIGHT_AS_INT8) ? sizeof(uint8) : sizeof(float);
+            size_t V9Offset = next(header.heightMapOffset, sizeof(heightHeader));
+            uint8 const* V9 = section(V9Offset, 129 * 129 * valueSize);
+            uint8 const* V8 = section(next(V9Offset, 129 * 129 * valueSize), 128 * 128 * valueSize);
+            if (!V9 || !V8)
+                return false;
+
+            if ((heightHeader.flags & MAP_HEIGHT_AS_INT16))
+            {
+                m_uint16_V9 = reinterpret_cast<uint16 const*>(V9);
+                m_uint16_V8 = reinterpret_cast<uint16 const*>(V8);
+                m_gridIntHeightMultiplier = (heightHeader.gridMaxHeight - heightHeader.gridHeight) / 65535;
+                m_gridGetHeight = &GridMap::getHeightFromUint16;
+            }
+            else if ((heightHeader.flags & MAP_HEIGHT_AS_INT8))
+            {
+                m_uint8_V9 = V9;
+                m_uint8_V8 = V8;
+                m_gridIntHeightMultiplier = (heightHeader.gridMaxHeight - heightHeader.gridHeight) / 255;
+                m_gridGetHeight = &GridMap::getHeightFromUint8;
+            }
+            else
+            {
+                m_V9 = reinterpret_cast<float const*>(V9);
+                m_V8 = reinterpret_cast<float const*>(V8);
+                m_gridGetHeight = &GridMap::getHeightFromFloat;
+            }
+        }
+    }
+
+    if (header.liquidMapOffset)
+    {
+        GridMapLiquidHeader liquidHeader;
+        uint8 const* ptr = section(header.liquidMapOffset, sizeof(liquidHeader));
+        if (!ptr)
+            return false;
+
+        memcpy(&liquidHeader, ptr, sizeof(liquidHeader));
+        if (liquidHeader.fourcc != *((uint32 const*)(MAP_LIQUID_MAGIC)))
+            return false;
+
+        m_liquidGlobalEntry = liquidHeader.liquidType;
+        m_liquidGlobalFlags = liquidHeader.liquidFlags;
+        m_liquid_offX   = liquidHeader.offsetX;
+        m_liquid_offY   = liquidHeader.offsetY;
+        m_liquid_width  = liquidHeader.width;
+        m_liquid_height = liquidHeader.height;
+        m_liquidLevel   = liquidHeader.liquidLevel;
+
+        size_t offset = next(header.liquidMapOffset, sizeof(liquidHeader));
+        if (!(liquidHeader.flags & MAP_LIQUID_NO_TYPE))
+        {
+            uint8 const* entries = section(offset, 16 * 16 * sizeof(uint16));
+            offset = next(offset, 16 * 16 * sizeof(uint16));
+            uint8 const* flags = section(offset, 16 * 16 * sizeof(uint8));
+            offset = next(offset, 16 * 16 * sizeof(uint8));
+            if (!entries || !flags)
+                return false;
+
+            m_liquidEntry = reinterpret_cast<uint16 const*>(entries);
+            m_liquidFlags = flags;
+        }
+
+        if (!(liquidHeader.flags & MAP_LIQUID_NO_HEIGHT))
+        {
+            if (!(ptr = section(offset, m_liquid_width * m_liquid_height * sizeof(float))))
+                return false;
+            m_liquid_map = reinterpret_cast<float const*>(ptr);
+        }
+    }
+
+    return true;
+}
+
 void GridMap::unloadData()
 {
-    delete[] m_area_map;
-    delete[] m_V9;
-    delete[] m_V8;
-    delete[] m_liquidEntry;
-    delete[] m_liquidFlags;
-    delete[] m_liquid_map;
+    if (m_mappedFile)
+        m_mappedFile.reset();                               // arrays point into the mapping
+    else
+    {
+        delete[] m_area_map;
+        delete[] m_V9;
+        delete[] m_V8;
+        delete[] m_liquidEntry;
+        delete[] m_liquidFlags;
+        delete[] m_liquid_map;
+    }
 
     m_area_map = nullptr;
     m_V9 = nullptr;
@@ -163,8 +327,9 @@ bool GridMap::loadAreaData(FILE* in, uint32 offset, uint32 /*size*/)
     m_gridArea = header.gridArea;
     if (!(header.flags & MAP_AREA_NO_AREA))
     {
-        m_area_map = new uint16 [16 * 16];
-        fread(m_area_map, sizeof(uint16), 16 * 16, in);
+        uint16* areaMap = new uint16 [16 * 16];
+        fread(areaMap, sizeof(uint16), 16 * 16, in);
+        m_area_map = areaMap;
     }
 
     return true;
@@ -183,28 +348,34 @@ bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
     {
         if ((header.flags & MAP_HEIGHT_AS_INT16))
         {
-            m_uint16_V9 = new uint16 [129 * 129];
-            m_uint16_V8 = new uint16 [128 * 128];
-            fread(m_uint16_V9, sizeof(uint16), 129 * 129, in);
-            fread(m_uint16_V8, sizeof(uint16), 128 * 128, in);
+            uint16* V9 = new uint16 [129 * 129];
+            uint16* V8 = new uint16 [128 * 128];
+            fread(V9, sizeof(uint16), 129 * 129, in);
+            fread(V8, sizeof(uint16), 128 * 128, in);
+            m_uint16_V9 = V9;
+            m_uint16_V8 = V8;
             m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 65535;
             m_gridGetHeight = &GridMap::getHeightFromUint16;
         }
         else if ((header.flags & MAP_HEIGHT_AS_INT8))
         {
-            m_uint8_V9 = new uint8 [129 * 129];
-            m_uint8_V8 = new uint8 [128 * 128];
-            fread(m_uint8_V9, sizeof(uint8), 129 * 129, in);
-            fread(m_uint8_V8, sizeof(uint8), 128 * 128, in);
+            uint8* V9 = new uint8 [129 * 129];
+            uint8* V8 = new uint8 [128 * 128];
+            fread(V9, sizeof(uint8), 129 * 129, in);
+            fread(V8, sizeof(uint8), 128 * 128, in);
+            m_uint8_V9 = V9;
+            m_uint8_V8 = V8;
             m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 255;
             m_gridGetHeight = &GridMap::getHeightFromUint8;
         }
         else
         {
-            m_V9 = new float [129 * 129];
-            m_V8 = new float [128 * 128];
-            fread(m_V9, sizeof(float), 129 * 129, in);
-            fread(m_V8, sizeof(float), 128 * 128, in);
+            float* V9 = new float [129 * 129];
+            float* V8 = new float [128 * 128];
+            fread(V9, sizeof(float), 129 * 129, in);
+            fread(V8, sizeof(float), 128 * 128, in);
+            m_V9 = V9;
+            m_V8 = V8;
             m_gridGetHeight = &GridMap::getHeightFromFloat;
         }
     }
@@ -242,17 +413,20 @@ bool GridMap::loadGridMapLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
 
     if (!(header.flags & MAP_LIQUID_NO_TYPE))
     {
-        m_liquidEntry = new uint16[16 * 16];
-        fread(m_liquidEntry, sizeof(uint16), 16 * 16, in);
+        uint16* liquidEntry = new uint16[16 * 16];
+        fread(liquidEntry, sizeof(uint16), 16 * 16, in);
+        m_liquidEntry = liquidEntry;
 
-        m_liquidFlags = new uint8[16 * 16];
-        fread(m_liquidFlags, sizeof(uint8), 16 * 16, in);
+        uint8* liquidFlags = new uint8[16 * 16];
+        fread(liquidFlags, sizeof(uint8), 16 * 16, in);
+        m_liquidFlags = liquidFlags;
     }
 
     if (!(header.flags & MAP_LIQUID_NO_HEIGHT))
     {
-        m_liquid_map = new float [m_liquid_width * m_liquid_height];
-        fread(m_liquid_map, sizeof(float), m_liquid_width * m_liquid_height, in);
+        float* liquidMap = new float [m_liquid_width * m_liquid_height];
+        fread(liquidMap, sizeof(float), m_liquid_width * m_liquid_height, in);
+        m_liquid_map = liquidMap;
     }
 
     return true;
@@ -388,7 +562,7 @@ float GridMap::getHeightFromUint8(float x, float y) const
     y_int &= (MAP_RESOLUTION - 1);
 
     int32 a, b, c;
-    uint8* V9_h1_ptr = &m_uint8_V9[x_int * 128 + x_int + y_int];
+    uint8 const* V9_h1_ptr = &m_uint8_V9[x_int * 128 + x_int + y_int];
     if (x + y < 1)
     {
         if (x > y)
@@ -456,7 +630,7 @@ float GridMap::getHeightFromUint16(float x, float y) const
     y_int &= (MAP_RESOLUTION - 1);
 
     int32 a, b, c;
-    uint16* V9_h1_ptr = &m_uint16_V9[x_int * 128 + x_int + y_int];
+    uint16 const* V9_h1_ptr = &m_uint16_V9[x_int * 128 + x_int + y_int];
     if (x + y < 1)
     {
         if (x > y)
@@ -656,7 +830,7 @@ bool GridMap::ExistMap(uint32 mapid, int gx, int gy)
     GridMapFileHeader header;
     fread(&header, sizeof(header), 1, pf);
     if (header.mapMagic     != *((uint32 const*)(MAP_MAGIC)) ||
-            header.versionMagic != *((uint32 const*)(MAP_VERSION_MAGIC)))
+            (header.versionMagic != *((uint32 const*)(MAP_VERSION_MAGIC)) && header.versionMagic != *((uint32 const*)(MAP_ALIGNED_VERSION_MAGIC))))
     {
         sLog.outError("Map file '%s' is non-compatible version (outdated?). Please, create new using ad.exe program.", tmp);
         delete[] tmp;
@@ -690,6 +864,17 @@ bool GridMap::ExistVMap(uint32 mapid, int gx, int gy)
 }
 
 //////////////////////////////////////////////////////////////////////////
+struct TerrainInfo::PrefetchedGrid
+{
+    std::vector<std::string> vmapModels;                    // model references held until the vmap tile is loaded
+    MMAP::MMapTileData mmapTile;
+    uint32 loadTimeUs;                                      // time the prefetch thread spent loading
+    uint32 prefetchTime;
+};
+
+// prefetched grids no map asked for are dropped by the next clean up after this time
+static uint32 const PREFETCHED_GRID_KEEP_TIME = 60 * IN_MILLISECONDS;
+
 TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid)
 {
     for (int k = 0; k < MAX_NUMBER_OF_GRIDS; ++k)
@@ -715,6 +900,10 @@ TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid)
 
 TerrainInfo::~TerrainInfo()
 {
+    for (auto& prefetched : m_prefetchedGrids)
+        ReleasePrefetchedGrid(*prefetched.second);
+    m_prefetchedGrids.clear();
+
     for (int k = 0; k < MAX_NUMBER_OF_GRIDS; ++k)
         for (auto& m_GridMap : m_GridMaps)
             delete m_GridMap[k];
@@ -731,9 +920,9 @@ GridMap* TerrainInfo::Load(const uint32 x, const uint32 y, bool mapOnly /*= fals
     // reference grid as a first step
     RefGrid(x, y);
 
-    // quick check if GridMap already loaded
+    // quick check if GridMap already loaded, a prefetched one still needs its vmap and navmesh
     GridMap* pMap = m_GridMaps[x][y];
-    if (!pMap)
+    if (!pMap || (!mapOnly && !pMap->IsFullyLoaded()))
     {
         pMap = LoadMapAndVMap(x, y, mapOnly);
         m_GridMapsLoadAttempted[x][y] = true;
@@ -766,6 +955,22 @@ void TerrainInfo::CleanUpGrids(const uint32 diff)
     if (!i_timer.Passed())
         return;
 
+    // the prefetch thread may add grids meanwhile
+    LOCK_GUARD lock(m_mutex);
+
+    uint32 now = WorldTimer::getMSTime();
+    for (auto itr = m_prefetchedGrids.begin(); itr != m_prefetchedGrids.end();)
+    {
+        if (WorldTimer::getMSTimeDiff(itr->second->prefetchTime, now) < PREFETCHED_GRID_KEEP_TIME)
+        {
+            ++itr;
+            continue;
+        }
+
+        ReleasePrefetchedGrid(*itr->second);
+        itr = m_prefetchedGrids.erase(itr);
+    }
+
     for (int y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
     {
         for (int x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
@@ -773,8 +978,8 @@ void TerrainInfo::CleanUpGrids(const uint32 diff)
             const int16& iRef = m_GridRef[x][y];
             GridMap* pMap = m_GridMaps[x][y];
 
-            // delete those GridMap objects which have refcount = 0
-            if (pMap && iRef == 0)
+            // delete those GridMap objects which have refcount = 0, recently prefetched ones are kept for the map about to load them
+            if (pMap && iRef == 0 && m_prefetchedGrids.find(MAX_NUMBER_OF_GRIDS * x + y) == m_prefetchedGrids.end())
             {
                 m_GridMaps[x][y] = nullptr;
                 m_GridMapsLoadAttempted[x][y] = false;
@@ -1239,34 +1444,16 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y, bool mapOnl
         return m_GridMaps[x][y];
     }
 
-    {
-        LOCK_GUARD lock(m_mutex);
-        // double checked lock pattern
-        if (!m_GridMaps[x][y])
-        {
-            GridMap* map = new GridMap();
-
-            // map file name
-            int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
-            char* tmp = new char[len];
-            snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, x, y);
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", tmp);
+    auto startTime = std::chrono::steady_clock::now();
 
-            if (!map->loadData(tmp))
-            {
-                sLog.outError("Error load map file: %s", tmp);
-                //assert(false);
-            }
-
-            delete[] tmp;
-            m_GridMaps[x][y] = map;
-        }
-    }
+    LoadGridMap(x, y);
 
     // we'll load the rest later
     if (mapOnly)
         return m_GridMaps[x][y];
 
+    std::unique_ptr<PrefetchedGrid> prefetched = TakePrefetchedGrid(x, y);
+
     if (!m_vmgr->IsTileLoaded(m_mapId, x, y))
     {
         // load VMAPs for current map/grid...
@@ -1291,15 +1478,93 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y, bool mapOnl
     if (!MMAP::MMapFactory::createOrGetMMapManager()->IsMMapIsLoaded(m_mapId, x, y))
     {
         // load navmesh
-        MMAP::MMapFactory::createOrGetMMapManager()->loadMap(sWorld.GetDataPath(), m_mapId, x, y);
+        MMAP::MMapFactory::createOrGetMMapManager()->loadMap(sWorld.GetDataPath(), m_mapId, x, y, prefetched ? &prefetched->mmapTile : nullptr);
     }
 
+    // the tile holds its own model references now
+    if (prefetched)
+        ReleasePrefetchedGrid(*prefetched);
+
     if (m_GridMaps[x][y])
         m_GridMaps[x][y]->SetFullyLoaded();
 
+    uint32 loadTimeUs = uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count());
+    GridPrefetcher::RecordGridLoad(bool(prefetched), prefetched ? prefetched->loadTimeUs : 0, loadTimeUs);
+
     return  m_GridMaps[x][y];
 }
 
+void TerrainInfo::LoadGridMap(const uint32 x, const uint32 y)
+{
+    LOCK_GUARD lock(m_mutex);
+    // double checked lock pattern
+    if (!m_GridMaps[x][y])
+    {
+        GridMap* map = new GridMap();
+
+        // map file name
+        int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
+        char* tmp = new char[len];
+        snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, x, y);
+        DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", tmp);
+
+        if (!map->loadData(tmp))
+        {
+            sLog.outError("Error load map file: %s", tmp);
+            //assert(false);
+        }
+
+        delete[] tmp;
+        m_GridMaps[x][y] = map;
+    }
+}
+
+void TerrainInfo::Prefetch(const uint32 x, const uint32 y)
+{
+    MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
+    MANGOS_ASSERT(y < MAX_NUMBER_OF_GRIDS);
+
+    {
+        LOCK_GUARD lock(m_mutex);
+        if ((m_GridMaps[x][y] && m_GridMaps[x][y]->IsFullyLoaded()) || m_prefetchedGrids.find(MAX_NUMBER_OF_GRIDS * x + y) != m_prefetchedGrids.end())
+            return;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    LoadGridMap(x, y);
+
+    // only read here, vmap trees and navmeshes are linked by the map thread
+    std::unique_ptr<PrefetchedGrid> prefetched(new PrefetchedGrid());
+    m_vmgr->preloadMapModels((sWorld.GetDataPath() + "vmaps").c_str(), m_mapId, x, y, prefetched->vmapModels);
+    if (MMAP::MMapFactory::createOrGetMMapManager()->IsEnabled())
+        MMAP::MMapManager::readMapTile(sWorld.GetDataPath(), m_mapId, x, y, prefetched->mmapTile);
+
+    prefetched->loadTimeUs = uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count());
+    prefetched->prefetchTime = WorldTimer::getMSTime();
+
+    LOCK_GUARD lock(m_mutex);
+    m_prefetchedGrids.emplace(MAX_NUMBER_OF_GRIDS * x + y, std::move(prefetched));
+}
+
+std::unique_ptr<TerrainInfo::PrefetchedGrid> TerrainInfo::TakePrefetchedGrid(const uint32 x, const uint32 y)
+{
+    LOCK_GUARD lock(m_mutex);
+    auto itr = m_prefetchedGrids.find(MAX_NUMBER_OF_GRIDS * x + y);
+    if (itr == m_prefetchedGrids.end())
+        return nullptr;
+
+    std::unique_ptr<PrefetchedGrid> prefetched = std::move(itr->second);
+    m_prefetchedGrids.erase(itr);
+    return prefetched;
+}
+
+void TerrainInfo::ReleasePrefetchedGrid(PrefetchedGrid& grid)
+{
+    m_vmgr->releaseMapModels(grid.vmapModels);
+    grid.vmapModels.clear();
+}
+
 float TerrainInfo::GetWaterLevel(float x, float y, float z, float* pGround /*= nullptr*/) const
 {
     if (CanCheckLiquidLevel(x, y))
@@ -27,8 +27,11 @@
 #include "Maps/GridMapDefines.h"
 
 #include <atomic>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 
+class MappedFile;
 class Creature;
 class Unit;
 class WorldPacket;
@@ -51,22 +54,22 @@ class GridMap
 
         // Area data
         uint16 m_gridArea;
-        uint16* m_area_map;
+        uint16 const* m_area_map;
 
         // Height level data
         float m_gridHeight;
         float m_gridIntHeightMultiplier;
         union
         {
-            float* m_V9;
-            uint16* m_uint16_V9;
-            uint8* m_uint8_V9;
+            float const* m_V9;
+            uint16 const* m_uint16_V9;
+            uint8 const* m_uint8_V9;
         };
         union
         {
-            float* m_V8;
-            uint16* m_uint16_V8;
-            uint8* m_uint8_V8;
+            float const* m_V8;
+            uint16 const* m_uint16_V8;
+            uint8 const* m_uint8_V8;
         };
 
         // Liquid data
@@ -77,13 +80,17 @@ class GridMap
         uint8 m_liquid_width;
         uint8 m_liquid_height;
         float m_liquidLevel;
-        uint16* m_liquidEntry;
-        uint8* m_liquidFlags;
-        float* m_liquid_map;
+        uint16 const* m_liquidEntry;
+        uint8 const* m_liquidFlags;
+        float const* m_liquid_map;
 
-        // For fast check
-        bool m_fullyLoaded;
+        // For fast check, read by the grid prefetch thread
+        std::atomic<bool> m_fullyLoaded;
 
+        // set for aligned map files, the data arrays above then point into the mapping
+        std::unique_ptr<MappedFile> m_mappedFile;
+
+        bool loadMappedData(char const* filename);
         bool loadAreaData(FILE* in, uint32 offset, uint32 size);
         bool loadHeightData(FILE* in, uint32 offset, uint32 size);
         bool loadGridMapLiquidData(FILE* in, uint32 offset, uint32 size);
@@ -176,6 +183,10 @@ class TerrainInfo : public Referencable<std::atomic_long>
 
         bool CanCheckLiquidLevel(float x, float y) const;
 
+        // loads the terrain, vmap models and navmesh tile of a grid before a map needs it
+        // called by the GridPrefetcher thread, the map thread only attaches the data in LoadMapAndVMap
+        void Prefetch(const uint32 x, const uint32 y);
+
     protected:
         friend class Map;
         friend class ObjectMgr;
@@ -189,6 +200,11 @@ class TerrainInfo : public Referencable<std::atomic_long>
 
         GridMap* GetGrid(const float x, const float y, bool loadOnlyMap = false);
         GridMap* LoadMapAndVMap(const uint32 x, const uint32 y, bool mapOnly = false);
+        void LoadGridMap(const uint32 x, const uint32 y);
+
+        struct PrefetchedGrid;
+        std::unique_ptr<PrefetchedGrid> TakePrefetchedGrid(const uint32 x, const uint32 y);
+        void ReleasePrefetchedGrid(PrefetchedGrid& grid);
 
         int RefGrid(const uint32& x, const uint32& y);
         int UnrefGrid(const uint32& x, const uint32& y);
@@ -208,6 +224,9 @@ class TerrainInfo : public Referencable<std::atomic_long>
         typedef std::lock_guard<LOCK_TYPE> LOCK_GUARD;
         LOCK_TYPE m_mutex;
         LOCK_TYPE m_refMutex;
+
+        // data loaded by Prefetch for grids no map has loaded yet, guarded by m_mutex
+        std::unordered_map<uint32, std::unique_ptr<PrefetchedGrid>> m_prefetchedGrids;
 };
 
 // class for managing TerrainData object and all sort of geometry querying operations
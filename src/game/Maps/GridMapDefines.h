@@ -2,6 +2,10 @@
 #ifndef EXTRACTOR_DEFINES_H
 #define EXTRACTOR_DEFINES_H
 
+// aligned map files start every header and data array at a multiple of this offset,
+// the server maps them into memory and reads the arrays in place
+#define MAP_SECTION_ALIGNMENT 16
+
 struct GridMapFileHeader
 {
     uint32 mapMagic;
@@ -0,0 +1,134 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Maps/GridPrefetcher.h"
+#include "Maps/GridMap.h"
+
+#include <atomic>
+
+namespace
+{
+    std::atomic<uint64> s_requests(0);
+    std::atomic<uint64> s_hits(0);
+    std::atomic<uint64> s_misses(0);
+    std::atomic<uint64> s_stallAvoidedUs(0);
+    std::atomic<uint64> s_mapLoadUs(0);
+
+    uint32 PackGrid(TerrainInfo const* terrain, uint32 x, uint32 y)
+    {
+        return (terrain->GetMapId() << 16) | (x << 8) | y;
+    }
+
+    // the map may have been unloaded meanwhile, the last reference then frees the terrain like Map does
+    void ReleaseTerrain(TerrainInfo* terrain)
+    {
+        if (terrain->Release())
+            sTerrainMgr.UnloadTerrain(terrain->GetMapId());
+    }
+}
+
+void GridPrefetcher::Start()
+{
+    if (IsRunning())
+        return;
+
+    m_stop = false;
+    m_thread = std::thread(&GridPrefetcher::WorkerThread, this);
+}
+
+void GridPrefetcher::Stop()
+{
+    if (!IsRunning())
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+
+    for (GridRequest const& request : m_queue)
+        ReleaseTerrain(request.terrain);
+
+    m_queue.clear();
+    m_queued.clear();
+}
+
+void GridPrefetcher::Request(TerrainInfo* terrain, uint32 x, uint32 y)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (m_stop || m_queue.size() >= MAX_QUEUED_GRIDS || !m_queued.insert(PackGrid(terrain, x, y)).second)
+            return;
+
+        // keeps the terrain alive until the grid is loaded
+        terrain->AddRef();
+        m_queue.push_back({ terrain, x, y });
+    }
+    m_condition.notify_one();
+    s_requests.fetch_add(1, std::memory_order_relaxed);
+}
+
+void GridPrefetcher::WorkerThread()
+{
+    while (true)
+    {
+        GridRequest request;
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_condition.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_stop)
+                return;
+
+            request = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        uint32 packedGrid = PackGrid(request.terrain, request.x, request.y);
+        request.terrain->Prefetch(request.x, request.y);
+        ReleaseTerrain(request.terrain);
+
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_queued.erase(packedGrid);
+    }
+}
+
+void GridPrefetcher::RecordGridLoad(bool prefetched, uint32 stallAvoidedUs, uint32 loadUs)
+{
+    if (prefetched)
+    {
+        s_hits.fetch_add(1, std::memory_order_relaxed);
+        s_stallAvoidedUs.fetch_add(stallAvoidedUs, std::memory_order_relaxed);
+    }
+    else
+        s_misses.fetch_add(1, std::memory_order_relaxed);
+
+    s_mapLoadUs.fetch_add(loadUs, std::memory_order_relaxed);
+}
+
+GridPrefetchStats GridPrefetcher::GetStats()
+{
+    GridPrefetchStats stats;
+    stats.requests = s_requests.load(std::memory_order_relaxed);
+    stats.hits = s_hits.load(std::memory_order_relaxed);
+    stats.misses = s_misses.load(std::memory_order_relaxed);
+    stats.stallAvoidedUs = s_stallAvoidedUs.load(std::memory_order_relaxed);
+    stats.mapLoadUs = s_mapLoadUs.load(std::memory_order_relaxed);
+    return stats;
+}
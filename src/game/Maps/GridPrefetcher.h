@@ -0,0 +1,80 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_GRIDPREFETCHER_H
+#define MANGOS_GRIDPREFETCHER_H
+
+#include "Platform/Define.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+class TerrainInfo;
+
+struct GridPrefetchStats
+{
+    uint64 requests;                                        // grids queued for prefetching
+    uint64 hits;                                            // grid loads of maps that found the grid prefetched
+    uint64 misses;                                          // grid loads of maps that had to read everything themselves
+    uint64 stallAvoidedUs;                                  // loading time the hits saved the map threads
+    uint64 mapLoadUs;                                       // loading time left on the map threads
+};
+
+// Loads the terrain, vmap models and navmesh tiles of grids players are about to enter on a background thread,
+// see Map::PrefetchGrids. The map thread then only links the prefetched data and spawns the grid objects.
+class GridPrefetcher
+{
+    public:
+        GridPrefetcher() : m_stop(false) {}
+        GridPrefetcher(const GridPrefetcher&) = delete;
+        ~GridPrefetcher() { Stop(); }
+
+        void Start();
+        void Stop();
+        bool IsRunning() const { return m_thread.joinable(); }
+
+        // queues a grid of the terrain, given in terrain grid coordinates
+        void Request(TerrainInfo* terrain, uint32 x, uint32 y);
+
+        static void RecordGridLoad(bool prefetched, uint32 stallAvoidedUs, uint32 loadUs);
+        static GridPrefetchStats GetStats();
+
+    private:
+        struct GridRequest
+        {
+            TerrainInfo* terrain;
+            uint32 x;
+            uint32 y;
+        };
+
+        static uint32 const MAX_QUEUED_GRIDS = 64;          // further requests are dropped, the maps load those grids themselves
+
+        void WorkerThread();
+
+        std::thread m_thread;
+        std::mutex m_lock;
+        std::condition_variable m_condition;
+        std::deque<GridRequest> m_queue;
+        std::unordered_set<uint32> m_queued;                // queued and in progress grids
+        bool m_stop;
+};
+
+#endif
@@ -18,6 +18,7 @@
 
 #include "Maps/Map.h"
 #include "Maps/MapManager.h"
+#include "Maps/MapWorkers.h"
 #include "Entities/Player.h"
 #include "Grids/GridNotifiers.h"
 #include "Log/Log.h"
@@ -35,7 +36,10 @@
 #include "MapRefManager.h"
 #include "Server/DBCEnums.h"
 #include "VMapFactory.h"
+#include "vmap/GameObjectModel.h"
 #include "MotionGenerators/MoveMap.h"
+#include "MotionGenerators/PathCache.h"
+#include "Movement/MoveSpline.h"
 #include "Chat/Chat.h"
 #include "Weather/Weather.h"
 #include "AI/ScriptDevAI/ScriptDevAIMgr.h"
@@ -149,12 +153,97 @@ void Map::LoadMapAndVMap(int gx, int gy)
         return;
 
     if (m_TerrainData->Load(gx, gy))
+    {
         m_bLoadedGrids[gx][gy] = true;
+        InvalidateGridQueryCache(gx, gy);
+    }
+}
+
+void Map::InvalidateGridQueryCache(int gx, int gy)
+{
+    // terrain coordinates, grid 0 is at the highest map coordinates
+    float maxX = (CENTER_GRID_ID - gx) * SIZE_OF_GRIDS;
+    float maxY = (CENTER_GRID_ID - gy) * SIZE_OF_GRIDS;
+    m_queryCache.Invalidate(maxX - SIZE_OF_GRIDS, maxY - SIZE_OF_GRIDS, maxX, maxY);
+}
+
+void Map::PrefetchGrids()
+{
+    GridPrefetcher* prefetcher = sMapMgr.GetGridPrefetcher();
+    uint32 lookahead = sWorld.getConfig(CONFIG_UINT32_GRID_PREFETCH_LOOKAHEAD);
+    if (!prefetcher || !lookahead)
+        return;
+
+    for (auto& ref : m_mapRefManager)
+    {
+        Player* player = ref.getSource();
+        if (!player || !player->IsInWorld())
+            continue;
+
+        float x = player->GetPositionX();
+        float y = player->GetPositionY();
+
+        if (player->IsTaxiFlying() && player->movespline->Initialized() && !player->movespline->Finalized())
+        {
+            // follow the flight path as far as it is flown within the lookahead time
+            Movement::MoveSpline const& moveSpline = *player->movespline;
+            float distance = moveSpline.Speed() * lookahead;
+            for (int32 i = moveSpline._currentSplineIdx() + 1; i <= moveSpline._Spline().last() && distance > 0.0f; ++i)
+            {
+                G3D::Vector3 const& node = moveSpline._Spline().getPoint(i);
+                distance -= sqrt((node.x - x) * (node.x - x) + (node.y - y) * (node.y - y));
+                PrefetchGridsAlong(*prefetcher, x, y, node.x, node.y);
+                x = node.x;
+                y = node.y;
+            }
+        }
+        else if (player->m_movementInfo.HasMovementFlag(MOVEFLAG_MASK_XY))
+        {
+            float orientation = player->m_movementInfo.GetOrientationInMotion(player->GetOrientation());
+            float distance = player->GetSpeed(player->m_movementInfo.GetSpeedType()) * lookahead;
+            PrefetchGridsAlong(*prefetcher, x, y, x + cos(orientation) * distance, y + sin(orientation) * distance);
+        }
+    }
+}
+
+void Map::PrefetchGridsAlong(GridPrefetcher& prefetcher, float x1, float y1, float x2, float y2)
+{
+    // grids get loaded once they are in visibility range, so cover that much around the way
+    float step = GetVisibilityDistance();
+    float length = sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+    uint32 samples = uint32(length / step) + 1;
+    for (uint32 i = 1; i <= samples; ++i)
+        PrefetchGridsAround(prefetcher, x1 + (x2 - x1) * i / samples, y1 + (y2 - y1) * i / samples);
+}
+
+void Map::PrefetchGridsAround(GridPrefetcher& prefetcher, float x, float y)
+{
+    float radius = GetVisibilityDistance();
+    float minX = x - radius, minY = y - radius, maxX = x + radius, maxY = y + radius;
+    MaNGOS::NormalizeMapCoord(minX);
+    MaNGOS::NormalizeMapCoord(minY);
+    MaNGOS::NormalizeMapCoord(maxX);
+    MaNGOS::NormalizeMapCoord(maxY);
+
+    GridPair low = MaNGOS::ComputeGridPair(minX, minY).normalize();
+    GridPair high = MaNGOS::ComputeGridPair(maxX, maxY).normalize();
+    for (uint32 gridX = low.x_coord; gridX <= high.x_coord; ++gridX)
+    {
+        for (uint32 gridY = low.y_coord; gridY <= high.y_coord; ++gridY)
+        {
+            // terrain coordinates, see EnsureGridCreated
+            uint32 gx = (MAX_NUMBER_OF_GRIDS - 1) - gridX;
+            uint32 gy = (MAX_NUMBER_OF_GRIDS - 1) - gridY;
+            if (!m_bLoadedGrids[gx][gy])
+                prefetcher.Request(m_TerrainData, gx, gy);
+        }
+    }
 }
 
 Map::Map(uint32 id, time_t expiry, uint32 InstanceId)
-    : i_mapEntry(sMapStore.LookupEntry(id)),
-      i_id(id), i_InstanceId(InstanceId), m_unloadTimer(0),
+    : m_updateRegionSize(1), m_collectUpdateRegions(false), m_partitionedUpdate(false), m_updateCost(0),
+      i_mapEntry(sMapStore.LookupEntry(id)),
+      i_id(id), i_InstanceId(InstanceId), m_unloadTimer(0), m_gridPrefetchTimer(0),
       m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE), m_persistentState(nullptr),
       m_activeNonPlayersIter(m_activeNonPlayers.end()), m_onEventNotifiedIter(m_onEventNotifiedObjects.end()),
       i_gridExpiry(expiry), m_TerrainData(sTerrainMgr.LoadTerrain(id)),
@@ -165,6 +254,9 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId)
       m_variableManager(this)
 {
     m_weatherSystem = new WeatherSystem(this);
+    m_queryCache.Initialize(sWorld.getConfig(CONFIG_UINT32_QUERY_CACHE_SIZE), sWorld.getConfig(CONFIG_FLOAT_QUERY_CACHE_QUANTIZATION));
+    m_pathCache = std::make_unique<PathCache>();
+    m_pathCache->Initialize(sWorld.getConfig(CONFIG_UINT32_PATH_CACHE_SIZE), sWorld.getConfig(CONFIG_UINT32_PATH_CACHE_LIFETIME), sWorld.getConfig(CONFIG_FLOAT_PATH_CACHE_TARGET_DISTANCE));
 }
 
 void Map::Initialize(bool loadInstanceData /*= true*/)
@@ -331,6 +423,8 @@ void Map::DeleteFromWorld(Player* pl)
 
 void Map::EnsureGridCreated(const GridPair& p)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
+
     if (!getNGrid(p.x_coord, p.y_coord))
     {
         setNGrid(new NGridType(p.x_coord * MAX_NUMBER_OF_GRIDS + p.y_coord, p.x_coord, p.y_coord, i_gridExpiry, sWorld.getConfig(CONFIG_BOOL_GRID_UNLOAD)),
@@ -379,6 +473,8 @@ void Map::EnsureGridLoadedAtEnter(const Cell& cell, Player* player)
 
 bool Map::EnsureGridLoaded(const Cell& cell)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
+
     EnsureGridCreated(GridPair(cell.GridX(), cell.GridY()));
     NGridType* grid = getNGrid(cell.GridX(), cell.GridY());
 
@@ -466,6 +562,8 @@ bool Map::Add(Player* player)
 template<class T>
 void Map::Add(T* obj)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
+
     MANGOS_ASSERT(obj);
 
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
@@ -669,20 +767,243 @@ void Map::VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<MaNGOS::Obje
     {
         for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
         {
-            // marked cells are those that have been visited
-            // don't visit the same cell twice
-            uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-            if (!isCellMarked(cell_id))
-            {
-                markCell(cell_id);
-                CellPair pair(x, y);
-                Cell cell(pair);
-                cell.SetNoCreate();
-                Visit(cell, gridVisitor);
-                Visit(cell, worldVisitor);
-            }
+            CrawlCell(x, y, gridVisitor, worldVisitor);
+        }
+    }
+}
+
+void Map::CrawlCell(uint32 x, uint32 y, TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer>& gridVisitor, TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer>& worldVisitor)
+{
+    // marked cells are those that have been visited
+    // don't visit the same cell twice
+    uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
+    if (isCellMarked(cell_id))
+        return;
+
+    markCell(cell_id);
+    CellPair pair(x, y);
+    Cell cell(pair);
+    cell.SetNoCreate();
+
+    if (m_collectUpdateRegions)
+    {
+        GetUpdateRegion(x, y).cells.push_back(cell);
+        return;
+    }
+
+    Visit(cell, gridVisitor);
+    Visit(cell, worldVisitor);
+}
+
+// region of the thread updating the objects of a region, see CanRelocateInUpdateRegion
+static thread_local uint32 t_updateRegionKey = UINT32_MAX;
+
+uint32 Map::GetUpdateRegionKey(uint32 cell_x, uint32 cell_y) const
+{
+    uint32 region_x = cell_x / (MAX_NUMBER_OF_CELLS * m_updateRegionSize);
+    uint32 region_y = cell_y / (MAX_NUMBER_OF_CELLS * m_updateRegionSize);
+    return region_x * MAX_NUMBER_OF_GRIDS + region_y;
+}
+
+Map::UpdateRegion& Map::GetUpdateRegion(uint32 cell_x, uint32 cell_y)
+{
+    uint32 key = GetUpdateRegionKey(cell_x, cell_y);
+    UpdateRegion& region = m_updateRegions[key];
+    region.color = ((key / MAX_NUMBER_OF_GRIDS) & 1) | ((key % MAX_NUMBER_OF_GRIDS & 1) << 1);
+    return region;
+}
+
+bool Map::IsInUpdateRegionReach(uint32 regionKey, float x, float y) const
+{
+    CellPair p = MaNGOS::ComputeCellPair(x, y);
+    int32 regionCells = int32(MAX_NUMBER_OF_CELLS * m_updateRegionSize);
+    int32 reachCells = regionCells / 2;
+    int32 low_x = int32(regionKey / MAX_NUMBER_OF_GRIDS) * regionCells - reachCells;
+    int32 low_y = int32(regionKey % MAX_NUMBER_OF_GRIDS) * regionCells - reachCells;
+    return int32(p.x_coord) >= low_x && int32(p.x_coord) < low_x + regionCells + 2 * reachCells &&
+           int32(p.y_coord) >= low_y && int32(p.y_coord) < low_y + regionCells + 2 * reachCells;
+}
+
+bool Map::CanRelocateInUpdateRegion(float oldX, float oldY, float x, float y) const
+{
+    if (!m_partitionedUpdate)
+        return true;
+
+    CellPair oldCell = MaNGOS::ComputeCellPair(oldX, oldY);
+    CellPair newCell = MaNGOS::ComputeCellPair(x, y);
+    return GetUpdateRegionKey(oldCell.x_coord, oldCell.y_coord) == t_updateRegionKey &&
+           GetUpdateRegionKey(newCell.x_coord, newCell.y_coord) == t_updateRegionKey;
+}
+
+void Map::SelectRegionObjects(uint32 regionKey, WorldObjectUnSet& objects, std::vector<WorldObject*>& serialObjects)
+{
+    // what an object touches during its update has to be in reach of its region, objects which may touch something
+    // further away (scripts, far victims, owners or aura casters) are updated after the regions, by the map thread
+    auto inReach = [this, regionKey](WorldObject const* other)
+    {
+        return !other || IsInUpdateRegionReach(regionKey, other->GetPositionX(), other->GetPositionY());
+    };
+
+    auto isLocal = [&](WorldObject* obj)
+    {
+        if (obj->IsGameObject())
+        {
+            GameObject* go = static_cast<GameObject*>(obj);
+            return !go->GetScriptId() && inReach(go->GetOwner());
+        }
+
+        if (obj->GetTypeId() == TYPEID_DYNAMICOBJECT)
+            return inReach(static_cast<DynamicObject*>(obj)->GetCaster());
+
+        if (!obj->IsUnit())
+            return true;
+
+        if (obj->IsCreature() && static_cast<Creature*>(obj)->GetScriptId())
+            return false;
+
+        Unit* unit = static_cast<Unit*>(obj);
+        if (!inReach(unit->GetOwner()) || !inReach(unit->GetCharmer()) || !inReach(unit->GetVictim()))
+            return false;
+
+        for (HostileReference const* ref : unit->getThreatManager().getThreatList())
+            if (!inReach(ref->getTarget()))
+                return false;
+
+        for (auto const& holder : unit->GetSpellAuraHolderMap())
+        {
+            ObjectGuid casterGuid = holder.second->GetCasterGuid();
+            if (casterGuid != unit->GetObjectGuid() && !inReach(GetWorldObject(casterGuid)))
+                return false;
+        }
+        return true;
+    };
+
+    for (auto itr = objects.begin(); itr != objects.end();)
+    {
+        if (isLocal(*itr))
+            ++itr;
+        else
+        {
+            serialObjects.push_back(*itr);
+            itr = objects.erase(itr);
+        }
+    }
+}
+
+void Map::UpdateRegionObjects(uint32 regionKey, WorldObjectUnSet& objects, uint32 diff)
+{
+    t_updateRegionKey = regionKey;
+    for (WorldObject* object : objects)
+        object->Update(diff);
+    t_updateRegionKey = UINT32_MAX;
+}
+
+uint64 Map::UpdateObjectsPartitioned(WorldObjectUnSet& activeObjects, uint32 diff)
+{
+    MapUpdater& updater = *sMapMgr.GetMapUpdater();
+    WorkerBatch batch;
+
+    for (WorldObject* obj : activeObjects)
+    {
+        CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
+        GetUpdateRegion(p.x_coord, p.y_coord).objects.insert(obj);
+    }
+
+    // grid containers and objects are only read while crawling, all regions can go at once
+    for (auto& itr : m_updateRegions)
+        updater.schedule_update(new GridCrawler(*this, itr.first, itr.second.cells, itr.second.objects, itr.second.serialObjects, diff, updater, batch));
+    updater.wait_batch(batch);
+
+    // queries balance the dynamic tree lazily, do it once so they only read it while the regions run
+    m_dyn_tree.balance();
+
+    // regions of one color are one region apart, so the objects updated at the same time never reach the same things
+    uint64 count = 0;
+    for (uint32 color = 0; color < 4; ++color)
+    {
+        m_partitionedUpdate = true;
+        for (auto& itr : m_updateRegions)
+        {
+            if (itr.second.color != color || itr.second.objects.empty())
+                continue;
+
+            count += itr.second.objects.size();
+            updater.schedule_update(new ObjectUpdateWorker(*this, itr.first, itr.second.objects, diff, updater, batch));
+        }
+        updater.wait_batch(batch);
+        m_partitionedUpdate = false;
+
+        // relocations out of their region and other actions deferred by the regions
+        GetMessager().Execute(this);
+    }
+
+    for (auto& itr : m_updateRegions)
+    {
+        for (WorldObject* obj : itr.second.serialObjects)
+        {
+            obj->Update(diff);
+            ++count;
+        }
+    }
+
+    m_updateRegions.clear();
+    return count;
+}
+
+void Map::ExecuteOrDefer(std::function<void(Map*)> const& action)
+{
+    if (m_partitionedUpdate)
+        GetMessager().AddMessage(action);
+    else
+        action(this);
+}
+
+void Map::QueuePathRequest(PathFinder* path)
+{
+    PartitionGuard guard = GuardPartitionedUpdate();
+    m_pathRequests.push_back(path);
+}
+
+void Map::CancelPathRequest(PathFinder* path)
+{
+    PartitionGuard guard = GuardPartitionedUpdate();
+    auto itr = std::find(m_pathRequests.begin(), m_pathRequests.end(), path);
+    if (itr == m_pathRequests.end())
+        return;
+
+    *itr = m_pathRequests.back();
+    m_pathRequests.pop_back();
+}
+
+void Map::ProcessPathRequests()
+{
+    if (m_pathRequests.empty())
+        return;
+
+    // no object is updated meanwhile, so the paths can read their units and the map geometry
+    MapUpdater* updater = sMapMgr.GetMapUpdater();
+    size_t const pathsPerWorker = 4;
+    if (updater && m_pathRequests.size() > pathsPerWorker)
+    {
+        // height and line of sight queries of the path normalization balance the dynamic tree lazily,
+        // do it once here so the workers only read it
+        m_dyn_tree.balance();
+
+        WorkerBatch batch;
+        for (size_t first = 0; first < m_pathRequests.size(); first += pathsPerWorker)
+        {
+            size_t last = std::min(first + pathsPerWorker, m_pathRequests.size());
+            updater->schedule_update(new PathRequestWorker(m_pathRequests.begin() + first, m_pathRequests.begin() + last, *updater, batch));
         }
+        updater->wait_batch(batch);
     }
+    else
+    {
+        for (PathFinder* path : m_pathRequests)
+            path->ExecuteAsync();
+    }
+
+    m_pathRequests.clear();
 }
 
 void Map::Update(const uint32& t_diff)
@@ -713,6 +1034,14 @@ void Map::Update(const uint32& t_diff)
     /// update active cells around players and active objects
     resetMarkedCells();
 
+    // split the marked cells into regions which are crawled and updated by the map update threads
+    // instances are too small to be worth it and their instance scripts expect a single updating thread
+    m_collectUpdateRegions = sWorld.getConfig(CONFIG_BOOL_MAP_UPDATE_PARTITIONED) && !Instanceable() && sMapMgr.GetMapUpdater();
+    // grid searches are capped at MAX_VISIBILITY_DISTANCE, regions are twice as big, so what the objects of two
+    // running regions (one region apart) can reach never overlaps
+    if (m_collectUpdateRegions)
+        m_updateRegionSize = 2 * uint32(ceil(MAX_VISIBILITY_DISTANCE / SIZE_OF_GRIDS));
+
     WorldObjectUnSet objToUpdate;
     MaNGOS::ObjectUpdater obj_updater(objToUpdate, t_diff);
     TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(obj_updater);    // For creature
@@ -754,6 +1083,14 @@ void Map::Update(const uint32& t_diff)
 #endif
     }
 
+    if (m_gridPrefetchTimer <= t_diff)
+    {
+        m_gridPrefetchTimer = GRID_PREFETCH_INTERVAL;
+        PrefetchGrids();
+    }
+    else
+        m_gridPrefetchTimer -= t_diff;
+
 #ifdef ENABLE_PLAYERBOTS
     // Calculate the active zones every 10 seconds (An active zone is a zone where one or more real players are)
     constexpr uint32 maxActiveZonesTimer = 10000U;
@@ -968,37 +1305,36 @@ void Map::Update(const uint32& t_diff)
             CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), GetVisibilityDistance());
 
             for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
-            {
                 for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
-                {
-                    // marked cells are those that have been visited
-                    // don't visit the same cell twice
-                    uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-                    if (!isCellMarked(cell_id))
-                    {
-                        markCell(cell_id);
-                        CellPair pair(x, y);
-                        Cell cell(pair);
-                        cell.SetNoCreate();
-                        Visit(cell, grid_object_update);
-                        Visit(cell, world_object_update);
-                    }
-                }
-            }
+                    CrawlCell(x, y, grid_object_update, world_object_update);
         }
     }
 
     // update all objects
-    for (auto wObj : objToUpdate)
+    if (m_collectUpdateRegions)
     {
-        wObj->Update(t_diff);
-        ++count;
+        m_collectUpdateRegions = false;
+        count = UpdateObjectsPartitioned(objToUpdate, t_diff);
+    }
+    else
+    {
+        for (auto wObj : objToUpdate)
+        {
+            wObj->Update(t_diff);
+            ++count;
+        }
     }
 
 #ifdef BUILD_METRICS
     meas.add_field("count", std::to_string(static_cast<int32>(count)));
 #endif
 
+    // paths requested by the object updates, their movement generators pick them up next tick
+    ProcessPathRequests();
+
+    // visibility of units moved during this tick
+    UpdateRelocatedUnitsVisibility();
+
     // Send world objects and item update field changes
     SendObjectUpdates();
 
@@ -1082,6 +1418,8 @@ void Map::Remove(Player* player, bool remove)
 template<class T>
 void Map::Remove(T* obj, bool remove)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
+
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
     if (p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
     {
@@ -1161,6 +1499,17 @@ void Map::PlayerRelocation(Player* player, float x, float y, float z, float orie
 
 void Map::CreatureRelocation(Creature* creature, float x, float y, float z, float ang)
 {
+    if (!CanRelocateInUpdateRegion(creature->GetPositionX(), creature->GetPositionY(), x, y))
+    {
+        ObjectGuid guid = creature->GetObjectGuid();
+        ExecuteOrDefer([guid, x, y, z, ang](Map* map)
+        {
+            if (Creature* creature = map->GetAnyTypeCreature(guid))
+                map->CreatureRelocation(creature, x, y, z, ang);
+        });
+        return;
+    }
+
     Cell new_cell(MaNGOS::ComputeCellPair(x, y));
 
     // do move or do move to respawn or remove creature if previous all fail
@@ -1181,6 +1530,17 @@ void Map::CreatureRelocation(Creature* creature, float x, float y, float z, floa
 
 void Map::GameObjectRelocation(GameObject* go, float x, float y, float z, float orientation, bool respawnRelocationOnFail)
 {
+    if (!CanRelocateInUpdateRegion(go->GetPositionX(), go->GetPositionY(), x, y))
+    {
+        ObjectGuid guid = go->GetObjectGuid();
+        ExecuteOrDefer([guid, x, y, z, orientation, respawnRelocationOnFail](Map* map)
+        {
+            if (GameObject* go = map->GetGameObject(guid))
+                map->GameObjectRelocation(go, x, y, z, orientation, respawnRelocationOnFail);
+        });
+        return;
+    }
+
     Cell new_cell(MaNGOS::ComputeCellPair(x, y));
     Cell old_cell = go->GetCurrentCell();
 
@@ -1214,6 +1574,8 @@ void Map::GameObjectRelocation(GameObject* go, float x, float y, float z, float
 
 bool Map::CreatureCellRelocation(Creature* c, const Cell& new_cell)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
+
     Cell const& old_cell = c->GetCurrentCell();
     if (old_cell.DiffGrid(new_cell))
     {
@@ -1307,6 +1669,9 @@ bool Map::UnloadGrid(const uint32& x, const uint32& y, bool pForce)
     {
         m_bLoadedGrids[gx][gy] = false;
         m_TerrainData->Unload(gx, gy);
+        InvalidateGridQueryCache(gx, gy);
+        // corridors may cross the grid, their navmesh tiles can go away with it
+        m_pathCache->Clear();
     }
 
     DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Unloading grid[%u,%u] for map %u finished", x, y, i_id);
@@ -1346,6 +1711,143 @@ void Map::UpdateObjectVisibility(WorldObject* obj, Cell cell, const CellPair& ce
     }
 }
 
+void Map::AddRelocatedUnit(Unit* unit)
+{
+    PartitionGuard guard = GuardPartitionedUpdate();
+    m_relocatedUnits.push_back(unit->GetObjectGuid());
+}
+
+void Map::UpdateRelocatedUnitsVisibility()
+{
+    m_relocationVisibilityStats = RelocationVisibilityStats();
+    if (m_relocatedUnits.empty())
+        return;
+
+    RelocationVisibilityStats& stats = m_relocationVisibilityStats;
+    stats.relocations = m_relocatedUnits.size();
+
+    // a unit relocated several times during the tick is only updated at its final position
+    std::sort(m_relocatedUnits.begin(), m_relocatedUnits.end());
+    m_relocatedUnits.erase(std::unique(m_relocatedUnits.begin(), m_relocatedUnits.end()), m_relocatedUnits.end());
+
+    struct RelocatedUnit
+    {
+        Unit* unit;
+        uint32 cellId;
+    };
+    std::vector<RelocatedUnit> units;
+    units.reserve(m_relocatedUnits.size());
+    for (ObjectGuid guid : m_relocatedUnits)
+    {
+        Unit* unit = GetUnit(guid);
+        if (!unit || !unit->IsInWorld() || !unit->IsPositionValid())
+            continue;
+
+        CellPair p = MaNGOS::ComputeCellPair(unit->GetPositionX(), unit->GetPositionY());
+        units.push_back({ unit, p.y_coord * TOTAL_NUMBER_OF_CELLS_PER_MAP + p.x_coord });
+    }
+    m_relocatedUnits.clear();
+    stats.units = units.size();
+
+    // moved viewers first, their full update covers every moved unit within their own visibility distance
+    std::vector<Player const*> updatedViewers;
+    for (RelocatedUnit const& relocated : units)
+    {
+        relocated.unit->GetViewPoint().Call_UpdateVisibilityForOwner();
+
+        if (relocated.unit->GetTypeId() == TYPEID_PLAYER && static_cast<Player*>(relocated.unit)->GetCamera().GetBody() == relocated.unit)
+            updatedViewers.push_back(static_cast<Player*>(relocated.unit));
+    }
+    std::sort(updatedViewers.begin(), updatedViewers.end());
+    stats.viewerUpdates = updatedViewers.size();
+
+    // then the moved units for all other cameras, with one camera search per cell instead of one per unit
+    std::sort(units.begin(), units.end(), [](RelocatedUnit const& a, RelocatedUnit const& b) { return a.cellId < b.cellId; });
+
+    std::vector<Camera*> cameras;
+    WorldObjectSet visibleNow;
+    for (auto first = units.begin(); first != units.end();)
+    {
+        float radius = 0.0f;
+        auto last = first;
+        for (; last != units.end() && last->cellId == first->cellId; ++last)
+            radius = std::max(radius, last->unit->GetVisibilityData().GetVisibilityDistance());
+
+        // every unit of the cell is at most a cell diagonal away from the first one
+        Unit* center = first->unit;
+        CellPair p = MaNGOS::ComputeCellPair(center->GetPositionX(), center->GetPositionY());
+        Cell cell(p);
+        cell.SetNoCreate();
+
+        cameras.clear();
+        MaNGOS::CameraCollector collector(cameras);
+        TypeContainerVisitor<MaNGOS::CameraCollector, WorldTypeMapContainer> camera_collector(collector);
+        cell.Visit(p, camera_collector, *this, *center, radius + SIZE_OF_GRID_CELL * 1.5f);
+        ++stats.cellVisits;
+
+        for (auto itr = first; itr != last; ++itr)
+        {
+            WorldObject* unit = itr->unit;
+            float distance = unit->GetVisibilityData().GetVisibilityDistance();
+            GuidSet unvisited = unit->GetClientGuidsIAmAt();
+
+            for (Camera* camera : cameras)
+            {
+                Player* owner = camera->GetOwner();
+                unvisited.erase(owner->GetObjectGuid());
+
+                if (camera->GetBody() == owner && distance <= owner->GetVisibilityData().GetVisibilityDistance() &&
+                        std::binary_search(updatedViewers.begin(), updatedViewers.end(), owner))
+                {
+                    ++stats.skippedChecks;
+                    continue;
+                }
+
+                owner->UpdateVisibilityOf(camera->GetBody(), unit, m_visibilityUpdateData.Get(owner), visibleNow);
+            }
+
+            for (auto guid : unvisited)
+            {
+                if (Player* player = GetPlayer(guid))
+                {
+#ifdef ENABLE_PLAYERBOTS
+                    if (sPlayerbotAIConfig.disableBotOptimizations || player->isRealPlayer())
+#endif
+                    player->UpdateVisibilityOf(player->GetCamera().GetBody(), unit, m_visibilityUpdateData.Get(player), visibleNow);
+                }
+            }
+        }
+
+        first = last;
+    }
+
+    // create and out of range blocks of the whole batch go out together per player
+    for (auto& update_player : m_visibilityUpdateData)
+    {
+        if (!update_player.data.HasData())
+            continue;
+
+        for (size_t i = 0; i < update_player.data.GetPacketCount(); ++i)
+        {
+            WorldPacket packet = update_player.data.BuildPacket(i);
+            update_player.player->GetSession()->SendPacket(packet);
+        }
+    }
+    m_visibilityUpdateData.Clear();
+
+#ifdef BUILD_METRICS
+    metric::measurement meas("map.visibility", {
+        { "map_id", std::to_string(i_id) },
+        { "instance_id", std::to_string(i_InstanceId) }
+    });
+    meas.add_field("relocations", std::to_string(stats.relocations));
+    meas.add_field("units", std::to_string(stats.units));
+    meas.add_field("viewer_updates", std::to_string(stats.viewerUpdates));
+    meas.add_field("cell_visits", std::to_string(stats.cellVisits));
+    meas.add_field("skipped_checks", std::to_string(stats.skippedChecks));
+#endif
+}
+
 void Map::SendInitSelf(Player* player) const
 {
     DETAIL_LOG("Creating player data for himself %u", player->GetGUIDLow());
@@ -1457,6 +1959,8 @@ inline void Map::setNGrid(NGridType* grid, uint32 x, uint32 y)
 
 void Map::AddObjectToRemoveList(WorldObject* obj)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
+
     MANGOS_ASSERT(obj->GetMapId() == GetId() && obj->GetInstanceId() == GetInstanceId());
 
     obj->CleanupsBeforeDelete();                            // remove or simplify at least cross referenced links
@@ -1574,6 +2078,8 @@ bool Map::ActiveObjectsNearGrid(uint32 x, uint32 y) const
 
 void Map::AddToActive(WorldObject* obj)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
+
     m_activeNonPlayers.insert(obj);
     Cell cell = Cell(MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY()));
     EnsureGridLoaded(cell);
@@ -1602,6 +2108,8 @@ void Map::AddToActive(WorldObject* obj)
 
 void Map::RemoveFromActive(WorldObject* obj)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
+
     // Map::Update for active object in proccess
     if (m_activeNonPlayersIter != m_activeNonPlayers.end())
     {
@@ -2163,6 +2671,8 @@ bool Map::ScriptsStart(ScriptMapType scriptType, uint32 id, Object* source, Obje
 {
     MANGOS_ASSERT(source);
 
+    PartitionGuard guard = GuardPartitionedUpdate();
+
     ///- Find the script map
     auto scriptMapMap = GetMapDataContainer().GetScriptMap(scriptType);
     ScriptMapMap::const_iterator scriptInfoMapMapItr = scriptMapMap->second.find(id);
@@ -2222,6 +2732,8 @@ void Map::ScriptCommandStart(ScriptInfo const& script, uint32 delay, Object* sou
 {
     // NOTE: script record _must_ exist until command executed
 
+    PartitionGuard guard = GuardPartitionedUpdate();
+
     // prepare static data
     ObjectGuid sourceGuid = source->GetObjectGuid();
     ObjectGuid targetGuid = target ? target->GetObjectGuid() : ObjectGuid();
@@ -2293,6 +2805,7 @@ Player* Map::GetPlayer(ObjectGuid guid)
  */
 Creature* Map::GetCreature(ObjectGuid guid)
 {
+    PartitionLookupGuard guard = GuardPartitionedLookup();
     return m_objectsStore.find<Creature>(guid, (Creature*)nullptr);
 }
 
@@ -2303,6 +2816,7 @@ Creature* Map::GetCreature(ObjectGuid guid)
  */
 Pet* Map::GetPet(ObjectGuid guid)
 {
+    PartitionLookupGuard guard = GuardPartitionedLookup();
     return m_objectsStore.find<Pet>(guid, (Pet*)nullptr);
 }
 
@@ -2343,6 +2857,7 @@ Creature* Map::GetAnyTypeCreature(ObjectGuid guid)
  */
 GameObject* Map::GetGameObject(ObjectGuid guid)
 {
+    PartitionLookupGuard guard = GuardPartitionedLookup();
     return m_objectsStore.find<GameObject>(guid, (GameObject*)nullptr);
 }
 
@@ -2353,6 +2868,7 @@ GameObject* Map::GetGameObject(ObjectGuid guid)
  */
 DynamicObject* Map::GetDynamicObject(ObjectGuid guid)
 {
+    PartitionLookupGuard guard = GuardPartitionedLookup();
     return m_objectsStore.find<DynamicObject>(guid, (DynamicObject*)nullptr);
 }
 
@@ -2398,29 +2914,77 @@ WorldObject* Map::GetWorldObject(ObjectGuid guid)
     return nullptr;
 }
 
-void Map::SendObjectUpdates()
+bool Map::IsQueuedForClientUpdate(Object const* obj) const
 {
-    UpdateDataMapType update_players;
+    // the slot may also point into the queue of another map, e.g. for items of a player changing maps
+    uint32 slot = obj->m_clientUpdateSlot;
+    return slot < i_objectsToClientUpdate.size() && i_objectsToClientUpdate[slot] == obj;
+}
 
-    while (!i_objectsToClientUpdate.empty())
+void Map::AddUpdateObject(Object* obj)
+{
+    PartitionGuard guard = GuardPartitionedUpdate();
+    if (IsQueuedForClientUpdate(obj))
+        return;
+
+    obj->m_clientUpdateSlot = uint32(i_objectsToClientUpdate.size());
+    i_objectsToClientUpdate.push_back(obj);
+}
+
+void Map::RemoveUpdateObject(Object* obj)
+{
+    PartitionGuard guard = GuardPartitionedUpdate();
+    if (!IsQueuedForClientUpdate(obj))
+        return;
+
+    i_objectsToClientUpdate[obj->m_clientUpdateSlot] = nullptr;
+    obj->m_clientUpdateSlot = Object::CLIENT_UPDATE_NOT_QUEUED;
+}
+
+void Map::SendObjectUpdates()
+{
+    // objects queued while building are appended and sent as well
+    for (size_t i = 0; i < i_objectsToClientUpdate.size(); ++i)
     {
-        Object* obj = *i_objectsToClientUpdate.begin();
-        i_objectsToClientUpdate.erase(i_objectsToClientUpdate.begin());
-        obj->BuildUpdateData(update_players);
+        Object* obj = i_objectsToClientUpdate[i];
+        if (!obj || obj->m_clientUpdateSlot != i)           // removed, or queued again by another map since
+            continue;
+
+        obj->m_clientUpdateSlot = Object::CLIENT_UPDATE_NOT_QUEUED;
+        obj->BuildUpdateData(m_clientUpdateData);
     }
+    i_objectsToClientUpdate.clear();
+
+    // packet build, compression and socket enqueue only touch the receiving player's data and session
+    MapUpdater* updater = sMapMgr.GetMapUpdater();
+#if defined(BUILD_DEPRECATED_PLAYERBOT) || defined(ENABLE_PLAYERBOTS)
+    // bot packet hooks in WorldSession::SendPacket are not safe to run from several threads
+    updater = nullptr;
+#endif
 
-    for (auto& update_player : update_players)
+    size_t const playersPerWorker = 16;
+    if (updater && m_clientUpdateData.size() > playersPerWorker)
     {
-        for (size_t i = 0; i < update_player.second.GetPacketCount(); ++i)
+        WorkerBatch batch;
+        for (size_t first = 0; first < m_clientUpdateData.size(); first += playersPerWorker)
         {
-            WorldPacket packet = update_player.second.BuildPacket(i);
-            update_player.first->GetSession()->SendPacket(packet);
+            size_t last = std::min(first + playersPerWorker, m_clientUpdateData.size());
+            updater->schedule_update(new UpdatePacketWorker(m_clientUpdateData.begin() + first, m_clientUpdateData.begin() + last, *updater, batch));
         }
+        updater->wait_batch(batch);
+    }
+    else
+    {
+        for (auto& update_player : m_clientUpdateData)
+            update_player.data.SendData(*update_player.player->GetSession());
     }
+
+    m_clientUpdateData.Clear();
 }
 
 Creature* Map::GetCreature(uint32 dbguid) const
 {
+    PartitionLookupGuard guard = GuardPartitionedLookup();
     auto itr = m_dbGuidObjects.find(std::make_pair(HIGHGUID_UNIT, dbguid));
     if (itr == m_dbGuidObjects.end())
         return nullptr;
@@ -2438,6 +3002,7 @@ Creature* Map::GetCreature(uint32 dbguid) const
 
 GameObject* Map::GetGameObject(uint32 dbguid) const
 {
+    PartitionLookupGuard guard = GuardPartitionedLookup();
     auto itr = m_dbGuidObjects.find(std::make_pair(HIGHGUID_GAMEOBJECT, dbguid));
     if (itr == m_dbGuidObjects.end())
         return nullptr;
@@ -2465,6 +3030,7 @@ std::vector<GameObject*> const* Map::GetGameObjects(std::string stringId) const
 
 std::vector<WorldObject*> const* Map::GetWorldObjects(uint32 stringId) const
 {
+    PartitionLookupGuard guard = GuardPartitionedLookup();
     auto itr = m_objectsPerStringId.find(stringId);
     if (itr == m_objectsPerStringId.end())
         return nullptr;
@@ -2474,6 +3040,7 @@ std::vector<WorldObject*> const* Map::GetWorldObjects(uint32 stringId) const
 
 std::vector<Creature*> const* Map::GetCreatures(uint32 stringId) const
 {
+    PartitionLookupGuard guard = GuardPartitionedLookup();
     auto itr = m_objectsPerStringId.find(stringId);
     if (itr == m_objectsPerStringId.end())
         return nullptr;
@@ -2483,6 +3050,7 @@ std::vector<Creature*> const* Map::GetCreatures(uint32 stringId) const
 
 std::vector<GameObject*> const* Map::GetGameObjects(uint32 stringId) const
 {
+    PartitionLookupGuard guard = GuardPartitionedLookup();
     auto itr = m_objectsPerStringId.find(stringId);
     if (itr == m_objectsPerStringId.end())
         return nullptr;
@@ -2510,17 +3078,20 @@ GameObject* Map::GetGameObject(std::string stringId) const
 
 void Map::AddDbGuidObject(WorldObject* obj)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
     m_dbGuidObjects[std::make_pair(HighGuid(obj->GetParentHigh()), obj->GetDbGuid())].push_back(obj);
 }
 
 void Map::RemoveDbGuidObject(WorldObject* obj)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
     auto& vec = m_dbGuidObjects[std::make_pair(HighGuid(obj->GetParentHigh()), obj->GetDbGuid())];
     vec.erase(std::remove(vec.begin(), vec.end(), obj), vec.end());
 }
 
 void Map::AddStringIdObject(uint32 stringId, WorldObject* obj)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
     auto& data = m_objectsPerStringId[stringId];
     data.worldObjects.push_back(obj);
     if (obj->IsCreature())
@@ -2531,6 +3102,7 @@ void Map::AddStringIdObject(uint32 stringId, WorldObject* obj)
 
 void Map::RemoveStringIdObject(uint32 stringId, WorldObject* obj)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
     auto& data = m_objectsPerStringId[stringId];
     data.worldObjects.erase(std::remove(data.worldObjects.begin(), data.worldObjects.end(), obj), data.worldObjects.end());
     if (obj->IsCreature())
@@ -2541,6 +3113,7 @@ void Map::RemoveStringIdObject(uint32 stringId, WorldObject* obj)
 
 uint32 Map::GenerateLocalLowGuid(HighGuid guidhigh)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
     // TODO: for map local guid counters possible force reload map instead shutdown server at guid counter overflow
     switch (guidhigh)
     {
@@ -2663,8 +3236,25 @@ void Map::PlayDirectSoundToMap(uint32 soundId, uint32 zoneId /*=0*/) const
  */
 bool Map::IsInLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, bool ignoreM2Model) const
 {
-    return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ, ignoreM2Model)
-           && m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, ignoreM2Model);
+    MapQueryCache::Key key;
+    float cached;
+    if (m_queryCache.IsEnabled())
+    {
+        key = m_queryCache.LineOfSightKey(srcX, srcY, srcZ, destX, destY, destZ, ignoreM2Model);
+        if (m_queryCache.Find(key, cached))
+            return cached != 0.0f;
+    }
+
+    bool result = VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ, ignoreM2Model);
+    if (result)
+    {
+        PartitionLookupGuard guard = GuardPartitionedLookup();
+        result = m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, ignoreM2Model);
+    }
+
+    if (m_queryCache.IsEnabled())
+        m_queryCache.Store(key, result ? 1.0f : 0.0f);
+    return result;
 }
 
 /**
@@ -2684,6 +3274,7 @@ bool Map::GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float
         destZ = tempZ;
     }
     // at second all dynamic objects, if static check has an hit, then we can calculate only to this closer point
+    PartitionLookupGuard guard = GuardPartitionedLookup();
     bool result1 = m_dyn_tree.getObjectHitPos(srcX, srcY, srcZ, destX, destY, destZ, tempX, tempY, tempZ, modifyDist);
     if (result1)
     {
@@ -2747,31 +3338,65 @@ bool Map::GetHeightInRange(float x, float y, float& z, float maxSearchDist /*= 4
             return false;
     }
 
+    PartitionLookupGuard guard = GuardPartitionedLookup();
     z = std::max<float>(height, m_dyn_tree.getHeight(x, y, height + 1.0f, maxSearchDist));
     return true;
 }
 
 float Map::GetHeight(float x, float y, float z, bool swim) const
 {
+    MapQueryCache::Key key;
+    float cached;
+    if (m_queryCache.IsEnabled())
+    {
+        key = m_queryCache.HeightKey(x, y, z, swim);
+        if (m_queryCache.Find(key, cached))
+            return cached;
+    }
+
     float staticHeight = m_TerrainData->GetHeightStatic(x, y, z, true, (swim ? DEFAULT_WATER_SEARCH : DEFAULT_HEIGHT_SEARCH));
 
     // Get Dynamic Height around static Height (if valid)
     float dynSearchHeight = 2.0f + (z < staticHeight ? staticHeight : z);
-    return std::max<float>(staticHeight, m_dyn_tree.getHeight(x, y, dynSearchHeight, dynSearchHeight - staticHeight));
+    float height;
+    {
+        PartitionLookupGuard guard = GuardPartitionedLookup();
+        height = std::max<float>(staticHeight, m_dyn_tree.getHeight(x, y, dynSearchHeight, dynSearchHeight - staticHeight));
+    }
+
+    if (m_queryCache.IsEnabled())
+        m_queryCache.Store(key, height);
+    return height;
 }
 
 void Map::InsertGameObjectModel(const GameObjectModel& mdl)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
     m_dyn_tree.insert(mdl);
+    // queries of the other regions must find the tree balanced, they only read it
+    if (m_partitionedUpdate)
+        m_dyn_tree.balance();
+    InvalidateQueryCache(mdl);
 }
 
 void Map::RemoveGameObjectModel(const GameObjectModel& mdl)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
     m_dyn_tree.remove(mdl);
+    if (m_partitionedUpdate)
+        m_dyn_tree.balance();
+    InvalidateQueryCache(mdl);
+}
+
+void Map::InvalidateQueryCache(const GameObjectModel& mdl)
+{
+    G3D::AABox const& bounds = mdl.getBounds();
+    m_queryCache.Invalidate(bounds.low().x, bounds.low().y, bounds.high().x, bounds.high().y);
 }
 
 bool Map::ContainsGameObjectModel(const GameObjectModel& mdl) const
 {
+    PartitionLookupGuard guard = GuardPartitionedLookup();
     return m_dyn_tree.contains(mdl);
 }
 
@@ -2983,15 +3608,19 @@ void Map::OnEventHappened(uint16 event_id, bool activate, bool resume)
 
 uint32 Map::SpawnedCountForEntry(uint32 entry)
 {
-    return m_spawnedCount[entry].size();
+    PartitionLookupGuard guard = GuardPartitionedLookup();
+    auto itr = m_spawnedCount.find(entry);
+    return itr != m_spawnedCount.end() ? itr->second.size() : 0;
 }
 
 void Map::AddToSpawnCount(const ObjectGuid& guid)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
     m_spawnedCount[guid.GetEntry()].insert(guid);
 }
 
 void Map::RemoveFromSpawnCount(const ObjectGuid& guid)
 {
+    PartitionGuard guard = GuardPartitionedUpdate();
     m_spawnedCount[guid.GetEntry()].erase(guid);
 }
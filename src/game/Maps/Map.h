@@ -38,12 +38,18 @@
 #include "Globals/GraveyardManager.h"
 #include "Maps/SpawnManager.h"
 #include "Maps/MapDataContainer.h"
+#include "Maps/MapQueryCache.h"
 #include "Util/UniqueTrackablePtr.h"
 #include "World/WorldStateVariableManager.h"
 
+#include <atomic>
 #include <bitset>
+#include <memory>
 #include <functional>
 #include <list>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 
 struct CreatureInfo;
 class Creature;
@@ -55,15 +61,66 @@ class MapPersistentState;
 class WorldPersistentState;
 class DungeonPersistentState;
 class BattleGroundPersistentState;
+class PathCache;
 struct ScriptInfo;
 class BattleGround;
 class GridMap;
 class GameObjectModel;
 class WeatherSystem;
 class GenericTransport;
+class GridPrefetcher;
+class PathFinder;
 namespace MaNGOS { struct ObjectUpdater; }
 class Transport;
 
+// Guards the map wide data during the partitioned update. Changes are exclusive and may nest (Map::Add activates,
+// relocates, ...), lookups are shared and may also be done by the thread doing a change.
+class PartitionMutex
+{
+    public:
+        void lock()
+        {
+            if (m_owner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+            {
+                ++m_depth;
+                return;
+            }
+            m_mutex.lock();
+            m_owner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+            m_depth = 1;
+        }
+
+        void unlock()
+        {
+            if (--m_depth > 0)
+                return;
+            m_owner.store(std::thread::id(), std::memory_order_relaxed);
+            m_mutex.unlock();
+        }
+
+        // lookups never change anything, so a thread holding the shared lock never asks for the exclusive one
+        void lock_shared()
+        {
+            if (m_owner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+                ++m_depth;
+            else
+                m_mutex.lock_shared();
+        }
+
+        void unlock_shared()
+        {
+            if (m_owner.load(std::memory_order_relaxed) == std::this_thread::get_id())
+                --m_depth;
+            else
+                m_mutex.unlock_shared();
+        }
+
+    private:
+        std::shared_mutex m_mutex;
+        std::atomic<std::thread::id> m_owner;
+        uint32 m_depth = 0;
+};
+
 // GCC have alternative #pragma pack(N) syntax and old gcc version not support pack(push,N), also any gcc version not support it at some platform
 #if defined( __GNUC__ )
 #pragma pack(1)
@@ -100,6 +157,7 @@ struct WorldTemplate
 #endif
 
 #define MIN_UNLOAD_DELAY      1                             // immediate unload
+#define GRID_PREFETCH_INTERVAL 1000                         // how often maps look for grids players are heading to
 
 class Map : public GridRefManager<NGridType>
 {
@@ -284,15 +342,22 @@ class Map : public GridRefManager<NGridType>
         std::map<uint32, uint32>& GetTempCreatures() { return m_tempCreatures; }
         std::map<uint32, uint32>& GetTempPets() { return m_tempPets; }
 
-        void AddUpdateObject(Object* obj)
-        {
-            i_objectsToClientUpdate.insert(obj);
-        }
+        void AddUpdateObject(Object* obj);
+        void RemoveUpdateObject(Object* obj);
+
+        // units that passed the relocation limit, their visibility is updated together once per tick
+        void AddRelocatedUnit(Unit* unit);
 
-        void RemoveUpdateObject(Object* obj)
+        // work done by the last relocation visibility batch
+        struct RelocationVisibilityStats
         {
-            i_objectsToClientUpdate.erase(obj);
-        }
+            uint32 relocations = 0;                         // relocations reported during the tick
+            uint32 units = 0;                               // distinct units updated
+            uint32 viewerUpdates = 0;                       // full visibility updates of moved viewers
+            uint32 cellVisits = 0;                          // camera searches, one per cell holding moved units
+            uint32 skippedChecks = 0;                       // camera checks already covered by a viewer update
+        };
+        RelocationVisibilityStats const& GetRelocationVisibilityStats() const { return m_relocationVisibilityStats; }
 
         // DynObjects currently
         uint32 GenerateLocalLowGuid(HighGuid guidhigh);
@@ -318,6 +383,8 @@ class Map : public GridRefManager<NGridType>
         void InsertGameObjectModel(const GameObjectModel& mdl);
         void RemoveGameObjectModel(const GameObjectModel& mdl);
         bool ContainsGameObjectModel(const GameObjectModel& mdl) const;
+        // drops cached line of sight and height results around a model that was moved or toggled
+        void InvalidateQueryCache(const GameObjectModel& mdl);
 
         // Get Holder for Creature Linking
         CreatureLinkingHolder* GetCreatureLinkingHolder() { return &m_creatureLinkingHolder; }
@@ -357,6 +424,24 @@ class Map : public GridRefManager<NGridType>
 
         Messager<Map>& GetMessager() { return m_messager; }
 
+        // duration of the last Update() in microseconds, used to schedule expensive maps first
+        uint32 GetUpdateCost() const { return m_updateCost; }
+        void SetUpdateCost(uint32 cost) { m_updateCost = cost; }
+
+        // paths queued by PathFinder::calculateAsync, calculated on the map update threads after the objects are updated
+        void QueuePathRequest(PathFinder* path);
+        void CancelPathRequest(PathFinder* path);
+        // poly corridors shared by the path finders of the map
+        PathCache& GetPathCache() { return *m_pathCache; }
+
+        // map objects are updated by several threads at once (see MapUpdate.Partitioned)
+        bool IsInPartitionedUpdate() const { return m_partitionedUpdate; }
+        // runs action at once or, while the map objects are updated in parallel, once the running regions are done
+        void ExecuteOrDefer(std::function<void(Map*)> const& action);
+        // partitioned update, called by the map update threads for one region
+        void SelectRegionObjects(uint32 regionKey, WorldObjectUnSet& objects, std::vector<WorldObject*>& serialObjects);
+        void UpdateRegionObjects(uint32 regionKey, WorldObjectUnSet& objects, uint32 diff);
+
         typedef std::set<Transport*> TransportSet;
         GenericTransport* GetTransport(ObjectGuid guid);
         TransportSet const& GetTransports() { return m_transports; }
@@ -388,6 +473,12 @@ class Map : public GridRefManager<NGridType>
 
     private:
         void LoadMapAndVMap(int gx, int gy);
+        void InvalidateGridQueryCache(int gx, int gy);
+
+        // queues the grids players are moving towards for loading by the GridPrefetcher
+        void PrefetchGrids();
+        void PrefetchGridsAlong(GridPrefetcher& prefetcher, float x1, float y1, float x2, float y2);
+        void PrefetchGridsAround(GridPrefetcher& prefetcher, float x, float y);
 
         void SetTimer(uint32 t) { i_gridExpiry = t < MIN_GRID_DELAY ? MIN_GRID_DELAY : t; }
 
@@ -420,7 +511,49 @@ class Map : public GridRefManager<NGridType>
         void ScriptsProcess();
 
         void SendObjectUpdates();
-        std::set<Object*> i_objectsToClientUpdate;
+        bool IsQueuedForClientUpdate(Object const* obj) const;
+        std::vector<Object*> i_objectsToClientUpdate;       // in queue order, removed objects leave a nullptr
+        UpdateDataMapType m_clientUpdateData;               // reused every tick by SendObjectUpdates
+
+        void UpdateRelocatedUnitsVisibility();
+        std::vector<ObjectGuid> m_relocatedUnits;
+        UpdateDataMapType m_visibilityUpdateData;           // create/out of range blocks of one relocation batch
+        RelocationVisibilityStats m_relocationVisibilityStats;
+
+        // partitioned update - marked cells are grouped by regions of grids and updated on the map update threads
+        struct UpdateRegion
+        {
+            uint32 color;                                   // regions of the same color never touch each other
+            std::vector<Cell> cells;
+            WorldObjectUnSet objects;
+            std::vector<WorldObject*> serialObjects;        // may reach beyond the region, updated after all regions
+        };
+        typedef std::unordered_map<uint32, UpdateRegion> UpdateRegionMap;
+
+        typedef std::unique_lock<PartitionMutex> PartitionGuard;
+        PartitionGuard GuardPartitionedUpdate() const { return m_partitionedUpdate ? PartitionGuard(m_partitionLock) : PartitionGuard(); }
+        typedef std::shared_lock<PartitionMutex> PartitionLookupGuard;
+        PartitionLookupGuard GuardPartitionedLookup() const { return m_partitionedUpdate ? PartitionLookupGuard(m_partitionLock) : PartitionLookupGuard(); }
+
+        void CrawlCell(uint32 x, uint32 y, TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer>& gridVisitor, TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer>& worldVisitor);
+        uint32 GetUpdateRegionKey(uint32 cell_x, uint32 cell_y) const;
+        UpdateRegion& GetUpdateRegion(uint32 cell_x, uint32 cell_y);
+        // the region and one grid around it, no grid search of an object in the region reaches further
+        bool IsInUpdateRegionReach(uint32 regionKey, float x, float y) const;
+        // while the regions are updated, objects may only be moved inside the region of the updating thread
+        bool CanRelocateInUpdateRegion(float oldX, float oldY, float x, float y) const;
+        uint64 UpdateObjectsPartitioned(WorldObjectUnSet& activeObjects, uint32 diff);
+
+        void ProcessPathRequests();
+        std::vector<PathFinder*> m_pathRequests;
+
+        UpdateRegionMap m_updateRegions;
+        uint32 m_updateRegionSize;                          // in grids
+        bool m_collectUpdateRegions;                        // crawl phase, cells are stored to regions instead of visited
+        bool m_partitionedUpdate;                           // update phase, map wide containers have to be locked
+        mutable PartitionMutex m_partitionLock;
+
+        uint32 m_updateCost;
 
     protected:
         MapEntry const* i_mapEntry;
@@ -428,6 +561,7 @@ class Map : public GridRefManager<NGridType>
         uint32 i_InstanceId;
         MaNGOS::unique_weak_ptr<Map> m_weakRef;
         uint32 m_unloadTimer;
+        uint32 m_gridPrefetchTimer;
         float m_VisibleDistance;
         MapPersistentState* m_persistentState;
 
@@ -487,6 +621,9 @@ class Map : public GridRefManager<NGridType>
 
         // Dynamic Map tree object
         DynamicMapTree m_dyn_tree;
+        // results of IsInLineOfSight and GetHeight
+        mutable MapQueryCache m_queryCache;
+        std::unique_ptr<PathCache> m_pathCache;             // held by pointer, so Map.h users need no navmesh headers
 
         // WeatherSystem
         WeatherSystem* m_weatherSystem;
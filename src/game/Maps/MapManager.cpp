@@ -56,6 +56,9 @@ void MapManager::Initialize()
     int num_threads(sWorld.getConfig(CONFIG_UINT32_NUM_MAP_THREADS));
     if (num_threads > 0)
         m_updater.activate(num_threads);
+
+    if (sWorld.getConfig(CONFIG_UINT32_GRID_PREFETCH_LOOKAHEAD))
+        m_gridPrefetcher.Start();
 }
 
 void MapManager::InitStateMachine()
@@ -196,16 +199,31 @@ void MapManager::Update(uint32 diff)
     if (!i_timer.Passed())
         return;
 
-    for (auto& map : i_maps)
+    if (m_updater.activated())
     {
-        if (m_updater.activated())
-            m_updater.schedule_update(new MapUpdateWorker(*map.second, (uint32)i_timer.GetCurrent(), m_updater));
-        else
-            map.second->Update((uint32)i_timer.GetCurrent());
-    }
+        // schedule the maps which took longest last tick first, so the slowest map doesn't start last
+        std::vector<Map*> maps;
+        maps.reserve(i_maps.size());
+        for (auto& map : i_maps)
+            maps.push_back(map.second.get());
+        std::stable_sort(maps.begin(), maps.end(), [](Map const* left, Map const* right) { return left->GetUpdateCost() > right->GetUpdateCost(); });
+
+        while (m_mapUpdateWorkers.size() < maps.size())
+            m_mapUpdateWorkers.push_back(std::make_unique<MapUpdateWorker>(*maps.front(), 0, m_updater));
+
+        for (size_t i = 0; i < maps.size(); ++i)
+        {
+            m_mapUpdateWorkers[i]->Reset(*maps[i], (uint32)i_timer.GetCurrent());
+            m_updater.schedule_update(m_mapUpdateWorkers[i].get());
+        }
 
-    if (m_updater.activated())
         m_updater.wait();
+    }
+    else
+    {
+        for (auto& map : i_maps)
+            map.second->Update((uint32)i_timer.GetCurrent());
+    }
 
     // remove all maps which can be unloaded
     MapMapType::iterator iter = i_maps.begin();
@@ -258,6 +276,9 @@ void MapManager::UnloadAll()
     if (m_updater.activated())
         m_updater.deactivate();
 
+    // it holds terrain references
+    m_gridPrefetcher.Stop();
+
     TerrainManager::Instance().UnloadAll();
 }
 
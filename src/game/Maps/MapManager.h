@@ -26,11 +26,13 @@
 #include "Maps/Map.h"
 #include "Grids/GridStates.h"
 #include "Maps/MapUpdater.h"
+#include "Maps/GridPrefetcher.h"
 #include "Util/UniqueTrackablePtr.h"
 
 class Transport;
 class BattleGround;
 struct TransportTemplate;
+class MapUpdateWorker;
 
 struct MapID
 {
@@ -75,6 +77,11 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
         void Initialize();
         void Update(uint32);
 
+        // thread pool used for map updates, nullptr when maps are updated on the world thread
+        MapUpdater* GetMapUpdater() { return m_updater.activated() ? &m_updater : nullptr; }
+        // background loader of the grids players are heading to, nullptr when grid prefetching is disabled
+        GridPrefetcher* GetGridPrefetcher() { return m_gridPrefetcher.IsRunning() ? &m_gridPrefetcher : nullptr; }
+
         void SetGridCleanUpDelay(uint32 t)
         {
             if (t < MIN_GRID_DELAY)
@@ -181,6 +188,8 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
 
         std::atomic<uint32> i_MaxInstanceId;
         MapUpdater m_updater;
+        std::vector<std::unique_ptr<MapUpdateWorker>> m_mapUpdateWorkers;  // reused every tick
+        GridPrefetcher m_gridPrefetcher;
 };
 
 template<typename Check>
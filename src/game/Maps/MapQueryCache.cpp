@@ -0,0 +1,299 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Maps/MapQueryCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    enum QueryFlags
+    {
+        QUERY_LINE_OF_SIGHT     = 0x01,
+        QUERY_HEIGHT            = 0x02,
+        QUERY_IGNORE_M2_MODEL   = 0x04,
+        QUERY_SWIM              = 0x08,
+    };
+
+    int32 const MAX_QUANTIZED_COORD = 0x3FFFFFFF;
+
+    // size of the areas invalidated together, and how many of them a cached query may cover
+    float const AREA_CELL_SIZE = 32.0f;
+    int32 const MAX_STAMP_CELLS = 64;
+
+    uint32 AreaCounterIndex(int32 x, int32 y, uint32 count)
+    {
+        return (uint32(x) * 73856093u ^ uint32(y) * 19349663u) & (count - 1);
+    }
+
+    // query counts of one thread, only it writes them, so they cost no shared cache line or locked instruction
+    struct QueryCounters
+    {
+        std::atomic<uint64> losHits{0};
+        std::atomic<uint64> losMisses{0};
+        std::atomic<uint64> heightHits{0};
+        std::atomic<uint64> heightMisses{0};
+        std::atomic<uint64> invalidated{0};
+    };
+
+    // counters of all threads that ever queried, kept after a thread ends so GetStats still sums them
+    std::mutex s_countersLock;
+    std::vector<std::unique_ptr<QueryCounters>> s_counters;
+
+    QueryCounters& GetLocalCounters()
+    {
+        thread_local QueryCounters* counters = nullptr;
+        if (!counters)
+        {
+            std::lock_guard<std::mutex> guard(s_countersLock);
+            s_counters.push_back(std::make_unique<QueryCounters>());
+            counters = s_counters.back().get();
+        }
+        return *counters;
+    }
+
+    void Count(std::atomic<uint64>& counter, uint64 count = 1)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+}
+
+bool MapQueryCache::Key::operator==(Key const& other) const
+{
+    return flags == other.flags && std::equal(coords, coords + 6, other.coords);
+}
+
+MapQueryCache::~MapQueryCache()
+{
+    delete[] m_entries.load();
+}
+
+void MapQueryCache::Initialize(uint32 size, float quantization)
+{
+    delete[] m_entries.exchange(nullptr);
+    m_size = 0;
+    if (!size || quantization <= 0.0f)
+        return;
+
+    m_size = 1;
+    while (m_size < size)
+        m_size <<= 1;
+
+    m_quantization = quantization;
+    m_invQuantization = 1.0f / quantization;
+}
+
+int32 MapQueryCache::Quantize(float value) const
+{
+    float scaled = std::floor(value * m_invQuantization);
+    // also catches NaN, such queries all share one key and get whatever result was stored first
+    if (!(scaled > -MAX_QUANTIZED_COORD && scaled < MAX_QUANTIZED_COORD))
+        return MAX_QUANTIZED_COORD;
+    return int32(scaled);
+}
+
+MapQueryCache::Key MapQueryCache::LineOfSightKey(float x1, float y1, float z1, float x2, float y2, float z2, bool ignoreM2Model) const
+{
+    Key key;
+    key.coords[0] = Quantize(x1);
+    key.coords[1] = Quantize(y1);
+    key.coords[2] = Quantize(z1);
+    key.coords[3] = Quantize(x2);
+    key.coords[4] = Quantize(y2);
+    key.coords[5] = Quantize(z2);
+    key.flags = QUERY_LINE_OF_SIGHT | (ignoreM2Model ? QUERY_IGNORE_M2_MODEL : 0);
+    if (!Stamp(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2), key.stamp))
+        key.flags = 0;
+    return key;
+}
+
+MapQueryCache::Key MapQueryCache::HeightKey(float x, float y, float z, bool swim) const
+{
+    Key key;
+    key.coords[0] = Quantize(x);
+    key.coords[1] = Quantize(y);
+    key.coords[2] = Quantize(z);
+    key.coords[3] = key.coords[4] = key.coords[5] = 0;
+    key.flags = QUERY_HEIGHT | (swim ? QUERY_SWIM : 0);
+    // height queries search the whole column
+    if (!Stamp(x, y, x, y, key.stamp))
+        key.flags = 0;
+    return key;
+}
+
+bool MapQueryCache::Stamp(float minX, float minY, float maxX, float maxY, uint32& stamp) const
+{
+    // also catches NaN
+    float const limit = float(MAX_QUANTIZED_COORD);
+    if (!(minX > -limit && minY > -limit && maxX < limit && maxY < limit))
+        return false;
+
+    // the query may end anywhere in the quantized cell of its endpoints
+    int32 const lowX = int32(std::floor((minX - m_quantization) / AREA_CELL_SIZE));
+    int32 const lowY = int32(std::floor((minY - m_quantization) / AREA_CELL_SIZE));
+    int32 const highX = int32(std::floor((maxX + m_quantization) / AREA_CELL_SIZE));
+    int32 const highY = int32(std::floor((maxY + m_quantization) / AREA_CELL_SIZE));
+    if (int64(highX - lowX + 1) * (highY - lowY + 1) > MAX_STAMP_CELLS)
+        return false;
+
+    stamp = 0;
+    for (int32 x = lowX; x <= highX; ++x)
+        for (int32 y = lowY; y <= highY; ++y)
+            stamp += m_areaCounters[AreaCounterIndex(x, y, AREA_COUNTER_COUNT)].load(std::memory_order_acquire);
+    return true;
+}
+
+uint32 MapQueryCache::Slot(Key const& key) const
+{
+    uint32 hash = key.flags * 0x9E3779B9;
+    for (int32 coord : key.coords)
+        hash = (hash ^ uint32(coord)) * 0x01000193;
+    return (hash ^ (hash >> 15)) & (m_size - 1);
+}
+
+bool MapQueryCache::BeginWrite(Entry& entry)
+{
+    uint32 sequence = entry.sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) || !entry.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        return false;
+
+    // the field stores must not become visible before the odd sequence
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+}
+
+void MapQueryCache::EndWrite(Entry& entry)
+{
+    entry.sequence.store(entry.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool MapQueryCache::Find(Key const& key, float& value)
+{
+    // the query is not cached
+    if (!key.flags)
+        return false;
+
+    bool found = false;
+    bool outdated = false;
+    if (Entry* entries = m_entries.load(std::memory_order_acquire))
+    {
+        Entry const& entry = entries[Slot(key)];
+        uint32 sequence = entry.sequence.load(std::memory_order_acquire);
+        if (!(sequence & 1))
+        {
+            Key stored;
+            for (uint32 i = 0; i < 6; ++i)
+                stored.coords[i] = entry.coords[i].load(std::memory_order_relaxed);
+            stored.flags = entry.flags.load(std::memory_order_relaxed);
+            stored.stamp = entry.stamp.load(std::memory_order_relaxed);
+            float storedValue = entry.value.load(std::memory_order_relaxed);
+
+            // a write that started meanwhile may have torn the fields
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (stored == key && entry.sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                // the area changed after the stored query was made
+                if (stored.stamp != key.stamp)
+                    outdated = true;
+                else
+                {
+                    value = storedValue;
+                    found = true;
+                }
+            }
+        }
+    }
+
+    QueryCounters& counters = GetLocalCounters();
+    if (outdated)
+        Count(counters.invalidated);
+    if (key.flags & QUERY_LINE_OF_SIGHT)
+        Count(found ? counters.losHits : counters.losMisses);
+    else
+        Count(found ? counters.heightHits : counters.heightMisses);
+    return found;
+}
+
+void MapQueryCache::Store(Key const& key, float value)
+{
+    if (!m_size || !key.flags)
+        return;
+
+    // value initialized entries have empty keys, the thread losing the race for the first allocation drops its own
+    Entry* entries = m_entries.load(std::memory_order_acquire);
+    if (!entries)
+    {
+        Entry* allocated = new Entry[m_size]();
+        if (m_entries.compare_exchange_strong(entries, allocated, std::memory_order_acq_rel))
+            entries = allocated;
+        else
+            delete[] allocated;
+    }
+
+    // another thread writes the slot, this result is simply not cached
+    Entry& entry = entries[Slot(key)];
+    if (!BeginWrite(entry))
+        return;
+
+    for (uint32 i = 0; i < 6; ++i)
+        entry.coords[i].store(key.coords[i], std::memory_order_relaxed);
+    entry.flags.store(key.flags, std::memory_order_relaxed);
+    entry.stamp.store(key.stamp, std::memory_order_relaxed);
+    entry.value.store(value, std::memory_order_relaxed);
+    EndWrite(entry);
+}
+
+void MapQueryCache::Invalidate(float minX, float minY, float maxX, float maxY)
+{
+    // results stored later by queries made before still carry the old stamp
+    float const limit = float(MAX_QUANTIZED_COORD);
+    if (!(minX > -limit && minY > -limit && maxX < limit && maxY < limit) ||
+        (maxX - minX) / AREA_CELL_SIZE * ((maxY - minY) / AREA_CELL_SIZE) > float(AREA_COUNTER_COUNT))
+    {
+        for (std::atomic<uint32>& counter : m_areaCounters)
+            counter.fetch_add(1, std::memory_order_release);
+        return;
+    }
+
+    int32 const lowX = int32(std::floor(minX / AREA_CELL_SIZE));
+    int32 const lowY = int32(std::floor(minY / AREA_CELL_SIZE));
+    int32 const highX = int32(std::floor(maxX / AREA_CELL_SIZE));
+    int32 const highY = int32(std::floor(maxY / AREA_CELL_SIZE));
+    for (int32 x = lowX; x <= highX; ++x)
+        for (int32 y = lowY; y <= highY; ++y)
+            m_areaCounters[AreaCounterIndex(x, y, AREA_COUNTER_COUNT)].fetch_add(1, std::memory_order_release);
+}
+
+MapQueryCacheStats MapQueryCache::GetStats()
+{
+    MapQueryCacheStats stats = {};
+    std::lock_guard<std::mutex> guard(s_countersLock);
+    for (auto const& counters : s_counters)
+    {
+        stats.losHits += counters->losHits.load(std::memory_order_relaxed);
+        stats.losMisses += counters->losMisses.load(std::memory_order_relaxed);
+        stats.heightHits += counters->heightHits.load(std::memory_order_relaxed);
+        stats.heightMisses += counters->heightMisses.load(std::memory_order_relaxed);
+        stats.invalidated += counters->invalidated.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
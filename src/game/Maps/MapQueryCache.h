@@ -0,0 +1,102 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_MAPQUERYCACHE_H
+#define MANGOS_MAPQUERYCACHE_H
+
+#include "Platform/Define.h"
+
+#include <atomic>
+
+struct MapQueryCacheStats
+{
+    uint64 losHits;
+    uint64 losMisses;
+    uint64 heightHits;
+    uint64 heightMisses;
+    uint64 invalidated;                                     // results found outdated because the geometry around them changed
+};
+
+// Remembers the results of line of sight and height queries of a map. Query positions are quantized, so a query
+// close enough to a cached one gets its result. The cache has a fixed number of entries, a new result replaces
+// whatever shared its slot. Map invalidates the area of dynamic models that are added, removed or toggled and of
+// grids that are loaded or unloaded. Areas have change counters, and a result remembers the sum of the counters
+// of the area its query covers, taken before the query ran. A counter changing since makes the result a miss, so
+// invalidating touches only the counters of the area. Safe to use from several threads at once without a lock:
+// every entry has a sequence number, odd while it is written, and a lookup that sees it change treats the entry
+// as a miss.
+class MapQueryCache
+{
+    public:
+        struct Key
+        {
+            int32 coords[6];
+            uint32 flags;                                   // query type and options, 0 marks an empty entry or a query not cached
+            uint32 stamp;                                   // sum of the area change counters, not part of the comparison
+
+            bool operator==(Key const& other) const;
+        };
+
+        MapQueryCache() : m_entries(nullptr), m_size(0), m_quantization(1.0f), m_invQuantization(1.0f) {}
+        ~MapQueryCache();
+
+        // size is the number of entries, rounded up to a power of two, 0 disables the cache
+        // called before the map is used by other threads
+        void Initialize(uint32 size, float quantization);
+        bool IsEnabled() const { return m_size != 0; }
+
+        // keys are made before the query runs, their stamp must not include changes the query did not see
+        Key LineOfSightKey(float x1, float y1, float z1, float x2, float y2, float z2, bool ignoreM2Model) const;
+        Key HeightKey(float x, float y, float z, bool swim) const;
+
+        bool Find(Key const& key, float& value);
+        void Store(Key const& key, float value);
+
+        // results of queries that could pass through the box become misses, called after the geometry changed
+        void Invalidate(float minX, float minY, float maxX, float maxY);
+
+        static MapQueryCacheStats GetStats();
+
+    private:
+        struct Entry
+        {
+            std::atomic<uint32> sequence;                   // odd while the entry is written
+            std::atomic<int32> coords[6];
+            std::atomic<uint32> flags;
+            std::atomic<uint32> stamp;
+            std::atomic<float> value;
+        };
+
+        int32 Quantize(float value) const;
+        uint32 Slot(Key const& key) const;
+        // sum of the change counters of the area cells covering the box, false if the box is too big to cache
+        bool Stamp(float minX, float minY, float maxX, float maxY, uint32& stamp) const;
+
+        // false if another thread writes the entry
+        static bool BeginWrite(Entry& entry);
+        static void EndWrite(Entry& entry);
+
+        std::atomic<Entry*> m_entries;                      // allocated by the first stored result
+        uint32 m_size;
+        float m_quantization;
+        float m_invQuantization;
+        static uint32 const AREA_COUNTER_COUNT = 4096;
+        std::atomic<uint32> m_areaCounters[AREA_COUNTER_COUNT]; // by hashed area cell, value initialized
+};
+
+#endif
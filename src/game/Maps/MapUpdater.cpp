@@ -19,10 +19,15 @@
 #include "MapUpdater.h"
 #include "MapWorkers.h"
 
-MapUpdater::MapUpdater(size_t num_threads) : _cancelationToken(false), pending_requests(0)
+namespace
 {
-    for (size_t i = 0; i < num_threads; ++i)
-        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this));
+    // index of the queue owned by the current pool thread
+    thread_local size_t t_ownQueue = SIZE_MAX;
+}
+
+MapUpdater::MapUpdater(size_t num_threads) : _cancelationToken(false), _queued(0), _sleeping(0), _nextQueue(0), pending_requests(0)
+{
+    StartThreads(num_threads);
 }
 
 void MapUpdater::activate(size_t num_threads)
@@ -30,18 +35,36 @@ void MapUpdater::activate(size_t num_threads)
     if (activated())
         return;
 
+    StartThreads(num_threads);
+}
+
+void MapUpdater::StartThreads(size_t num_threads)
+{
+    for (size_t i = 0; i < num_threads; ++i)
+        _queues.push_back(std::make_unique<WorkerQueue>());
+
     for (size_t i = 0; i < num_threads; ++i)
-        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this));
+        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this, i));
 }
 
 void MapUpdater::deactivate()
 {
-    _cancelationToken = true;
-
-    _queue.Cancel();
+    {
+        std::lock_guard<std::mutex> lock(_sleepLock);
+        _cancelationToken = true;
+        _sleepCondition.notify_all();
+    }
 
     for (auto& thread : _workerThreads)
         thread.join();
+
+    for (auto& queue : _queues)
+    {
+        for (Worker* worker : queue->workers)
+            if (!worker->IsPooled())
+                delete worker;
+        queue->workers.clear();
+    }
 }
 
 void MapUpdater::wait()
@@ -65,36 +88,149 @@ bool MapUpdater::activated()
 
 void MapUpdater::update_finished()
 {
-    std::lock_guard<std::mutex> lock(_lock);
+    if (--pending_requests > 0)
+        return;
 
-    --pending_requests;
+    // taking the lock makes sure wait() either saw the count or is already waiting
+    std::lock_guard<std::mutex> lock(_lock);
     _condition.notify_all();
 }
 
 void MapUpdater::schedule_update(Worker* worker)
 {
-    std::lock_guard<std::mutex> lock(_lock);
-
     ++pending_requests;
-    _queue.Push(std::move(worker));
+
+    if (t_ownQueue < _queues.size())
+    {
+        // batch workers of a running map go to the back of the own queue, where idle threads steal first
+        std::lock_guard<std::mutex> lock(_queues[t_ownQueue]->lock);
+        _queues[t_ownQueue]->workers.push_back(worker);
+    }
+    else
+    {
+        // workers scheduled from outside the pool are spread over all queues
+        WorkerQueue& queue = *_queues[_nextQueue++ % _queues.size()];
+        std::lock_guard<std::mutex> lock(queue.lock);
+        queue.workers.push_back(worker);
+    }
+    ++_queued;
+
+    // a thread going to sleep counts itself before its last look at _queued, so one of both sees the other
+    if (_sleeping)
+    {
+        std::lock_guard<std::mutex> lock(_sleepLock);
+        _sleepCondition.notify_one();
+    }
 }
 
-void MapUpdater::WorkerThread()
+Worker* MapUpdater::PopWorker(size_t ownQueue)
 {
-    while (true)
+    if (!_queued)
+        return nullptr;
+
+    if (ownQueue < _queues.size())
+    {
+        WorkerQueue& queue = *_queues[ownQueue];
+        std::lock_guard<std::mutex> lock(queue.lock);
+        if (!queue.workers.empty())
+        {
+            Worker* worker = queue.workers.front();
+            queue.workers.pop_front();
+            --_queued;
+            return worker;
+        }
+    }
+
+    // steal the cheapest (latest scheduled) work of the other threads
+    for (size_t i = 1; i <= _queues.size(); ++i)
     {
-        Worker* request = nullptr;
+        WorkerQueue& queue = *_queues[(ownQueue + i) % _queues.size()];
+        std::lock_guard<std::mutex> lock(queue.lock);
+        if (!queue.workers.empty())
+        {
+            Worker* worker = queue.workers.back();
+            queue.workers.pop_back();
+            --_queued;
+            return worker;
+        }
+    }
 
-        _queue.WaitAndPop(request);
+    return nullptr;
+}
+
+Worker* MapUpdater::PopBatchWorker(size_t ownQueue, WorkerBatch const& batch)
+{
+    if (!_queued)
+        return nullptr;
 
-        if (_cancelationToken)
+    // batch workers are at the back, starting with the own queue where the batch was scheduled to
+    size_t first = ownQueue < _queues.size() ? ownQueue : 0;
+    for (size_t i = 0; i < _queues.size(); ++i)
+    {
+        WorkerQueue& queue = *_queues[(first + i) % _queues.size()];
+        std::lock_guard<std::mutex> lock(queue.lock);
+        for (auto itr = queue.workers.rbegin(); itr != queue.workers.rend(); ++itr)
         {
-            delete request;
-            return;
+            if ((*itr)->GetBatch() != &batch)
+                continue;
+
+            Worker* worker = *itr;
+            queue.workers.erase(std::next(itr).base());
+            --_queued;
+            return worker;
         }
+    }
+
+    return nullptr;
+}
 
-        request->execute();
+void MapUpdater::ExecuteWorker(Worker* worker)
+{
+    bool pooled = worker->IsPooled();
+    WorkerBatch* batch = worker->GetBatch();
+
+    worker->execute();
 
-        delete request;
+    if (!pooled)
+        delete worker;
+
+    if (batch)
+        batch->Finish();
+}
+
+void MapUpdater::wait_batch(WorkerBatch& batch)
+{
+    // only help with the own batch, other work (e.g. the update of another map) would delay this map
+    while (Worker* request = PopBatchWorker(t_ownQueue, batch))
+        ExecuteWorker(request);
+
+    // the rest of the batch is running on other threads, the batch is complete so nothing new can show up
+    std::unique_lock<std::mutex> lock(batch._lock);
+    batch._condition.wait(lock, [&batch] { return batch._pending == 0; });
+}
+
+void MapUpdater::WorkerThread(size_t index)
+{
+    t_ownQueue = index;
+
+    while (true)
+    {
+        Worker* request = PopWorker(index);
+
+        if (!request)
+        {
+            std::unique_lock<std::mutex> lock(_sleepLock);
+
+            if (_cancelationToken)
+                return;
+
+            ++_sleeping;
+            if (!_queued)
+                _sleepCondition.wait(lock);
+            --_sleeping;
+            continue;
+        }
+
+        ExecuteWorker(request);
     }
-}
\ No newline at end of file
+}
@@ -20,42 +20,90 @@
 #define _MAP_UPDATER_H_INCLUDED
 
 #include "Platform/Define.h"
-#include "Util/ProducerConsumerQueue.h"
 
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <deque>
+#include <memory>
 #include <vector>
 #include <condition_variable>
 
 class Worker;
 
+// workers a map runs in parallel during its own update, the map waits in MapUpdater::wait_batch until all have finished
+class WorkerBatch
+{
+    public:
+        void Add()
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            ++_pending;
+        }
+
+        void Finish()
+        {
+            // notified under the lock, so the waiter can't return and destroy the batch before
+            std::lock_guard<std::mutex> lock(_lock);
+            if (--_pending == 0)
+                _condition.notify_all();
+        }
+
+    private:
+        friend class MapUpdater;
+
+        std::mutex _lock;
+        std::condition_variable _condition;
+        uint32 _pending = 0;
+};
+
 class MapUpdater
 {
     public:
-        MapUpdater() : _cancelationToken(false), pending_requests(0) {}
+        MapUpdater() : _cancelationToken(false), _queued(0), _sleeping(0), _nextQueue(0), pending_requests(0) {}
         MapUpdater(size_t num_threads);
         MapUpdater(const MapUpdater&) = delete;
-        
+
         void activate(size_t num_threads);
         void deactivate();
         void wait();
         void join();
         bool activated();
         void update_finished();
+        // workers are executed in scheduling order, so expensive work should be scheduled first
         void schedule_update(Worker* worker);
+        // executes the queued workers of batch on the calling thread and then blocks until all of them have finished
+        void wait_batch(WorkerBatch& batch);
 
     private:
-        ProducerConsumerQueue<Worker *> _queue;
+        // every pool thread owns one queue and takes work from its front,
+        // idle threads steal from the back of the other queues, where the batch workers of running maps are
+        struct WorkerQueue
+        {
+            std::mutex lock;
+            std::deque<Worker*> workers;
+        };
+
+        std::vector<std::unique_ptr<WorkerQueue>> _queues;
 
         std::vector<std::thread> _workerThreads;
         std::atomic<bool> _cancelationToken;
 
-        std::mutex _lock;
+        std::atomic<uint32> _queued;                        // workers waiting in any of the queues
+        std::mutex _sleepLock;
+        std::condition_variable _sleepCondition;
+        std::atomic<uint32> _sleeping;                      // only wake the pool if a thread actually sleeps
+        std::atomic<uint32> _nextQueue;                     // round robin for workers scheduled from outside the pool
+
+        std::mutex _lock;                                   // only taken to wait for / signal the last finished request
         std::condition_variable _condition;
-        size_t pending_requests;
+        std::atomic<size_t> pending_requests;
 
-        void WorkerThread();
+        void StartThreads(size_t num_threads);
+        Worker* PopWorker(size_t ownQueue);
+        Worker* PopBatchWorker(size_t ownQueue, WorkerBatch const& batch);
+        void ExecuteWorker(Worker* worker);
+        void WorkerThread(size_t index);
 };
 
-#endif //_MAP_UPDATER_H_INCLUDED
\ No newline at end of file
+#endif //_MAP_UPDATER_H_INCLUDED
@@ -23,67 +23,94 @@
 #include "Grids/GridNotifiersImpl.h"
 #include "MapUpdater.h"
 #include "MotionGenerators/MovementGenerator.h"
+#include "MotionGenerators/PathFinder.h"
 #include "Entities/Object.h"
 #include "Platform/Define.h"
 
+#include <chrono>
+
 class Worker
 {
     public:
-        Worker(MapUpdater& updater) : m_updater(updater) {}
+        Worker(MapUpdater& updater, bool pooled = false, WorkerBatch* batch = nullptr) : m_updater(updater), m_pooled(pooled), m_batch(batch)
+        {
+            if (m_batch)
+                m_batch->Add();
+        }
         virtual ~Worker() = default;
         virtual void execute() {};
 
+        // pooled workers are owned and reused by the scheduling code instead of being deleted after execution
+        bool IsPooled() const { return m_pooled; }
+        // batch the worker is counted in, finished by the updater after execution
+        WorkerBatch* GetBatch() const { return m_batch; }
+
     protected:
         MapUpdater& GetWorker() { return m_updater; }
 
     private:
         MapUpdater& m_updater;
+        bool m_pooled;
+        WorkerBatch* m_batch;
 };
 
 class MapUpdateWorker : public Worker
 {
     public:
         MapUpdateWorker(Map& map, uint32 diff, MapUpdater& updater) :
-            Worker(updater), m_map(map), m_diff(diff)
+            Worker(updater, true), m_map(&map), m_diff(diff)
         {}
 
+        void Reset(Map& map, uint32 diff)
+        {
+            m_map = &map;
+            m_diff = diff;
+        }
+
         void execute() override
         {
-            m_map.Update(m_diff);
+            auto start = std::chrono::steady_clock::now();
+            m_map->Update(m_diff);
+            m_map->SetUpdateCost(uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()));
+
             GetWorker().update_finished();
         }
 
     private:
-        Map& m_map;
+        Map* m_map;
         uint32 m_diff;
 };
 
 class GridCrawler : public Worker
 {
     public:
-        GridCrawler(Map& map, std::vector<Cell> &cells, uint32 diff, MapUpdater& updater) :
-            Worker(updater), m_map(map), m_cells(cells), m_diff(diff)
+        GridCrawler(Map& map, uint32 regionKey, std::vector<Cell>& cells, WorldObjectUnSet& objToUpdate, std::vector<WorldObject*>& serialObjects, uint32 diff, MapUpdater& updater, WorkerBatch& batch) :
+            Worker(updater, false, &batch), m_map(map), m_regionKey(regionKey), m_cells(cells), m_objToUpdate(objToUpdate), m_serialObjects(serialObjects), m_diff(diff)
         {}
 
         void execute() override
         {
-            WorldObjectUnSet objToUpdate;
-            MaNGOS::ObjectUpdater obj_updater(objToUpdate, m_diff);
+            MaNGOS::ObjectUpdater obj_updater(m_objToUpdate, m_diff);
             TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(obj_updater);    // For creature
             TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(obj_updater);   // For pets
 
-            for (auto &cell : m_cells)
+            for (auto& cell : m_cells)
             {
                 m_map.Visit(cell, grid_object_update);
                 m_map.Visit(cell, world_object_update);
             }
 
+            m_map.SelectRegionObjects(m_regionKey, m_objToUpdate, m_serialObjects);
+
             GetWorker().update_finished();
         }
 
     private:
         Map& m_map;
-        std::vector<Cell> &m_cells;
+        uint32 m_regionKey;
+        std::vector<Cell>& m_cells;
+        WorldObjectUnSet& m_objToUpdate;
+        std::vector<WorldObject*>& m_serialObjects;
         uint32 m_diff;
 };
 
@@ -91,21 +118,62 @@ class GridCrawler : public Worker
 class ObjectUpdateWorker : public Worker
 {
     public:
-        ObjectUpdateWorker(std::unordered_set<WorldObject*>& objects, uint32 diff, MapUpdater& updater) :
-            Worker(updater), m_objects(objects), m_diff(diff)
+        ObjectUpdateWorker(Map& map, uint32 regionKey, WorldObjectUnSet& objects, uint32 diff, MapUpdater& updater, WorkerBatch& batch) :
+            Worker(updater, false, &batch), m_map(map), m_regionKey(regionKey), m_objects(objects), m_diff(diff)
         {}
 
         void execute() override
         {
-            for (WorldObject* const &object : m_objects)
-                object->Update(m_diff);
+            m_map.UpdateRegionObjects(m_regionKey, m_objects, m_diff);
 
             GetWorker().update_finished();
         }
 
     private:
-        std::unordered_set<WorldObject*>& m_objects;
+        Map& m_map;
+        uint32 m_regionKey;
+        WorldObjectUnSet& m_objects;
         uint32 m_diff;
 };
 
+class UpdatePacketWorker : public Worker
+{
+    public:
+        UpdatePacketWorker(UpdateDataMapType::iterator begin, UpdateDataMapType::iterator end, MapUpdater& updater, WorkerBatch& batch) :
+            Worker(updater, false, &batch), m_begin(begin), m_end(end)
+        {}
+
+        void execute() override
+        {
+            for (auto itr = m_begin; itr != m_end; ++itr)
+                itr->data.SendData(*itr->player->GetSession());
+
+            GetWorker().update_finished();
+        }
+
+    private:
+        UpdateDataMapType::iterator m_begin;
+        UpdateDataMapType::iterator m_end;
+};
+
+class PathRequestWorker : public Worker
+{
+    public:
+        PathRequestWorker(std::vector<PathFinder*>::iterator begin, std::vector<PathFinder*>::iterator end, MapUpdater& updater, WorkerBatch& batch) :
+            Worker(updater, false, &batch), m_begin(begin), m_end(end)
+        {}
+
+        void execute() override
+        {
+            for (auto itr = m_begin; itr != m_end; ++itr)
+                (*itr)->ExecuteAsync();
+
+            GetWorker().update_finished();
+        }
+
+    private:
+        std::vector<PathFinder*>::iterator m_begin;
+        std::vector<PathFinder*>::iterator m_end;
+};
+
 #endif //_MAP_WORKERS_H_INCLUDED
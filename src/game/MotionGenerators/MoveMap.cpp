@@ -195,7 +195,7 @@ namespace MMAP
         mmapData->fullLoaded = true;
     }
 
-    bool MMapManager::loadMap(std::string const& basePath, uint32 mapId, int32 x, int32 y)
+    bool MMapManager::loadMap(std::string const& basePath, uint32 mapId, int32 x, int32 y, MMapTileData* preloaded /*= nullptr*/)
     {
         // get this mmap data
         auto itr = loadedMMaps.find(mapId);
@@ -211,15 +211,36 @@ namespace MMAP
             return false;
         }
 
+        if (preloaded && preloaded->data)
+            return addTile(mmapData, *preloaded, packedGridPos, mapId, x, y);
+
+        MMapTileData tile;
+        if (!readMapTile(basePath, mapId, x, y, tile))
+            return false;
+
+        return addTile(mmapData, tile, packedGridPos, mapId, x, y);
+    }
+
+    bool MMapManager::readMapTile(std::string const& basePath, uint32 mapId, int32 x, int32 y, MMapTileData& tile)
+    {
         // load this tile :: mmaps/MMMXXYY.mmtile
         uint32 pathLen = basePath.length() + strlen(TILE_FILE_NAME_FORMAT) + 1;
         std::unique_ptr<char[]> fileName(new char[pathLen]);
         snprintf(fileName.get(), pathLen, (basePath + TILE_FILE_NAME_FORMAT).c_str(), mapId, x, y);
 
-        return loadMapInternal(fileName.get(), mmapData, packedGridPos, mapId, x, y);
+        return readTileFile(fileName.get(), mapId, x, y, tile);
     }
 
     bool MMapManager::loadMapInternal(const char* filePath, const std::unique_ptr<MMapData>& mmapData, uint32 packedGridPos, uint32 mapId, int32 x, int32 y)
+    {
+        MMapTileData tile;
+        if (!readTileFile(filePath, mapId, x, y, tile))
+            return false;
+
+        return addTile(mmapData, tile, packedGridPos, mapId, x, y);
+    }
+
+    bool MMapManager::readTileFile(const char* filePath, uint32 mapId, int32 x, int32 y, MMapTileData& tile)
     {
         FILE* file = fopen(filePath, "rb");
         if (!file)
@@ -247,10 +268,12 @@ namespace MMAP
             return false;
         }
 
-        unsigned char* data = (unsigned char*)dtAlloc(fileHeader.size, DT_ALLOC_PERM);
-        MANGOS_ASSERT(data);
+        MMapTileData data;
+        data.data = (unsigned char*)dtAlloc(fileHeader.size, DT_ALLOC_PERM);
+        data.size = fileHeader.size;
+        MANGOS_ASSERT(data.data);
 
-        size_t result = fread(data, fileHeader.size, 1, file);
+        size_t result = fread(data.data, fileHeader.size, 1, file);
         if (!result)
         {
             sLog.outError("MMAP:loadMap: Bad header or data in mmap %03u%02i%02i.mmtile", mapId, x, y);
@@ -260,17 +283,24 @@ namespace MMAP
 
         fclose(file);
 
-        dtMeshHeader* header = (dtMeshHeader*)data;
+        tile = std::move(data);
+        return true;
+    }
+
+    bool MMapManager::addTile(const std::unique_ptr<MMapData>& mmapData, MMapTileData& tile, uint32 packedGridPos, uint32 mapId, int32 x, int32 y)
+    {
+        dtMeshHeader* header = (dtMeshHeader*)tile.data;
         dtTileRef tileRef = 0;
 
         // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
-        dtStatus dtResult = mmapData->navMesh->addTile(data, fileHeader.size, DT_TILE_FREE_DATA, 0, &tileRef);
+        dtStatus dtResult = mmapData->navMesh->addTile(tile.data, tile.size, DT_TILE_FREE_DATA, 0, &tileRef);
         if (dtStatusFailed(dtResult))
         {
             sLog.outError("MMAP:loadMap: Could not load %03u%02i%02i.mmtile into navmesh", mapId, x, y);
-            dtFree(data);
-            return false;
+            return false;                                   // tile still owns the data and frees it
         }
+        tile.data = nullptr;
+        tile.size = 0;
 
         mmapData->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
         ++loadedTiles;
@@ -540,4 +570,35 @@ namespace MMAP
 
         return mmapGOData->navMeshGOQueries[threadId];
     }
+
+    dtNavMeshQuery const* MMapManager::GetThreadNavMeshQuery(uint32 mapId)
+    {
+        auto itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
+            return nullptr;
+
+        auto threadId = std::this_thread::get_id();
+        MMapData& mmap = *itr->second;
+        std::lock_guard<std::mutex> guard(m_threadQueriesMutex);
+        auto [queryItr, inserted] = mmap.navMeshThreadQueries.try_emplace(threadId, nullptr);
+        if (!inserted)
+            return queryItr->second;
+
+        // allocate mesh query
+        std::stringstream ss;
+        ss << threadId;
+        dtNavMeshQuery* query = dtAllocNavMeshQuery();
+        MANGOS_ASSERT(query);
+        if (dtStatusFailed(query->init(mmap.navMesh, 1024)))
+        {
+            dtFreeNavMeshQuery(query);
+            mmap.navMeshThreadQueries.erase(queryItr);
+            sLog.outError("MMAP:GetThreadNavMeshQuery: Failed to initialize dtNavMeshQuery for mapId %03u tid %s", mapId, ss.str().data());
+            return nullptr;
+        }
+
+        DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:GetThreadNavMeshQuery: created dtNavMeshQuery for mapId %03u tid %s", mapId, ss.str().data());
+        queryItr->second = query;
+        return query;
+    }
 }
@@ -56,6 +56,9 @@ namespace MMAP
             for (auto& navMeshQuerie : navMeshQueries)
                 dtFreeNavMeshQuery(navMeshQuerie.second);
 
+            for (auto& threadQuery : navMeshThreadQueries)
+                dtFreeNavMeshQuery(threadQuery.second);
+
             if (navMesh)
                 dtFreeNavMesh(navMesh);
         }
@@ -64,6 +67,7 @@ namespace MMAP
 
         // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
         NavMeshQuerySet navMeshQueries;     // instanceId to query
+        NavMeshGOQuerySet navMeshThreadQueries; // path worker thread to query, any instance can use them
         MMapTileSet mmapLoadedTiles;        // maps [map grid coords] to [dtTile]
 
         bool fullLoaded;
@@ -87,6 +91,21 @@ namespace MMAP
         NavMeshGOQuerySet navMeshGOQueries;  // instanceId to query
     };
 
+    // navmesh tile read from its file but not yet added to a navmesh, the data is freed if it never is
+    struct MMapTileData
+    {
+        MMapTileData() : data(nullptr), size(0) {}
+        MMapTileData(MMapTileData&& other) noexcept : data(other.data), size(other.size) { other.data = nullptr; other.size = 0; }
+        MMapTileData& operator=(MMapTileData&& other) noexcept { std::swap(data, other.data); std::swap(size, other.size); return *this; }
+        ~MMapTileData() { if (data) dtFree(data); }
+
+        MMapTileData(MMapTileData const&) = delete;
+        MMapTileData& operator=(MMapTileData const&) = delete;
+
+        unsigned char* data;
+        uint32 size;
+    };
+
 
     // singleton class
     // holds all access to mmap loading unloading and meshes
@@ -97,7 +116,10 @@ namespace MMAP
             ~MMapManager();
 
             void loadAllMapTiles(std::string const& basePath, uint32 mapId);
-            bool loadMap(std::string const& basePath, uint32 mapId, int32 x, int32 y);
+            // a tile read ahead by readMapTile is used instead of reading the file again
+            bool loadMap(std::string const& basePath, uint32 mapId, int32 x, int32 y, MMapTileData* preloaded = nullptr);
+            // reads a tile without touching any navmesh, can be called from any thread
+            static bool readMapTile(std::string const& basePath, uint32 mapId, int32 x, int32 y, MMapTileData& tile);
             bool loadMapInternal(const char* filePath, const std::unique_ptr<MMapData>& mmapData, uint32 packedGridPos, uint32 mapId, int32 x, int32 y);
             void loadAllGameObjectModels(std::string const& basePath, std::vector<uint32> const& displayIds);
             bool loadGameObject(std::string const& basePath, uint32 displayId);
@@ -110,6 +132,8 @@ namespace MMAP
             // the returned [dtNavMeshQuery const*] is NOT threadsafe
             dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId, uint32 instanceId);
             dtNavMeshQuery const* GetModelNavMeshQuery(uint32 displayId);
+            // query owned by the calling thread, for paths calculated off the map threads
+            dtNavMeshQuery const* GetThreadNavMeshQuery(uint32 mapId);
             dtNavMesh const* GetNavMesh(uint32 mapId);
             dtNavMesh const* GetGONavMesh(uint32 displayId);
 
@@ -120,6 +144,8 @@ namespace MMAP
             bool IsEnabled() const { return m_enabled; }
         private:
             bool loadMapData(std::string const& basePath, uint32 mapId);
+            static bool readTileFile(const char* filePath, uint32 mapId, int32 x, int32 y, MMapTileData& tile);
+            bool addTile(const std::unique_ptr<MMapData>& mmapData, MMapTileData& tile, uint32 packedGridPos, uint32 mapId, int32 x, int32 y);
             uint32 packTileID(int32 x, int32 y) const;
 
             std::unordered_map<uint32, std::unique_ptr<MMapData>> loadedMMaps;
@@ -127,6 +153,7 @@ namespace MMAP
 
             std::unordered_map<uint32, std::unique_ptr<MMapGOData>> m_loadedModels;
             std::mutex m_modelsMutex;
+            std::mutex m_threadQueriesMutex;
 
             bool m_enabled;
     };
@@ -0,0 +1,166 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MotionGenerators/PathCache.h"
+#include "Util/Timer.h"
+
+#include <Detour/Include/DetourCommon.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+    std::atomic<uint64> s_hits(0);
+    std::atomic<uint64> s_joined(0);
+    std::atomic<uint64> s_misses(0);
+}
+
+void PathCache::Initialize(uint32 size, uint32 lifetime, float endDistance)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_entries.assign(size, Entry());
+    m_next = 0;
+    m_lifetime = lifetime;
+    m_endDistanceSq = endDistance * endDistance;
+}
+
+bool PathCache::IsUsable(Entry const& entry, dtNavMesh const* navMesh, dtQueryFilter const* filter, dtPolyRef endPoly, float const* endPoint, uint32 now) const
+{
+    if (entry.endPoly != endPoly || entry.includeFlags != filter->getIncludeFlags() || entry.excludeFlags != filter->getExcludeFlags())
+        return false;
+
+    if (WorldTimer::getMSTimeDiff(entry.storeTime, now) > m_lifetime)
+        return false;
+
+    // the destination moved away inside a large poly
+    if (dtVdistSqr(entry.endPoint, endPoint) > m_endDistanceSq)
+        return false;
+
+    // tiles reloaded since get new poly refs
+    for (dtPolyRef poly : entry.corridor)
+        if (!navMesh->isValidPolyRef(poly))
+            return false;
+
+    return true;
+}
+
+uint32 PathCache::Find(dtNavMesh const* navMesh, dtQueryFilter const* filter, dtPolyRef startPoly, dtPolyRef endPoly, float const* endPoint,
+                       dtPolyRef* path, uint32 maxPath)
+{
+    uint32 now = WorldTimer::getMSTime();
+    std::lock_guard<std::mutex> guard(m_lock);
+    for (Entry const& entry : m_entries)
+    {
+        if (!IsUsable(entry, navMesh, filter, endPoly, endPoint, now))
+            continue;
+
+        auto start = std::find(entry.corridor.begin(), entry.corridor.end(), startPoly);
+        if (start == entry.corridor.end())
+            continue;
+
+        // a longer corridor than the caller takes ends up incomplete
+        uint32 length = std::min(uint32(entry.corridor.end() - start), maxPath);
+        std::copy(start, start + length, path);
+        s_hits.fetch_add(1, std::memory_order_relaxed);
+        return length;
+    }
+
+    return 0;
+}
+
+bool PathCache::FindJoinable(dtNavMesh const* navMesh, dtQueryFilter const* filter, dtPolyRef endPoly, float const* endPoint,
+                             std::vector<dtPolyRef>& corridor, float* startPoint)
+{
+    uint32 now = WorldTimer::getMSTime();
+    std::lock_guard<std::mutex> guard(m_lock);
+    Entry const* newest = nullptr;
+    for (Entry const& entry : m_entries)
+    {
+        if (newest && WorldTimer::getMSTimeDiff(entry.storeTime, now) >= WorldTimer::getMSTimeDiff(newest->storeTime, now))
+            continue;
+
+        if (IsUsable(entry, navMesh, filter, endPoly, endPoint, now))
+            newest = &entry;
+    }
+
+    if (!newest)
+        return false;
+
+    corridor = newest->corridor;
+    dtVcopy(startPoint, newest->startPoint);
+    return true;
+}
+
+void PathCache::Store(dtQueryFilter const* filter, float const* startPoint, dtPolyRef endPoly, float const* endPoint,
+                      dtPolyRef const* path, uint32 length)
+{
+    if (!length)
+        return;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (m_entries.empty())
+        return;
+
+    // a corridor to the same destination is outdated by the new one
+    auto itr = std::find_if(m_entries.begin(), m_entries.end(), [&](Entry const& entry)
+    {
+        return entry.endPoly == endPoly && entry.includeFlags == filter->getIncludeFlags() && entry.excludeFlags == filter->getExcludeFlags();
+    });
+
+    Entry* entry = nullptr;
+    if (itr != m_entries.end())
+        entry = &*itr;
+    else
+    {
+        entry = &m_entries[m_next];
+        m_next = (m_next + 1) % m_entries.size();
+    }
+
+    entry->corridor.assign(path, path + length);
+    entry->endPoly = endPoly;
+    dtVcopy(entry->startPoint, startPoint);
+    dtVcopy(entry->endPoint, endPoint);
+    entry->includeFlags = filter->getIncludeFlags();
+    entry->excludeFlags = filter->getExcludeFlags();
+    entry->storeTime = WorldTimer::getMSTime();
+}
+
+void PathCache::Clear()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    for (Entry& entry : m_entries)
+    {
+        entry.corridor.clear();
+        entry.endPoly = 0;
+    }
+}
+
+void PathCache::RecordJoin(bool joined)
+{
+    (joined ? s_joined : s_misses).fetch_add(1, std::memory_order_relaxed);
+}
+
+PathCacheStats PathCache::GetStats()
+{
+    PathCacheStats stats;
+    stats.hits = s_hits.load(std::memory_order_relaxed);
+    stats.joined = s_joined.load(std::memory_order_relaxed);
+    stats.misses = s_misses.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,87 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_PATHCACHE_H
+#define MANGOS_PATHCACHE_H
+
+#include "Platform/Define.h"
+
+#include <Detour/Include/DetourNavMesh.h>
+#include <Detour/Include/DetourNavMeshQuery.h>
+
+#include <mutex>
+#include <vector>
+
+struct PathCacheStats
+{
+    uint64 hits;                                            // corridor found from the start poly on
+    uint64 joined;                                          // corridor reached by a short walk from the start poly
+    uint64 misses;
+};
+
+// Remembers the poly corridors found by the path finders of a map, so units heading to the same spot - a pack
+// chasing one player - share one search. A corridor is reused from any of its polys on, or joined by a short walk
+// along the surface. Corridors expire after a while, when their destination moved too far or when a grid of the
+// map unloads. Safe to use from several threads at once.
+class PathCache
+{
+    public:
+        PathCache() : m_next(0), m_lifetime(0), m_endDistanceSq(0.0f) {}
+
+        // size is the number of corridors remembered, 0 disables the cache
+        void Initialize(uint32 size, uint32 lifetime, float endDistance);
+        bool IsEnabled() const { return !m_entries.empty(); }
+
+        // Points are in detour order (y, z, x).
+        // Writes the part from startPoly on of a cached corridor to endPoly into path, returns its length or 0 if there is none.
+        uint32 Find(dtNavMesh const* navMesh, dtQueryFilter const* filter, dtPolyRef startPoly, dtPolyRef endPoly, float const* endPoint,
+                    dtPolyRef* path, uint32 maxPath);
+        // Copies the newest corridor to endPoly and the point it started at, to join it from a nearby poly.
+        bool FindJoinable(dtNavMesh const* navMesh, dtQueryFilter const* filter, dtPolyRef endPoly, float const* endPoint,
+                          std::vector<dtPolyRef>& corridor, float* startPoint);
+        void Store(dtQueryFilter const* filter, float const* startPoint, dtPolyRef endPoly, float const* endPoint,
+                   dtPolyRef const* path, uint32 length);
+        // whether a corridor from FindJoinable could be used
+        static void RecordJoin(bool joined);
+
+        void Clear();
+
+        static PathCacheStats GetStats();
+
+    private:
+        struct Entry
+        {
+            std::vector<dtPolyRef> corridor;
+            dtPolyRef endPoly;
+            float startPoint[3];
+            float endPoint[3];
+            uint16 includeFlags;
+            uint16 excludeFlags;
+            uint32 storeTime;
+        };
+
+        bool IsUsable(Entry const& entry, dtNavMesh const* navMesh, dtQueryFilter const* filter, dtPolyRef endPoly, float const* endPoint, uint32 now) const;
+
+        std::vector<Entry> m_entries;
+        uint32 m_next;                                      // slot replaced by the next new corridor
+        uint32 m_lifetime;
+        float m_endDistanceSq;
+        std::mutex m_lock;
+};
+
+#endif
@@ -20,9 +20,11 @@
 #include "Maps/GridMap.h"
 #include "Entities/Creature.h"
 #include "PathFinder.h"
+#include "PathCache.h"
 #include "Log/Log.h"
 #include "World/World.h"
 #include "Entities/Transports.h"
+#include "Maps/Map.h"
 #include <Detour/Include/DetourCommon.h>
 #include <Detour/Include/DetourMath.h>
 
@@ -30,6 +32,7 @@
  #include "Metric/Metric.h"
 #endif
 
+#include <algorithm>
 #include <limits>
 ////////////////// PathFinder //////////////////
 PathFinder::PathFinder(const Unit* owner, bool ignoreNormalization) :
@@ -37,7 +40,8 @@ PathFinder::PathFinder(const Unit* owner, bool ignoreNormalization) :
     m_pointPathLimit(MAX_POINT_PATH_LENGTH), // TODO: Fix legitimate long paths
     m_cachedPoints(m_pointPathLimit * VERTEX_SIZE), m_pathPolyRefs(m_pointPathLimit), m_polyLength(0),
     m_smoothPathPolyRefs(m_pointPathLimit), m_sourceUnit(owner), m_navMesh(nullptr), m_navMeshQuery(nullptr),
-    m_defaultMapId(m_sourceUnit->GetMapId()), m_ignoreNormalization(ignoreNormalization)
+    m_defaultMapId(m_sourceUnit->GetMapId()), m_ignoreNormalization(ignoreNormalization),
+    m_asyncState(PATH_ASYNC_NONE), m_asyncMap(nullptr), m_useThreadQuery(false)
 #ifdef ENABLE_PLAYERBOTS
     , m_defaultInstanceId(m_sourceUnit->GetInstanceId())
 #endif
@@ -57,7 +61,8 @@ PathFinder::PathFinder(const Unit* owner, bool ignoreNormalization) :
 PathFinder::PathFinder() :
     m_polyLength(0), m_type(PATHFIND_BLANK),
     m_useStraightPath(false), m_forceDestination(false), m_straightLine(false), m_pointPathLimit(MAX_POINT_PATH_LENGTH), // TODO: Fix legitimate long paths
-    m_sourceUnit(nullptr), m_navMesh(nullptr), m_navMeshQuery(nullptr), m_cachedPoints(m_pointPathLimit* VERTEX_SIZE), m_pathPolyRefs(m_pointPathLimit), m_smoothPathPolyRefs(m_pointPathLimit), m_defaultMapId(0), m_defaultInstanceId(0)
+    m_sourceUnit(nullptr), m_navMesh(nullptr), m_navMeshQuery(nullptr), m_cachedPoints(m_pointPathLimit* VERTEX_SIZE), m_pathPolyRefs(m_pointPathLimit), m_smoothPathPolyRefs(m_pointPathLimit), m_defaultMapId(0), m_defaultInstanceId(0),
+    m_asyncState(PATH_ASYNC_NONE), m_asyncMap(nullptr), m_useThreadQuery(false)
 {
 
 }
@@ -65,7 +70,8 @@ PathFinder::PathFinder() :
 PathFinder::PathFinder(uint32 mapId, uint32 instanceId) :
     m_polyLength(0), m_type(PATHFIND_BLANK),
     m_useStraightPath(false), m_forceDestination(false), m_straightLine(false), m_pointPathLimit(MAX_POINT_PATH_LENGTH), // TODO: Fix legitimate long paths
-    m_sourceUnit(nullptr), m_navMesh(nullptr), m_navMeshQuery(nullptr), m_cachedPoints(m_pointPathLimit* VERTEX_SIZE), m_pathPolyRefs(m_pointPathLimit), m_smoothPathPolyRefs(m_pointPathLimit), m_defaultMapId(mapId), m_defaultInstanceId(instanceId)
+    m_sourceUnit(nullptr), m_navMesh(nullptr), m_navMeshQuery(nullptr), m_cachedPoints(m_pointPathLimit* VERTEX_SIZE), m_pathPolyRefs(m_pointPathLimit), m_smoothPathPolyRefs(m_pointPathLimit), m_defaultMapId(mapId), m_defaultInstanceId(instanceId),
+    m_asyncState(PATH_ASYNC_NONE), m_asyncMap(nullptr), m_useThreadQuery(false)
 {
     MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
     m_defaultNavMeshQuery = mmap->GetNavMeshQuery(mapId, instanceId);
@@ -75,6 +81,7 @@ PathFinder::PathFinder(uint32 mapId, uint32 instanceId) :
 
 PathFinder::~PathFinder()
 {
+    CancelAsync();
     DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::~PathInfo() for %u \n", m_sourceUnit->GetGUIDLow());
 }
 
@@ -90,7 +97,7 @@ void PathFinder::SetCurrentNavMesh()
             if (m_defaultMapId != m_sourceUnit->GetMapId())
                 m_defaultNavMeshQuery = mmap->GetNavMeshQuery(m_sourceUnit->GetMapId(), m_sourceUnit->GetInstanceId());
 
-            m_navMeshQuery = m_defaultNavMeshQuery;
+            m_navMeshQuery = m_useThreadQuery ? mmap->GetThreadNavMeshQuery(m_sourceUnit->GetMapId()) : m_defaultNavMeshQuery;
         }
 
         if (m_navMeshQuery)
@@ -120,6 +127,91 @@ bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest
 }
 
 bool PathFinder::calculate(Vector3 const& start, Vector3 const& dest, bool forceDest/* = false*/, bool straightLine/* = false*/)
+{
+    CancelAsync();
+    return BuildPath(start, dest, forceDest, straightLine);
+}
+
+void PathFinder::calculateAsync(float destX, float destY, float destZ, bool forceDest/* = false*/, bool straightLine/* = false*/)
+{
+    if (!m_sourceUnit || !m_sourceUnit->IsInWorld())
+    {
+        calculate(destX, destY, destZ, forceDest, straightLine);
+        m_asyncState = PATH_ASYNC_DONE;
+        return;
+    }
+
+    m_sourceUnit->GetPosition(m_asyncRequest.start.x, m_asyncRequest.start.y, m_asyncRequest.start.z, m_sourceUnit->GetTransport());
+    m_asyncRequest.dest = Vector3(destX, destY, destZ);
+    if (GenericTransport* transport = m_sourceUnit->GetTransport())
+        transport->CalculatePassengerOffset(m_asyncRequest.dest.x, m_asyncRequest.dest.y, m_asyncRequest.dest.z);
+    m_asyncRequest.range = 0.0f;
+    m_asyncRequest.forceDest = forceDest;
+    m_asyncRequest.straightLine = straightLine;
+    m_asyncRequest.randomPoint = false;
+
+    // a queued calculation is just updated
+    if (m_asyncState != PATH_ASYNC_QUEUED)
+    {
+        m_asyncState = PATH_ASYNC_QUEUED;
+        m_asyncMap = m_sourceUnit->GetMap();
+        m_asyncMap->QueuePathRequest(this);
+    }
+}
+
+void PathFinder::ComputePathToRandomPointAsync(Vector3 const& startPoint, float maxRange)
+{
+    if (!m_sourceUnit || !m_sourceUnit->IsInWorld())
+    {
+        ComputePathToRandomPoint(startPoint, maxRange);
+        m_asyncState = PATH_ASYNC_DONE;
+        return;
+    }
+
+    m_asyncRequest.start = startPoint;
+    m_asyncRequest.range = maxRange;
+    m_asyncRequest.randomPoint = true;
+
+    if (m_asyncState != PATH_ASYNC_QUEUED)
+    {
+        m_asyncState = PATH_ASYNC_QUEUED;
+        m_asyncMap = m_sourceUnit->GetMap();
+        m_asyncMap->QueuePathRequest(this);
+    }
+}
+
+bool PathFinder::TakeAsyncResult()
+{
+    if (m_asyncState != PATH_ASYNC_DONE)
+        return false;
+
+    m_asyncState = PATH_ASYNC_NONE;
+    return true;
+}
+
+void PathFinder::CancelAsync()
+{
+    if (m_asyncState == PATH_ASYNC_QUEUED)
+        m_asyncMap->CancelPathRequest(this);
+
+    m_asyncState = PATH_ASYNC_NONE;
+    m_asyncMap = nullptr;
+}
+
+void PathFinder::ExecuteAsync()
+{
+    m_useThreadQuery = true;
+    if (m_asyncRequest.randomPoint)
+        BuildPathToRandomPoint(m_asyncRequest.start, m_asyncRequest.range);
+    else
+        BuildPath(m_asyncRequest.start, m_asyncRequest.dest, m_asyncRequest.forceDest, m_asyncRequest.straightLine);
+    m_useThreadQuery = false;
+
+    m_asyncState = PATH_ASYNC_DONE;
+    m_asyncMap = nullptr;
+}
+
+bool PathFinder::BuildPath(Vector3 const& start, Vector3 const& dest, bool forceDest, bool straightLine)
 {
     if (!MaNGOS::IsValidMapCoord(dest.x, dest.y, dest.z))
         return false;
@@ -675,19 +767,32 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
 
         if (!m_straightLine)
         {
-            dtResult = m_navMeshQuery->findPath(
-                    startPoly,          // start polygon
-                    endPoly,            // end polygon
-                    startPoint,         // start position
-                    endPoint,           // end position
-                    &m_filter,          // polygon search filter
-                    m_pathPolyRefs.data(), // [out] path
-                    (int*)&m_polyLength,
 #ifdef ENABLE_PLAYERBOTS
-                    m_pointPathLimit / 2);
+            uint32 maxPolyLength = m_pointPathLimit / 2;
 #else
-                    m_pointPathLimit);  // max number of polygons in output path
+            uint32 maxPolyLength = m_pointPathLimit;
 #endif
+            PathCache* cache = GetPathCache();
+            if (cache)
+                m_polyLength = FindCachedPolyPath(*cache, startPoly, startPoint, endPoly, endPoint, maxPolyLength);
+
+            if (m_polyLength)
+                dtResult = DT_SUCCESS;
+            else
+            {
+                dtResult = m_navMeshQuery->findPath(
+                        startPoly,          // start polygon
+                        endPoly,            // end polygon
+                        startPoint,         // start position
+                        endPoint,           // end position
+                        &m_filter,          // polygon search filter
+                        m_pathPolyRefs.data(), // [out] path
+                        (int*)&m_polyLength,
+                        maxPolyLength);     // max number of polygons in output path
+
+                if (cache && dtStatusSucceed(dtResult))
+                    cache->Store(&m_filter, startPoint, endPoly, endPoint, m_pathPolyRefs.data(), m_polyLength);
+            }
         }
         else
         {
@@ -1138,6 +1243,53 @@ bool PathFinder::HaveTile(const Vector3& p) const
     return (m_navMesh->getTileAt(tx, ty, 0) != nullptr); // Don't use layer so always set to 0
 }
 
+PathCache* PathFinder::GetPathCache() const
+{
+    // transports have their own navmesh
+    if (!m_sourceUnit || !m_sourceUnit->IsInWorld() || m_sourceUnit->GetTransport())
+        return nullptr;
+
+    PathCache& cache = m_sourceUnit->GetMap()->GetPathCache();
+    return cache.IsEnabled() ? &cache : nullptr;
+}
+
+uint32 PathFinder::FindCachedPolyPath(PathCache& cache, dtPolyRef startPoly, const float* startPoint, dtPolyRef endPoly, const float* endPoint, uint32 maxPolyLength)
+{
+    if (uint32 length = cache.Find(m_navMesh, &m_filter, startPoly, endPoly, endPoint, m_pathPolyRefs.data(), maxPolyLength))
+        return length;
+
+    // units close to the start of a corridor walk over to it, like the members of a chasing pack
+    std::vector<dtPolyRef> corridor;
+    float corridorStart[VERTEX_SIZE];
+    if (!cache.FindJoinable(m_navMesh, &m_filter, endPoly, endPoint, corridor, corridorStart) ||
+        dtVdistSqr(startPoint, corridorStart) > MAX_CORRIDOR_JOIN_DIST * MAX_CORRIDOR_JOIN_DIST)
+    {
+        PathCache::RecordJoin(false);
+        return 0;
+    }
+
+    float walkEnd[VERTEX_SIZE];
+    dtPolyRef visited[MAX_CORRIDOR_JOIN_POLYS];
+    int visitedCount = 0;
+    dtStatus dtResult = m_navMeshQuery->moveAlongSurface(startPoly, startPoint, corridorStart, &m_filter, walkEnd, visited, &visitedCount, MAX_CORRIDOR_JOIN_POLYS);
+    if (dtStatusFailed(dtResult) || !visitedCount)
+    {
+        PathCache::RecordJoin(false);
+        return 0;
+    }
+
+    // fixupCorridor takes the walk ending at the new start of the corridor
+    std::reverse(visited, visited + visitedCount);
+    uint32 length = std::min(uint32(corridor.size()), maxPolyLength);
+    std::copy(corridor.begin(), corridor.begin() + length, m_pathPolyRefs.begin());
+    length = fixupCorridor(m_pathPolyRefs.data(), length, maxPolyLength, visited, visitedCount);
+
+    // the walk never touched the corridor
+    bool joined = m_pathPolyRefs[0] == startPoly;
+    PathCache::RecordJoin(joined);
+    return joined ? length : 0;
+}
+
 uint32 PathFinder::fixupCorridor(dtPolyRef* path, uint32 npath, uint32 maxPath, dtPolyRef const* visited, uint32 nvisited)
 {
     int32 furthestPath = -1;
@@ -1349,6 +1501,12 @@ dtStatus PathFinder::findSmoothPath(const float* startPos, const float* endPos,
 }
 
 void PathFinder::ComputePathToRandomPoint(Vector3 const& startPoint, float maxRange)
+{
+    CancelAsync();
+    BuildPathToRandomPoint(startPoint, maxRange);
+}
+
+void PathFinder::BuildPathToRandomPoint(Vector3 const& startPoint, float maxRange)
 {
     clear();
     m_type = PathType(PATHFIND_NOPATH);
@@ -30,6 +30,8 @@ using Movement::Vector3;
 using Movement::PointsArray;
 
 class Unit;
+class Map;
+class PathCache;
 
 // 74*4.0f=296y  number_of_points*interval = max_path_len
 // this is way more than actual evade range
@@ -54,6 +56,10 @@ class Unit;
 #define VERTEX_SIZE       3
 #define INVALID_POLYREF   0
 
+// joining a cached corridor, see PathFinder::FindCachedPolyPath
+#define MAX_CORRIDOR_JOIN_DIST    10.0f
+#define MAX_CORRIDOR_JOIN_POLYS   16
+
 // bound box of poly search area
 static float NearPolySearchBound[VERTEX_SIZE] = { 5.0f, 5.0f, 5.0f };
 static float FarPolySearchBound[VERTEX_SIZE] = { 10.0f, 10.0f, 10.0f };
@@ -69,6 +75,13 @@ enum PathType
     PATHFIND_SHORT          = 0x0020,   // path is longer or equal to its limited path length
 };
 
+enum PathAsyncState
+{
+    PATH_ASYNC_NONE         = 0,        // no calculation queued
+    PATH_ASYNC_QUEUED       = 1,        // waiting for the path workers of the map
+    PATH_ASYNC_DONE         = 2,        // calculated, result not taken yet
+};
+
 class PathFinder
 {
     public:
@@ -83,6 +96,17 @@ class PathFinder
         // compute a straight path to some random point in max range
         void ComputePathToRandomPoint(Vector3 const& startPoint, float maxRange);
 
+        // Queue the calculation for the path workers of the owner's map, see Map::ProcessPathRequests.
+        // The result is ready from the next map update on. The synchronous calls cancel a queued calculation.
+        void calculateAsync(float destX, float destY, float destZ, bool forceDest = false, bool straightLine = false);
+        void ComputePathToRandomPointAsync(Vector3 const& startPoint, float maxRange);
+        bool IsAsyncPending() const { return m_asyncState == PATH_ASYNC_QUEUED; }
+        // true once after a queued calculation finished, the result getters then return its path
+        bool TakeAsyncResult();
+        void CancelAsync();
+        // executes a queued calculation, called by the path workers
+        void ExecuteAsync();
+
         // option setters - use optional
         void setUseStrightPath(bool useStraightPath) { m_useStraightPath = useStraightPath; };
         void setPathLengthLimit(float distance) { m_pointPathLimit = std::min<uint32>(uint32(distance / SMOOTH_PATH_STEP_SIZE * 1.25f), MAX_POINT_PATH_LENGTH); };
@@ -135,6 +159,21 @@ class PathFinder
 
         bool                    m_ignoreNormalization;
 
+        struct AsyncRequest
+        {
+            Vector3 start;
+            Vector3 dest;
+            float range;
+            bool forceDest;
+            bool straightLine;
+            bool randomPoint;
+        };
+
+        AsyncRequest            m_asyncRequest;
+        PathAsyncState          m_asyncState;
+        Map*                    m_asyncMap;         // map the calculation is queued on
+        bool                    m_useThreadQuery;   // calculating on a path worker, the map's query belongs to the map thread
+
         dtQueryFilter m_filter;                     // use single filter for all movements, update it when needed
 
         void setStartPosition(const Vector3& point) { m_startPosition = point; }
@@ -142,6 +181,8 @@ class PathFinder
         void setActualEndPosition(const Vector3& point) { m_actualEndPosition = point; }
         void NormalizePath();
         void SetCurrentNavMesh();
+        bool BuildPath(Vector3 const& start, Vector3 const& dest, bool forceDest, bool straightLine);
+        void BuildPathToRandomPoint(Vector3 const& startPoint, float maxRange);
 
         void clear()
         {
@@ -158,6 +199,8 @@ class PathFinder
         bool HaveTile(const Vector3& p) const;
 
         void BuildPolyPath(const Vector3& startPos, const Vector3& endPos);
+        PathCache* GetPathCache() const;
+        uint32 FindCachedPolyPath(PathCache& cache, dtPolyRef startPoly, const float* startPoint, dtPolyRef endPoly, const float* endPoint, uint32 maxPolyLength);
         void BuildPointPath(const float* startPoint, const float* endPoint);
         void BuildShortcut();
 #ifdef ENABLE_PLAYERBOTS
@@ -50,6 +50,9 @@ void AbstractRandomMovementGenerator::Initialize(Unit& owner)
 
 void AbstractRandomMovementGenerator::Finalize(Unit& owner)
 {
+    if (m_pathFinder)
+        m_pathFinder->CancelAsync();
+
     owner.clearUnitState(i_stateActive | i_stateMotion);
 
     // Client-controlled unit should have control restored
@@ -68,6 +71,9 @@ void AbstractRandomMovementGenerator::Finalize(Unit& owner)
 
 void AbstractRandomMovementGenerator::Interrupt(Unit& owner)
 {
+    if (m_pathFinder)
+        m_pathFinder->CancelAsync();
+
     owner.InterruptMoving();
 
     owner.clearUnitState(i_stateMotion);
@@ -96,7 +102,7 @@ bool AbstractRandomMovementGenerator::Update(Unit& owner, const uint32& diff)
     {
         i_nextMoveTimer.Update(diff);
 
-        if (i_nextMoveTimer.Passed())
+        if (i_nextMoveTimer.Passed() && !m_pathFinder->IsAsyncPending())
         {
             if (_setLocation(owner))
             {
@@ -108,7 +114,7 @@ bool AbstractRandomMovementGenerator::Update(Unit& owner, const uint32& diff)
                     i_nextMoveTimer.Reset(urand(i_nextMoveDelayMin, i_nextMoveDelayMax));
                 }
             }
-            else
+            else if (!m_pathFinder->IsAsyncPending())
                 i_nextMoveTimer.Reset(owner.HasFlag(UNIT_FIELD_FLAGS, UNIT_FLAG_PLAYER_CONTROLLED) ? 100 : 500);
         }
     }
@@ -124,7 +130,15 @@ int32 AbstractRandomMovementGenerator::_setLocation(Unit& owner)
     if (i_pathLength != 0.0f)
         m_pathFinder->setPathLengthLimit(i_pathLength);
 
-    m_pathFinder->ComputePathToRandomPoint(Vector3(x, y, z), i_radius);
+    if (!i_asyncPath)
+        m_pathFinder->ComputePathToRandomPoint(Vector3(x, y, z), i_radius);
+    else if (!m_pathFinder->TakeAsyncResult())
+    {
+        m_pathFinder->ComputePathToRandomPointAsync(Vector3(x, y, z), i_radius);
+        // calculated right away when the owner is not in a map
+        if (!m_pathFinder->TakeAsyncResult())
+            return 0;
+    }
 
     if ((m_pathFinder->getPathType() & PATHFIND_NOPATH) != 0)
         return 0;
@@ -170,6 +184,7 @@ WanderMovementGenerator::WanderMovementGenerator(Unit const& unit, float x, floa
     i_z = z;
     i_radius = radius;
     i_verticalZ = verticalZ;
+    i_asyncPath = true;
     if (unit.IsCreature())
         i_randomRunWander = static_cast<Creature const&>(unit).GetCreatureInfo()->HasFlag(CREATURE_EXTRA_FLAG_RUN_DURING_WANDER);
 }
@@ -178,6 +193,7 @@ WanderMovementGenerator::WanderMovementGenerator(const Creature& npc) :
     AbstractRandomMovementGenerator(UNIT_STAT_ROAMING, UNIT_STAT_ROAMING_MOVE, 3000, 10000, 3)
 {
     i_randomRunWander = npc.GetCreatureInfo()->HasFlag(CREATURE_EXTRA_FLAG_RUN_DURING_WANDER);
+    i_asyncPath = true;
     npc.GetRespawnCoord(i_x, i_y, i_z, nullptr, &i_radius);
 }
 
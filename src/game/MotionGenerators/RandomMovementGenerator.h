@@ -28,7 +28,7 @@ class AbstractRandomMovementGenerator : public MovementGenerator
 {
     public:
         explicit AbstractRandomMovementGenerator(uint32 stateActive, uint32 stateMotion, uint32 delayMin, uint32 delayMax, uint32 movesMax = 1, bool walk = true) :
-            i_x(0.0f), i_y(0.0f), i_z(0.0f), i_radius(0.0f), i_verticalZ(0.0f), i_pathLength(0.0f), i_walk(walk), i_randomRunWander(false),
+            i_x(0.0f), i_y(0.0f), i_z(0.0f), i_radius(0.0f), i_verticalZ(0.0f), i_pathLength(0.0f), i_walk(walk), i_randomRunWander(false), i_asyncPath(false),
             i_nextMoveTimer(0), i_nextMoveCount(1), i_nextMoveCountMax(movesMax),
             i_nextMoveDelayMin(delayMin), i_nextMoveDelayMax(delayMax),
             i_stateActive(stateActive), i_stateMotion(stateMotion)
@@ -50,6 +50,7 @@ class AbstractRandomMovementGenerator : public MovementGenerator
         float i_pathLength;
         bool i_walk;
         bool i_randomRunWander;
+        bool i_asyncPath;                                   // path calculated by the map's path workers, launched a tick later
 
         std::unique_ptr<PathFinder> m_pathFinder;
         ShortTimeTracker i_nextMoveTimer;
@@ -147,6 +147,8 @@ void ChaseMovementGenerator::Initialize(Unit& owner)
 
 void ChaseMovementGenerator::Finalize(Unit& owner)
 {
+    if (i_path)
+        i_path->CancelAsync();
     owner.clearUnitState(UNIT_STAT_CHASE | UNIT_STAT_CHASE_MOVE);
     if (m_currentMode == CHASE_MODE_DISTANCING) // cleanup in case fanning was removed
         owner.AI()->DistancingEnded();
@@ -154,6 +156,8 @@ void ChaseMovementGenerator::Finalize(Unit& owner)
 
 void ChaseMovementGenerator::Interrupt(Unit& owner)
 {
+    if (i_path)
+        i_path->CancelAsync();
     owner.InterruptMoving();
     owner.clearUnitState(UNIT_STAT_CHASE_MOVE);
     if (m_currentMode == CHASE_MODE_DISTANCING)
@@ -227,6 +231,7 @@ void ChaseMovementGenerator::HandleTargetedMovement(Unit& owner, const uint32& t
     G3D::Vector3 currentTargetPos;
     this->i_target->GetPosition(currentTargetPos.x, currentTargetPos.y, currentTargetPos.z, owner.GetTransport());
     this->i_recheckDistance.Update(time_diff);
+    HandleAsyncPath(owner);
     if (m_closenessAndFanningTimer) // here because always need to update timer, cant reuse the timer class because we need a disablable timer
     {
         if (m_closenessAndFanningTimer <= time_diff)
@@ -269,7 +274,9 @@ void ChaseMovementGenerator::HandleTargetedMovement(Unit& owner, const uint32& t
 
             if (owner.GetDistance(x, y, z, DIST_CALC_NONE) > 0.3f)
             {
-                if (DispatchSplineToPosition(owner, x, y, z, EnableWalking(), true, true, true))
+                // while running the current spline the new path can wait for the map's path workers
+                bool async = targetMoved && !owner.movespline->Finalized() && m_currentMode == CHASE_MODE_NORMAL && !owner.IsDebuggingMovement();
+                if (DispatchSplineToPosition(owner, x, y, z, EnableWalking(), true, true, true, async))
                 {
                     this->i_targetReached = false;
                     this->i_speedChanged = false;
@@ -474,7 +481,27 @@ void ChaseMovementGenerator::FanOut(Unit& owner)
     }
 }
 
-bool ChaseMovementGenerator::DispatchSplineToPosition(Unit& owner, float x, float y, float z, bool walk, bool cutPath, bool target, bool checkReachable)
+void ChaseMovementGenerator::HandleAsyncPath(Unit& owner)
+{
+    if (!this->i_path || !this->i_path->TakeAsyncResult())
+        return;
+
+    // distancing or a failure took over in the meantime
+    if (m_currentMode != CHASE_MODE_NORMAL || owner.movespline->Finalized())
+        return;
+
+    if (this->i_path->getPathType() & PATHFIND_NOPATH)
+    {
+        if (!IsReachablePositionToTarget(owner, owner.GetPositionX(), owner.GetPositionY(), owner.GetPositionZ(), *this->i_target.getTarget()))
+            m_reachable = false;
+        return;
+    }
+
+    owner.UpdateSplinePosition();
+    LaunchPath(owner, m_pendingLaunch.walk, m_pendingLaunch.cutPath, m_pendingLaunch.target, m_pendingLaunch.checkReachable);
+}
+
+bool ChaseMovementGenerator::DispatchSplineToPosition(Unit& owner, float x, float y, float z, bool walk, bool cutPath, bool target, bool checkReachable, bool async)
 {
     if (owner.IsDebuggingMovement())
     {
@@ -537,11 +564,24 @@ bool ChaseMovementGenerator::DispatchSplineToPosition(Unit& owner, float x, floa
 
     if (!gen || (this->i_path->getPathType() & (PATHFIND_NOPATH | PATHFIND_INCOMPLETE)))
     {
+        // current spline keeps going, HandleAsyncPath launches the path once it is calculated
+        if (async)
+        {
+            m_pendingLaunch = { walk, cutPath, target, checkReachable };
+            this->i_path->calculateAsync(x, y, z);
+            return true;
+        }
+
         this->i_path->calculate(x, y, z);
         if (this->i_path->getPathType() & PATHFIND_NOPATH)
             return false;
     }
 
+    return LaunchPath(owner, walk, cutPath, target, checkReachable);
+}
+
+bool ChaseMovementGenerator::LaunchPath(Unit& owner, bool walk, bool cutPath, bool target, bool checkReachable)
+{
     auto& path = this->i_path->getPath();
 
     if (cutPath)
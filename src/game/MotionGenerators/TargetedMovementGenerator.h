@@ -114,7 +114,7 @@ class ChaseMovementGenerator : public TargetedMovementGeneratorMedium<Unit, Chas
         ChaseMovementGenerator(Unit& target, float offset, float angle, bool moveFurther = true, bool walk = false, bool combat = true)
             : TargetedMovementGeneratorMedium<Unit, ChaseMovementGenerator >(target, offset, angle),
             m_moveFurther(moveFurther), m_walk(walk), m_combat(combat), m_reachable(true),
-            m_fanningEnabled(true), m_backpedalEnabled(true), m_currentMode(CHASE_MODE_NORMAL), m_closenessAndFanningTimer(0), m_closenessExpired(false) {}
+            m_fanningEnabled(true), m_backpedalEnabled(true), m_currentMode(CHASE_MODE_NORMAL), m_closenessAndFanningTimer(0), m_closenessExpired(false), m_pendingLaunch() {}
         ~ChaseMovementGenerator() {}
 
         MovementGeneratorType GetMovementGeneratorType() const override { return CHASE_MOTION_TYPE; }
@@ -159,7 +159,9 @@ class ChaseMovementGenerator : public TargetedMovementGeneratorMedium<Unit, Chas
 
         bool IsReachablePositionToTarget(Unit& owner, float x, float y, float z, Unit& target);
 
-        bool DispatchSplineToPosition(Unit& owner, float x, float y, float z, bool walk, bool cutPath, bool target = false, bool checkReachable = false);
+        bool DispatchSplineToPosition(Unit& owner, float x, float y, float z, bool walk, bool cutPath, bool target = false, bool checkReachable = false, bool async = false);
+        bool LaunchPath(Unit& owner, bool walk, bool cutPath, bool target, bool checkReachable);
+        void HandleAsyncPath(Unit& owner);
         void CutPath(Unit& owner, PointsArray& path);
         void Backpedal(Unit& owner);
 
@@ -175,6 +177,15 @@ class ChaseMovementGenerator : public TargetedMovementGeneratorMedium<Unit, Chas
 
         ChaseMovementMode m_currentMode;
 
+        // spline options of the path being calculated by the map
+        struct PendingLaunch
+        {
+            bool walk;
+            bool cutPath;
+            bool target;
+            bool checkReachable;
+        } m_pendingLaunch;
+
         GuidVector m_spawns;
 };
 
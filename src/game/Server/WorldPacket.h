@@ -23,6 +23,7 @@
 #include "Util/ByteBuffer.h"
 #include "Server/Opcodes.h"
 #include <chrono>
+#include <memory>
 
 // Note: m_opcode and size stored in platfom dependent format
 // ignore endianess until send, and converted at receive
@@ -53,4 +54,16 @@ class WorldPacket : public ByteBuffer
         Opcodes m_opcode;
         std::chrono::steady_clock::time_point m_receivedTime; // only set for a specific set of opcodes, for performance reasons.
 };
+
+// Immutable packet for broadcasts - the body is built once and only referenced by the send queue of every recipient socket
+typedef std::shared_ptr<WorldPacket const> SharedWorldPacket;
+
+// smaller bodies are cheaper to copy into every send queue than to share
+#define MIN_SHARED_PACKET_SIZE 64
+
+// copy of a broadcast packet to share between the recipients, null if the body is too small to be worth it
+inline SharedWorldPacket ShareWorldPacket(WorldPacket const& packet)
+{
+    return packet.size() >= MIN_SHARED_PACKET_SIZE ? std::make_shared<WorldPacket const>(packet) : nullptr;
+}
 #endif
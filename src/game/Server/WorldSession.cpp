@@ -193,8 +193,8 @@ void WorldSession::SetPlayer(Player* plr, uint32 playerGuid)
     m_anticheat->NewPlayer();
 }
 
-/// Send a packet to the client
-void WorldSession::SendPacket(WorldPacket const& packet, bool forcedSend /*= false*/) const
+/// Send a packet to the client, a broadcast packet passes its shared copy (see ShareWorldPacket) so the socket can reference the body
+void WorldSession::SendPacket(WorldPacket const& packet, bool forcedSend /*= false*/, SharedWorldPacket const* sharedPacket /*= nullptr*/) const
 {
 #if defined(BUILD_DEPRECATED_PLAYERBOT) || defined(ENABLE_PLAYERBOTS)
     // Send packet to bot AI
@@ -249,7 +249,10 @@ void WorldSession::SendPacket(WorldPacket const& packet, bool forcedSend /*= fal
 
 #endif                                                  // !MANGOS_DEBUG
 
-    m_socket->SendPacket(packet);
+    if (sharedPacket && *sharedPacket)
+        m_socket->SendPacket(*sharedPacket);
+    else
+        m_socket->SendPacket(packet);
 }
 
 /// Add an incoming packet to the queue
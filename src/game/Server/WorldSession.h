@@ -222,7 +222,9 @@ class WorldSession
 
         void SizeError(WorldPacket const& packet, uint32 size) const;
 
-        void SendPacket(WorldPacket const& packet, bool forcedSend = false) const;
+        // the shared packet (SharedWorldPacket) is spelled out, WorldPacket.h includes this header through Opcodes.h
+        void SendPacket(WorldPacket const& packet, bool forcedSend = false, std::shared_ptr<WorldPacket const> const* sharedPacket = nullptr) const;
+        void SendPacket(WorldPacket const& packet, std::shared_ptr<WorldPacket const> const& sharedPacket) const { SendPacket(packet, false, &sharedPacket); }
         void SendExpectedSpamRecords();
         void SendMotd(Player* currChar);
         void SendOfflineNameQueryResponses();
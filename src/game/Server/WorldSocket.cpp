@@ -43,6 +43,11 @@
 #include <utility>
 #include <vector>
 
+/// send buffers bigger than this are released after their write completed
+#define MAX_KEPT_SEND_BUFFER_SIZE (64 * 1024)
+/// time the packets queued before a Close() get to be written
+#define CLOSE_WRITE_TIMEOUT 5
+
 #if defined( __GNUC__ )
 #pragma pack(1)
 #else
@@ -93,11 +98,21 @@ std::deque<uint32> WorldSocket::GetIncOpcodeHistory()
 }
 
 WorldSocket::WorldSocket(boost::asio::io_context& context) : AsyncSocket(context), m_lastPingTime(std::chrono::system_clock::time_point::min()), m_overSpeedPings(0),
-    m_session(nullptr), m_seed(urand()), m_loggingPackets(false)
+    m_session(nullptr), m_seed(urand()), m_writeInProgress(false), m_flushScheduled(false), m_closing(false), m_closeTimer(context), m_loggingPackets(false)
 {
 }
 
 void WorldSocket::SendPacket(const WorldPacket& pct)
+{
+    QueuePacket(pct, nullptr);
+}
+
+void WorldSocket::SendPacket(SharedWorldPacket const& pct)
+{
+    QueuePacket(*pct, &pct);
+}
+
+void WorldSocket::QueuePacket(const WorldPacket& pct, SharedWorldPacket const* sharedPct)
 {
     if (IsClosed())
         return;
@@ -111,6 +126,9 @@ void WorldSocket::SendPacket(const WorldPacket& pct)
     // encrypt thread unsafe due to being executed from map contexts frequently - TODO: move to post service context in future
     std::lock_guard<std::mutex> guard(m_worldSocketMutex);
 
+    if (m_closing)
+        return;
+
     ServerPktHeader header;
 
     header.cmd = pct.GetOpcode();
@@ -127,21 +145,109 @@ void WorldSocket::SendPacket(const WorldPacket& pct)
     if (m_opcodeHistoryOut.size() > 50)
         m_opcodeHistoryOut.resize(30);
 
-    if (pct.size() > 0)
+    // queue the packet, all packets sent until the socket thread gets to the flush go out in one write
+    m_outQueue.data.insert(m_outQueue.data.end(), reinterpret_cast<const uint8*>(header.data()), reinterpret_cast<const uint8*>(header.data()) + header.headerSize());
+    if (sharedPct && pct.size() >= MIN_SHARED_PACKET_SIZE)
+        m_outQueue.sharedBodies.emplace_back(m_outQueue.data.size(), *sharedPct);
+    else if (pct.size() > 0)
+        m_outQueue.data.insert(m_outQueue.data.end(), pct.contents(), pct.contents() + pct.size());
+
+    if (m_writeInProgress || m_flushScheduled)
+        return;
+
+    m_flushScheduled = true;
+    auto self(shared_from_this());
+    boost::asio::post(GetAsioSocket().get_executor(), [self]() { self->FlushOutgoing(); });
+}
+
+void WorldSocket::FlushOutgoing()
+{
+    std::lock_guard<std::mutex> guard(m_worldSocketMutex);
+
+    m_flushScheduled = false;
+    if (!m_writeInProgress)
+        StartWrite();
+}
+
+void WorldSocket::StartWrite()
+{
+    if (m_outQueue.empty() || IsClosed())
+        return;
+
+    std::swap(m_outQueue, m_writeQueue);
+    m_writeInProgress = true;
+
+    // interleave the copied data with the referenced bodies
+    m_writeBuffers.clear();
+    size_t pos = 0;
+    for (auto& sharedBody : m_writeQueue.sharedBodies)
     {
-        // allocate array for full message
-        std::shared_ptr<std::vector<char>> fullMessage = std::make_shared<std::vector<char>>(header.headerSize() + pct.size());
-        std::memcpy(fullMessage->data(), header.data(), header.headerSize()); // copy header
-        std::memcpy((fullMessage->data() + header.headerSize()), reinterpret_cast<const char*>(pct.contents()), pct.size()); // copy packet
-        auto self(shared_from_this());
-        Write(fullMessage->data(), fullMessage->size(), [self, fullMessage](const boost::system::error_code& /*error*/, std::size_t /*written*/) {});
+        if (sharedBody.first > pos)
+            m_writeBuffers.emplace_back(m_writeQueue.data.data() + pos, sharedBody.first - pos);
+        m_writeBuffers.emplace_back(sharedBody.second->contents(), sharedBody.second->size());
+        pos = sharedBody.first;
     }
-    else
+    if (m_writeQueue.data.size() > pos)
+        m_writeBuffers.emplace_back(m_writeQueue.data.data() + pos, m_writeQueue.data.size() - pos);
+
+    auto self(shared_from_this());
+    Write(m_writeBuffers, [self](const boost::system::error_code& error, std::size_t /*written*/)
+    {
+        std::lock_guard<std::mutex> guard(self->m_worldSocketMutex);
+
+        self->m_writeInProgress = false;
+        self->m_writeQueue.clear();
+
+        // do not keep the memory of a single burst (e.g. initial login data) for the whole session
+        if (self->m_writeQueue.data.capacity() > MAX_KEPT_SEND_BUFFER_SIZE)
+            std::vector<uint8>().swap(self->m_writeQueue.data);
+
+        // the connection is broken, nothing is queued or written anymore
+        if (error)
+        {
+            self->m_closing = true;
+            self->m_outQueue.clear();
+            self->AsyncSocket::Close();
+            return;
+        }
+
+        // packets queued meanwhile
+        if (!self->m_outQueue.empty())
+            self->StartWrite();
+        else if (self->m_closing)
+            self->AsyncSocket::Close();
+    });
+}
+
+void WorldSocket::Close()
+{
     {
-        std::shared_ptr<ServerPktHeader> sharedHeader = std::make_shared<ServerPktHeader>(header);
-        auto self(shared_from_this());
-        Write(sharedHeader->data(), sharedHeader->headerSize(), [self, sharedHeader](const boost::system::error_code& /*error*/, std::size_t /*written*/) {});
+        std::lock_guard<std::mutex> guard(m_worldSocketMutex);
+
+        if (m_closing)
+            return;
+
+        if (!IsClosed() && (m_writeInProgress || !m_outQueue.empty()))
+        {
+            // stop reading and let the write completion close the socket, a client that does not read gets closed anyway
+            m_closing = true;
+            boost::system::error_code ec;
+            GetAsioSocket().shutdown(boost::asio::ip::tcp::socket::shutdown_receive, ec);
+
+            auto self(shared_from_this());
+            m_closeTimer.expires_after(std::chrono::seconds(CLOSE_WRITE_TIMEOUT));
+            m_closeTimer.async_wait([self](const boost::system::error_code& error)
+            {
+                if (!error)
+                    self->AsyncSocket::Close();
+            });
+
+            // a flush that is only scheduled still writes the queue
+            return;
+        }
     }
+
+    AsyncSocket::Close();
 }
 
 bool WorldSocket::OnOpen()
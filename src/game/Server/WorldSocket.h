@@ -120,6 +120,33 @@ class WorldSocket : public MaNGOS::AsyncSocket<WorldSocket>
 
         std::mutex m_worldSocketMutex;
 
+        /// Outgoing data, headers and small bodies are copied, shared broadcast bodies are only referenced
+        struct SendQueue
+        {
+            std::vector<uint8> data;
+            std::vector<std::pair<size_t, std::shared_ptr<WorldPacket const>>> sharedBodies;    // body goes out after data[0, first)
+
+            bool empty() const { return data.empty(); }     // every body has a header in data
+            void clear() { data.clear(); sharedBodies.clear(); }
+        };
+
+        /// Packets queued since the last write, guarded by m_worldSocketMutex
+        SendQueue m_outQueue;
+        /// Data of the write in flight, swapped with m_outQueue so both buffers are reused
+        SendQueue m_writeQueue;
+        std::vector<boost::asio::const_buffer> m_writeBuffers;
+        bool m_writeInProgress;
+        bool m_flushScheduled;
+        /// Close() was called while packets were still queued or a write failed, no more packets are queued
+        bool m_closing;
+        boost::asio::steady_timer m_closeTimer;
+
+        void QueuePacket(const WorldPacket& pct, std::shared_ptr<WorldPacket const> const* sharedPct);
+        /// Writes all queued packets at once, runs in the socket service context
+        void FlushOutgoing();
+        /// Starts the next write, m_worldSocketMutex must be held
+        void StartWrite();
+
         std::deque<uint32> m_opcodeHistoryOut;
         std::deque<uint32> m_opcodeHistoryInc;
 
@@ -130,9 +157,14 @@ class WorldSocket : public MaNGOS::AsyncSocket<WorldSocket>
 
         // send a packet \o/
         void SendPacket(const WorldPacket& pct);
+        // send a broadcast packet (SharedWorldPacket), the body is not copied
+        void SendPacket(std::shared_ptr<WorldPacket const> const& pct);
 
         void FinalizeSession() { m_session = nullptr; }
 
+        /// Closes the socket once the packets queued so far are written, so e.g. the reason of an auth failure reaches the client
+        void Close() override;
+
         bool OnOpen() override;
 
         /// Return the session key
@@ -47,6 +47,7 @@
 #include "Spells/Scripts/SpellScript.h"
 #include "Entities/ObjectGuid.h"
 #include "Spells/SpellStacking.h"
+#include "Utilities/ObjectPool.h"
 
 #ifdef ENABLE_PLAYERBOTS
 #include "playerbot/PlayerbotAI.h"
@@ -384,6 +385,18 @@ void SpellLog::SendToSet()
 // Spell class
 // ***********
 
+static ObjectPool s_spellPool("Spell");
+
+void* Spell::operator new(size_t size)
+{
+    return s_spellPool.Allocate(size);
+}
+
+void Spell::operator delete(void* ptr, size_t size)
+{
+    s_spellPool.Deallocate(ptr, size);
+}
+
 Spell::Spell(WorldObject* caster, SpellEntry const* info, uint32 triggeredFlags, ObjectGuid originalCasterGUID, SpellEntry const* triggeredBy) :
     m_partialApplicationMask(0), m_spellScript(SpellScriptMgr::GetSpellScript(info->Id)), m_auraScript(SpellScriptMgr::GetAuraScript(info->Id)),
     m_effectSkipMask(0),
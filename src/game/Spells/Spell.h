@@ -468,6 +468,10 @@ class Spell
         Spell(WorldObject* caster, SpellEntry const* info, uint32 triggeredFlags, ObjectGuid originalCasterGUID = ObjectGuid(), SpellEntry const* triggeredBy = nullptr);
         virtual ~Spell();
 
+        // allocated from a pool, see ObjectPool
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
+
         SpellCastResult SpellStart(SpellCastTargets const* targets, Aura* triggeredByAura = nullptr);
 
         void cancel();
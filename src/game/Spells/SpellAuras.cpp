@@ -49,6 +49,7 @@
 #include "Loot/LootMgr.h"
 #include "AI/ScriptDevAI/include/sc_grid_searchers.h"
 #include "Spells/SpellStacking.h"
+#include "Utilities/ObjectPool.h"
 
 #define NULL_AURA_SLOT 0xFF
 
@@ -254,6 +255,18 @@ pAuraHandler AuraHandler[TOTAL_AURAS] =
 
 static AuraType const frozenAuraTypes[] = { SPELL_AURA_MOD_ROOT, SPELL_AURA_MOD_STUN, SPELL_AURA_NONE };
 
+static ObjectPool s_auraPool("Aura");
+
+void* Aura::operator new(size_t size)
+{
+    return s_auraPool.Allocate(size);
+}
+
+void Aura::operator delete(void* ptr, size_t size)
+{
+    s_auraPool.Deallocate(ptr, size);
+}
+
 Aura::Aura(SpellEntry const* spellproto, SpellEffectIndex eff, int32 const* currentDamage, int32 const* currentBasePoints, SpellAuraHolder* holder, Unit* target, Unit* caster, Item* castItem) :
     m_spellmod(nullptr), m_periodicTimer(0), m_periodicTick(0), m_removeMode(AURA_REMOVE_BY_DEFAULT),
     m_effIndex(eff), m_positive(false), m_isPeriodic(false), m_isAreaAura(false),
@@ -5147,6 +5160,18 @@ inline bool IsRemovedOnShapeshiftLost(SpellEntry const* spellproto, ObjectGuid c
     /*TODO: investigate spellid 24864  or (SpellFamilyName = 7 and EffectApplyAuraName_1 = 49 and stances = 0)*/
 }
 
+static ObjectPool s_spellAuraHolderPool("SpellAuraHolder");
+
+void* SpellAuraHolder::operator new(size_t size)
+{
+    return s_spellAuraHolderPool.Allocate(size);
+}
+
+void SpellAuraHolder::operator delete(void* ptr, size_t size)
+{
+    s_spellAuraHolderPool.Deallocate(ptr, size);
+}
+
 SpellAuraHolder::SpellAuraHolder(SpellEntry const* spellproto, Unit* target, WorldObject* caster, Item* castItem, SpellEntry const* triggeredBy) :
     m_spellProto(spellproto), m_target(target),
     m_castItemGuid(castItem ? castItem->GetObjectGuid() : ObjectGuid()), m_triggeredBy(triggeredBy),
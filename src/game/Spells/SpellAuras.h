@@ -96,6 +96,10 @@ class SpellAuraHolder
     public:
         SpellAuraHolder(SpellEntry const* spellproto, Unit* target, WorldObject* caster, Item* castItem, SpellEntry const* triggeredBy);
         ~SpellAuraHolder();
+
+        // allocated from a pool, see ObjectPool
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
         Aura* m_auras[MAX_EFFECT_INDEX];
 
         void AddAura(Aura* aura, SpellEffectIndex index);
@@ -409,6 +413,10 @@ class Aura
 
         virtual ~Aura();
 
+        // allocated from a pool, see ObjectPool
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
+
         void SetModifier(AuraType type, int32 amount, uint32 periodicTime, int32 miscValue);
         Modifier*       GetModifier()       { return &m_modifier; }
         Modifier const* GetModifier() const { return &m_modifier; }
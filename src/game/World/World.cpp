@@ -51,6 +51,7 @@
 #include "OutdoorPvP/OutdoorPvP.h"
 #include "VMapFactory.h"
 #include "MotionGenerators/MoveMap.h"
+#include "MotionGenerators/PathCache.h"
 #include "GameEvents/GameEventMgr.h"
 #include "Pools/PoolManager.h"
 #include "Database/DatabaseImpl.h"
@@ -69,6 +70,7 @@
 #include "Anticheat/Anticheat.hpp"
 #include "LFG/LFGMgr.h"
 #include "Spells/SpellStacking.h"
+#include "Utilities/ObjectPool.h"
 
 #ifdef BUILD_AHBOT
  #include "AuctionHouseBot/AuctionHouseBot.h"
@@ -166,6 +168,8 @@ World::~World()
         m_lfgQueueThread.join();
     if (m_bgQueueThread.joinable())
         m_bgQueueThread.join();
+    if (m_auctionHouseSearchThread.joinable())
+        m_auctionHouseSearchThread.join();
 }
 
 /// Cleanups before world stop
@@ -477,6 +481,7 @@ void World::LoadConfigSettings(bool reload)
 
     ///- Read other configuration items from the config file
     setConfigMinMax(CONFIG_UINT32_COMPRESSION, "Compression", 1, 1, 9);
+    setConfig(CONFIG_UINT32_COMPRESSION_THRESHOLD, "Compression.Threshold", 100);
     setConfig(CONFIG_BOOL_ADDON_CHANNEL, "AddonChannel", true);
     setConfig(CONFIG_BOOL_CLEAN_CHARACTER_DB, "CleanCharacterDB", true);
     setConfig(CONFIG_BOOL_GRID_UNLOAD, "GridUnload", true);
@@ -502,6 +507,8 @@ void World::LoadConfigSettings(bool reload)
     if (reload)
         sMapMgr.SetGridCleanUpDelay(getConfig(CONFIG_UINT32_INTERVAL_GRIDCLEAN));
 
+    setConfig(CONFIG_UINT32_GRID_PREFETCH_LOOKAHEAD, "GridPrefetch.Lookahead", 0);
+
     setConfigMin(CONFIG_UINT32_INTERVAL_MAPUPDATE, "MapUpdateInterval", 100, MIN_MAP_UPDATE_DELAY);
     if (reload)
         sMapMgr.SetMapUpdateInterval(getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE));
@@ -623,6 +630,7 @@ void World::LoadConfigSettings(bool reload)
     }
 
     setConfig(CONFIG_UINT32_NUM_MAP_THREADS, "MapUpdate.Threads", 3);
+    setConfig(CONFIG_BOOL_MAP_UPDATE_PARTITIONED, "MapUpdate.Partitioned", false);
     setConfig(CONFIG_UINT32_SKILL_CHANCE_ORANGE, "SkillChance.Orange", 100);
     setConfig(CONFIG_UINT32_SKILL_CHANCE_YELLOW, "SkillChance.Yellow", 75);
     setConfig(CONFIG_UINT32_SKILL_CHANCE_GREEN,  "SkillChance.Green",  25);
@@ -742,6 +750,7 @@ void World::LoadConfigSettings(bool reload)
 
     m_relocation_ai_notify_delay = sConfig.GetIntDefault("Visibility.AIRelocationNotifyDelay", 1000u);
     m_relocation_lower_limit_sq = pow(sConfig.GetFloatDefault("Visibility.RelocationLowerLimit", 10), 2);
+    setConfig(CONFIG_BOOL_VISIBILITY_BATCH_RELOCATION, "Visibility.BatchRelocation", false);
 
     // Visibility on Continents
     m_MaxVisibleDistanceOnContinents      = sConfig.GetFloatDefault("Visibility.Distance.Continents",     DEFAULT_VISIBILITY_DISTANCE);
@@ -826,6 +835,9 @@ void World::LoadConfigSettings(bool reload)
                    enableLOS, enableHeight, getConfig(CONFIG_BOOL_VMAP_INDOOR_CHECK) ? 1 : 0);
     sLog.outString("WORLD: VMap data directory is: %svmaps", m_dataPath.c_str());
 
+    setConfig(CONFIG_UINT32_QUERY_CACHE_SIZE, "vmap.queryCacheSize", 0);
+    setConfigMin(CONFIG_FLOAT_QUERY_CACHE_QUANTIZATION, "vmap.queryCacheQuantization", 0.25f, 0.01f);
+
     setConfig(CONFIG_BOOL_MMAP_ENABLED, "mmap.enabled", true);
     std::string ignoreMapIds = sConfig.GetStringDefault("mmap.ignoreMapIds");
     setConfig(CONFIG_BOOL_PRELOAD_MMAP_TILES, "mmap.preload", false);
@@ -836,6 +848,9 @@ void World::LoadConfigSettings(bool reload)
 
     setConfig(CONFIG_BOOL_PATH_FIND_OPTIMIZE, "PathFinder.OptimizePath", true);
     setConfig(CONFIG_BOOL_PATH_FIND_NORMALIZE_Z, "PathFinder.NormalizeZ", false);
+    setConfig(CONFIG_UINT32_PATH_CACHE_SIZE, "PathFinder.CacheSize", 0);
+    setConfig(CONFIG_UINT32_PATH_CACHE_LIFETIME, "PathFinder.CacheLifetime", 2000);
+    setConfigMin(CONFIG_FLOAT_PATH_CACHE_TARGET_DISTANCE, "PathFinder.CacheTargetDistance", 3.0f, 0.0f);
 
     setConfig(CONFIG_BOOL_REGEN_ZONE_AREA_ON_STARTUP, "Spawns.ZoneArea", false);
 
@@ -2620,6 +2635,62 @@ void World::GeneratePacketMetrics()
 
     metric::measurement meas_latency("world.metrics.latency");
     meas_latency.add_field("online", std::to_string(GetAverageLatency()));
+
+    UpdateCompressionStats compression = UpdateData::GetCompressionStats(true);
+    metric::measurement meas_compression("world.metrics.compression");
+    meas_compression.add_field("packets", std::to_string(compression.packets));
+    meas_compression.add_field("bytes_in", std::to_string(compression.bytesIn));
+    meas_compression.add_field("bytes_out", std::to_string(compression.bytesOut));
+    meas_compression.add_field("bytes_saved", std::to_string(int64(compression.bytesIn) - int64(compression.bytesOut)));
+    meas_compression.add_field("time_us", std::to_string(compression.timeUs));
+
+    auto measureAsyncDatabase = [](Database& db, char const* name)
+    {
+        SqlDelayStats stats = db.GetAsyncStats();
+        metric::measurement meas_db("db.async", { { "database", name } });
+        meas_db.add_field("queued", std::to_string(stats.queued));
+        meas_db.add_field("executed", std::to_string(stats.executed));
+        meas_db.add_field("latency_avg_us", std::to_string(stats.executed ? stats.latencySumUs / stats.executed : 0));
+        meas_db.add_field("latency_max_us", std::to_string(stats.latencyMaxUs));
+    };
+    measureAsyncDatabase(WorldDatabase, "world");
+    measureAsyncDatabase(CharacterDatabase, "characters");
+    measureAsyncDatabase(LoginDatabase, "realmd");
+    measureAsyncDatabase(LogsDatabase, "logs");
+
+    for (ObjectPoolStats const& stats : ObjectPool::GetAllStats())
+    {
+        metric::measurement meas_pool("world.metrics.pools", { { "pool", stats.name } });
+        meas_pool.add_field("live", std::to_string(stats.live));
+        meas_pool.add_field("high_water", std::to_string(stats.highWater));
+        meas_pool.add_field("allocations", std::to_string(stats.allocations));
+        meas_pool.add_field("recycled", std::to_string(stats.recycled));
+    }
+
+    GridPrefetchStats prefetch = GridPrefetcher::GetStats();
+    metric::measurement meas_prefetch("world.metrics.grid_prefetch");
+    meas_prefetch.add_field("requests", std::to_string(prefetch.requests));
+    meas_prefetch.add_field("hits", std::to_string(prefetch.hits));
+    meas_prefetch.add_field("misses", std::to_string(prefetch.misses));
+    meas_prefetch.add_field("hit_rate", std::to_string(prefetch.hits + prefetch.misses ? float(prefetch.hits) / (prefetch.hits + prefetch.misses) : 0.0f));
+    meas_prefetch.add_field("stall_avoided_us", std::to_string(prefetch.stallAvoidedUs));
+    meas_prefetch.add_field("map_load_us", std::to_string(prefetch.mapLoadUs));
+
+    MapQueryCacheStats queries = MapQueryCache::GetStats();
+    metric::measurement meas_queries("world.metrics.query_cache");
+    meas_queries.add_field("los_hits", std::to_string(queries.losHits));
+    meas_queries.add_field("los_misses", std::to_string(queries.losMisses));
+    meas_queries.add_field("los_hit_rate", std::to_string(queries.losHits + queries.losMisses ? float(queries.losHits) / (queries.losHits + queries.losMisses) : 0.0f));
+    meas_queries.add_field("height_hits", std::to_string(queries.heightHits));
+    meas_queries.add_field("height_misses", std::to_string(queries.heightMisses));
+    meas_queries.add_field("height_hit_rate", std::to_string(queries.heightHits + queries.heightMisses ? float(queries.heightHits) / (queries.heightHits + queries.heightMisses) : 0.0f));
+    meas_queries.add_field("invalidated", std::to_string(queries.invalidated));
+
+    PathCacheStats paths = PathCache::GetStats();
+    metric::measurement meas_paths("world.metrics.path_cache");
+    meas_paths.add_field("hits", std::to_string(paths.hits));
+    meas_paths.add_field("joined", std::to_string(paths.joined));
+    meas_paths.add_field("misses", std::to_string(paths.misses));
 }
 
 uint32 World::GetAverageLatency() const
@@ -2745,3 +2816,11 @@ void World::StartBGQueueThread()
         m_bgQueue.Update();
     });
 }
+
+void World::StartAuctionHouseSearchThread()
+{
+    m_auctionHouseSearchThread = std::thread([&]()
+    {
+        m_auctionHouseSearch.Update();
+    });
+}
@@ -32,6 +32,7 @@
 #include "Globals/GraveyardManager.h"
 #include "LFG/LFGQueue.h"
 #include "BattleGround/BattleGroundQueue.h"
+#include "AuctionHouse/AuctionHouseSearch.h"
 
 #include <set>
 #include <list>
@@ -93,6 +94,7 @@ enum WorldTimers
 enum eConfigUInt32Values
 {
     CONFIG_UINT32_COMPRESSION = 0,
+    CONFIG_UINT32_COMPRESSION_THRESHOLD,
     CONFIG_UINT32_INTERVAL_SAVE,
     CONFIG_UINT32_INTERVAL_GRIDCLEAN,
     CONFIG_UINT32_INTERVAL_MAPUPDATE,
@@ -200,6 +202,10 @@ enum eConfigUInt32Values
     CONFIG_UINT32_CREATURE_PICKPOCKET_RESTOCK_DELAY,
     CONFIG_UINT32_CHANNEL_STATIC_AUTO_TRESHOLD,
     CONFIG_UINT32_LFG_MATCHMAKING_TIMER,
+    CONFIG_UINT32_GRID_PREFETCH_LOOKAHEAD,
+    CONFIG_UINT32_QUERY_CACHE_SIZE,
+    CONFIG_UINT32_PATH_CACHE_SIZE,
+    CONFIG_UINT32_PATH_CACHE_LIFETIME,
     CONFIG_UINT32_VALUE_COUNT
 };
 
@@ -285,6 +291,8 @@ enum eConfigFloatValues
     CONFIG_FLOAT_GHOST_RUN_SPEED_WORLD,
     CONFIG_FLOAT_GHOST_RUN_SPEED_BG,
     CONFIG_FLOAT_LEASH_RADIUS,
+    CONFIG_FLOAT_QUERY_CACHE_QUANTIZATION,
+    CONFIG_FLOAT_PATH_CACHE_TARGET_DISTANCE,
     CONFIG_FLOAT_VALUE_COUNT
 };
 
@@ -355,6 +363,8 @@ enum eConfigBoolValues
     CONFIG_BOOL_DISABLE_INSTANCE_RELOCATE,
     CONFIG_BOOL_PRELOAD_MMAP_TILES,
     CONFIG_BOOL_REGEN_ZONE_AREA_ON_STARTUP,
+    CONFIG_BOOL_MAP_UPDATE_PARTITIONED,
+    CONFIG_BOOL_VISIBILITY_BATCH_RELOCATION,
     CONFIG_BOOL_VALUE_COUNT
 };
 
@@ -604,8 +614,10 @@ class World
 
         LFGQueue& GetLFGQueue() { return m_lfgQueue; }
         BattleGroundQueue& GetBGQueue() { return m_bgQueue; }
+        AuctionHouseSearch& GetAuctionHouseSearch() { return m_auctionHouseSearch; }
         void StartLFGQueueThread();
         void StartBGQueueThread();
+        void StartAuctionHouseSearchThread();
     protected:
         void _UpdateGameTime();
         // callback for UpdateRealmCharacters
@@ -730,6 +742,8 @@ class World
         std::thread m_lfgQueueThread;
         BattleGroundQueue m_bgQueue;
         std::thread m_bgQueueThread;
+        AuctionHouseSearch m_auctionHouseSearch;
+        std::thread m_auctionHouseSearchThread;
 };
 
 extern uint32 realmID;
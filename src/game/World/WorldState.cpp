@@ -1257,13 +1257,11 @@ void WorldState::BroadcastSIWorldstates()
     uint32 remainingTanaris = GetSIRemaining(SI_REMAINING_TANARIS);
     uint32 remainingWinterspring = GetSIRemaining(SI_REMAINING_WINTERSPRING);
 
-    HashMapHolder<Player>::MapType& m = sObjectAccessor.GetPlayers();
-    for (const auto& itr : m)
+    sObjectAccessor.ExecuteForAllPlayers([&](Player* pl)
     {
-        Player* pl = itr.second;
         // do not process players which are not in world
         if (!pl->IsInWorld())
-            continue;
+            return;
 
         pl->SendUpdateWorldState(WORLD_STATE_SCOURGE_AZSHARA, remainingAzshara > 0 ? 1 : 0);
         pl->SendUpdateWorldState(WORLD_STATE_SCOURGE_BLASTED_LANDS, remainingBlastedLands > 0 ? 1 : 0);
@@ -1279,7 +1277,7 @@ void WorldState::BroadcastSIWorldstates()
         pl->SendUpdateWorldState(WORLD_STATE_SCOURGE_NECROPOLIS_EASTERN_PLAGUELANDS, remainingEasternPlaguelands);
         pl->SendUpdateWorldState(WORLD_STATE_SCOURGE_NECROPOLIS_TANARIS, remainingTanaris);
         pl->SendUpdateWorldState(WORLD_STATE_SCOURGE_NECROPOLIS_WINTERSPRING, remainingWinterspring);
-    }
+    });
 }
 
 void WorldState::HandleDefendedZones()
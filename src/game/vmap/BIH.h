@@ -219,12 +219,24 @@ class BIH
                         {
                             // leaf - test some objects
                             int n = tree[node + 1];
-                            while (n > 0)
+                            // callbacks able to test all objects of a leaf at once get them in one call
+                            if constexpr (requires { intersectCallback.intersectLeaf(r, objects.data(), 0u, maxDist, stopAtFirst); })
                             {
-                                bool hit = intersectCallback(r, objects[offset], maxDist, stopAtFirst, ignoreM2Model);
-                                if (stopAtFirst && hit) return;
-                                --n;
-                                ++offset;
+                                if (n > 0)
+                                {
+                                    bool hit = intersectCallback.intersectLeaf(r, &objects[offset], uint32(n), maxDist, stopAtFirst);
+                                    if (stopAtFirst && hit) return;
+                                }
+                            }
+                            else
+                            {
+                                while (n > 0)
+                                {
+                                    bool hit = intersectCallback(r, objects[offset], maxDist, stopAtFirst, ignoreM2Model);
+                                    if (stopAtFirst && hit) return;
+                                    --n;
+                                    ++offset;
+                                }
                             }
                             break;
                         }
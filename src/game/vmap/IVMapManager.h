@@ -60,6 +60,13 @@ namespace VMAP
 
             virtual bool existsMap(const char* pBasePath, unsigned int pMapId, int x, int y) = 0;
 
+            /**
+            Load the models spawned by a tile ahead of loadMap and hold a reference to them until releaseMapModels.
+            Can be called from any thread, the map trees are not touched.
+            */
+            virtual bool preloadMapModels(const char* pBasePath, unsigned int pMapId, int x, int y, std::vector<std::string>& models) = 0;
+            virtual void releaseMapModels(const std::vector<std::string>& models) = 0;
+
             virtual void unloadMap(unsigned int pMapId, int x, int y) = 0;
             virtual void unloadMap(unsigned int pMapId) = 0;
 
@@ -22,6 +22,7 @@
 #include "VMapDefinitions.h"
 #include "WorldModel.h"
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <iomanip>
@@ -269,6 +270,35 @@ namespace VMAP
 
     //=========================================================
 
+    bool StaticMapTree::ReadTileModelNames(const std::string& vmapPath, uint32 mapID, uint32 tileX, uint32 tileY, std::vector<std::string>& names)
+    {
+        std::string basePath = vmapPath;
+        if (basePath.length() > 0 && (basePath[basePath.length() - 1] != '/' && basePath[basePath.length() - 1] != '\\'))
+            basePath.append("/");
+        std::string tilefile = basePath + getTileFileName(mapID, tileX, tileY);
+        FILE* tf = fopen(tilefile.c_str(), "rb");
+        if (!tf)
+            return false;
+
+        char chunk[8];
+        bool result = readChunk(tf, chunk, VMAP_MAGIC, 8);
+        uint32 numSpawns = 0;
+        if (result && fread(&numSpawns, sizeof(uint32), 1, tf) != 1)
+            result = false;
+        for (uint32 i = 0; i < numSpawns && result; ++i)
+        {
+            ModelSpawn spawn;
+            uint32 referencedVal;
+            result = ModelSpawn::readFromFile(tf, spawn) && fread(&referencedVal, sizeof(uint32), 1, tf) == 1;
+            if (result && std::find(names.begin(), names.end(), spawn.name) == names.end())
+                names.push_back(spawn.name);
+        }
+        fclose(tf);
+        return result;
+    }
+
+    //=========================================================
+
     bool StaticMapTree::InitMap(const std::string& fname, VMapManager2* vm)
     {
         DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Initializing StaticMapTree '%s'", fname.c_str());
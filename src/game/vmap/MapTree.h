@@ -22,6 +22,7 @@
 #include "BIH.h"
 
 #include <unordered_map>
+#include <vector>
 
 namespace VMAP
 {
@@ -71,6 +72,8 @@ namespace VMAP
             static uint32 packTileID(uint32 tileX, uint32 tileY) { return tileX << 16 | tileY; }
             static void unpackTileID(uint32 ID, uint32& tileX, uint32& tileY) { tileX = ID >> 16; tileY = ID & 0xFF; }
             static bool CanLoadMap(const std::string& vmapPath, uint32 mapID, uint32 tileX, uint32 tileY);
+            // names of the models spawned by a tile, without loading anything
+            static bool ReadTileModelNames(const std::string& vmapPath, uint32 mapID, uint32 tileX, uint32 tileY, std::vector<std::string>& names);
 
             StaticMapTree(uint32 mapID, const std::string& basePath);
             ~StaticMapTree();
@@ -107,6 +107,34 @@ namespace VMAP
         return result;
     }
 
+    //=========================================================
+
+    bool VMapManager2::preloadMapModels(const char* pBasePath, unsigned int pMapId, int x, int y, std::vector<std::string>& models)
+    {
+        if (!isMapLoadingEnabled())
+            return false;
+
+        std::vector<std::string> names;
+        if (!StaticMapTree::ReadTileModelNames(pBasePath, pMapId, x, y, names))
+            return false;
+
+        std::string basePath = pBasePath;
+        if (basePath.length() > 0 && (basePath[basePath.length() - 1] != '/' && basePath[basePath.length() - 1] != '\\'))
+            basePath.append("/");
+
+        for (std::string const& name : names)
+            if (acquireModelInstance(basePath, name))
+                models.push_back(name);
+
+        return true;
+    }
+
+    void VMapManager2::releaseMapModels(const std::vector<std::string>& models)
+    {
+        for (std::string const& name : models)
+            releaseModelInstance(name);
+    }
+
     //=========================================================
     // Check if specified map have tile loaded
     bool VMapManager2::IsTileLoaded(uint32 mapId, uint32 x, uint32 y) const
@@ -332,6 +360,7 @@ namespace VMAP
 
     void VMapManager2::releaseModelInstance(const std::string& filename)
     {
+        std::lock_guard<std::mutex> lock(m_vmModelMutex);
         ModelFileMap::iterator model = iLoadedModelFiles.find(filename);
         if (model == iLoadedModelFiles.end())
         {
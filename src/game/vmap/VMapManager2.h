@@ -91,6 +91,8 @@ namespace VMAP
             void InitializeThreadUnsafe(const std::vector<uint32>& mapIds) override;
 
             VMAPLoadResult loadMap(const char* pBasePath, unsigned int pMapId, int x, int y) override;
+            bool preloadMapModels(const char* pBasePath, unsigned int pMapId, int x, int y, std::vector<std::string>& models) override;
+            void releaseMapModels(const std::vector<std::string>& models) override;
             bool IsTileLoaded(uint32 mapId, uint32 x, uint32 y) const override;
 
             void unloadMap(unsigned int pMapId, int x, int y) override;
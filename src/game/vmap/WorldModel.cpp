@@ -22,6 +22,17 @@
 #include "ModelInstance.h"
 #include <string.h>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define VMAP_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define VMAP_TARGET_AVX
+#else
+#define VMAP_TARGET_AVX __attribute__((target("avx")))
+#endif
+#endif
+
 using G3D::Vector3;
 using G3D::Ray;
 
@@ -85,6 +96,181 @@ namespace VMAP
         return false;
     }
 
+    // The kernels below test several triangles of a BIH leaf at once. Every lane repeats the operations of
+    // IntersectTriangle in the same order and rejects with the same comparisons, so the hits and distances are
+    // bit-identical to testing the triangles one by one. A set bit i of the result means triangle i is hit
+    // closer than distance, its distance is stored in hitDistance[i].
+    typedef uint32 (*IntersectTrianglesFn)(const G3D::Ray& ray, std::vector<MeshTriangle>::const_iterator triangles, const uint32* entries, uint32 count,
+                                           std::vector<Vector3>::const_iterator vertices, float distance, float* hitDistance);
+
+    uint32 IntersectTrianglesScalar(const G3D::Ray& ray, std::vector<MeshTriangle>::const_iterator triangles, const uint32* entries, uint32 count,
+                                    std::vector<Vector3>::const_iterator vertices, float distance, float* hitDistance)
+    {
+        uint32 mask = 0;
+        for (uint32 i = 0; i < count; ++i)
+        {
+            hitDistance[i] = distance;
+            if (IntersectTriangle(triangles[entries[i]], vertices, ray, hitDistance[i]))
+                mask |= 1 << i;
+        }
+        return mask;
+    }
+
+#ifdef VMAP_SIMD_X86
+    uint32 const SSE_LANES = 4;
+    uint32 const AVX_LANES = 8;
+
+    // up to 4 triangles, unused lanes repeat the first triangle and are masked out
+    uint32 IntersectTrianglesSse(const G3D::Ray& ray, std::vector<MeshTriangle>::const_iterator triangles, const uint32* entries, uint32 count,
+                                 std::vector<Vector3>::const_iterator vertices, float distance, float* hitDistance)
+    {
+        const Vector3* v[3][SSE_LANES];
+        for (uint32 i = 0; i < SSE_LANES; ++i)
+        {
+            const MeshTriangle& tri = triangles[entries[i < count ? i : 0]];
+            v[0][i] = &vertices[tri.idx0];
+            v[1][i] = &vertices[tri.idx1];
+            v[2][i] = &vertices[tri.idx2];
+        }
+
+        const __m128 v0x = _mm_setr_ps(v[0][0]->x, v[0][1]->x, v[0][2]->x, v[0][3]->x);
+        const __m128 v0y = _mm_setr_ps(v[0][0]->y, v[0][1]->y, v[0][2]->y, v[0][3]->y);
+        const __m128 v0z = _mm_setr_ps(v[0][0]->z, v[0][1]->z, v[0][2]->z, v[0][3]->z);
+        const __m128 e1x = _mm_sub_ps(_mm_setr_ps(v[1][0]->x, v[1][1]->x, v[1][2]->x, v[1][3]->x), v0x);
+        const __m128 e1y = _mm_sub_ps(_mm_setr_ps(v[1][0]->y, v[1][1]->y, v[1][2]->y, v[1][3]->y), v0y);
+        const __m128 e1z = _mm_sub_ps(_mm_setr_ps(v[1][0]->z, v[1][1]->z, v[1][2]->z, v[1][3]->z), v0z);
+        const __m128 e2x = _mm_sub_ps(_mm_setr_ps(v[2][0]->x, v[2][1]->x, v[2][2]->x, v[2][3]->x), v0x);
+        const __m128 e2y = _mm_sub_ps(_mm_setr_ps(v[2][0]->y, v[2][1]->y, v[2][2]->y, v[2][3]->y), v0y);
+        const __m128 e2z = _mm_sub_ps(_mm_setr_ps(v[2][0]->z, v[2][1]->z, v[2][2]->z, v[2][3]->z), v0z);
+
+        const __m128 dx = _mm_set1_ps(ray.direction().x);
+        const __m128 dy = _mm_set1_ps(ray.direction().y);
+        const __m128 dz = _mm_set1_ps(ray.direction().z);
+
+        // p = dir x e2, a = e1 . p
+        const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+        const __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+        const __m128 absA = _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+        __m128 valid = _mm_cmpnlt_ps(absA, _mm_set1_ps(1e-5f));
+
+        const __m128 f = _mm_div_ps(_mm_set1_ps(1.0f), a);
+        const __m128 sx = _mm_sub_ps(_mm_set1_ps(ray.origin().x), v0x);
+        const __m128 sy = _mm_sub_ps(_mm_set1_ps(ray.origin().y), v0y);
+        const __m128 sz = _mm_sub_ps(_mm_set1_ps(ray.origin().z), v0z);
+        const __m128 u = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)));
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpnlt_ps(u, _mm_setzero_ps()), _mm_cmpngt_ps(u, _mm_set1_ps(1.0f))));
+
+        // q = s x e1
+        const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+        const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+        const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+        const __m128 vv = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)));
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpnlt_ps(vv, _mm_setzero_ps()), _mm_cmpngt_ps(_mm_add_ps(u, vv), _mm_set1_ps(1.0f))));
+
+        const __m128 t = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)));
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpgt_ps(t, _mm_setzero_ps()), _mm_cmplt_ps(t, _mm_set1_ps(distance))));
+
+        _mm_storeu_ps(hitDistance, t);
+        return uint32(_mm_movemask_ps(valid)) & ((1 << count) - 1);
+    }
+
+    // up to 8 triangles, only used for leaves with more triangles than the SSE kernel takes
+    VMAP_TARGET_AVX uint32 IntersectTrianglesAvx(const G3D::Ray& ray, std::vector<MeshTriangle>::const_iterator triangles, const uint32* entries, uint32 count,
+                                                 std::vector<Vector3>::const_iterator vertices, float distance, float* hitDistance)
+    {
+        float p[9][AVX_LANES];
+        for (uint32 i = 0; i < AVX_LANES; ++i)
+        {
+            const MeshTriangle& tri = triangles[entries[i < count ? i : 0]];
+            const Vector3& v0 = vertices[tri.idx0];
+            const Vector3& v1 = vertices[tri.idx1];
+            const Vector3& v2 = vertices[tri.idx2];
+            p[0][i] = v0.x; p[1][i] = v0.y; p[2][i] = v0.z;
+            p[3][i] = v1.x; p[4][i] = v1.y; p[5][i] = v1.z;
+            p[6][i] = v2.x; p[7][i] = v2.y; p[8][i] = v2.z;
+        }
+
+        const __m256 v0x = _mm256_loadu_ps(p[0]);
+        const __m256 v0y = _mm256_loadu_ps(p[1]);
+        const __m256 v0z = _mm256_loadu_ps(p[2]);
+        const __m256 e1x = _mm256_sub_ps(_mm256_loadu_ps(p[3]), v0x);
+        const __m256 e1y = _mm256_sub_ps(_mm256_loadu_ps(p[4]), v0y);
+        const __m256 e1z = _mm256_sub_ps(_mm256_loadu_ps(p[5]), v0z);
+        const __m256 e2x = _mm256_sub_ps(_mm256_loadu_ps(p[6]), v0x);
+        const __m256 e2y = _mm256_sub_ps(_mm256_loadu_ps(p[7]), v0y);
+        const __m256 e2z = _mm256_sub_ps(_mm256_loadu_ps(p[8]), v0z);
+
+        const __m256 dx = _mm256_set1_ps(ray.direction().x);
+        const __m256 dy = _mm256_set1_ps(ray.direction().y);
+        const __m256 dz = _mm256_set1_ps(ray.direction().z);
+
+        const __m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+        const __m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+        const __m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+        const __m256 a = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+        const __m256 absA = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a);
+        __m256 valid = _mm256_cmp_ps(absA, _mm256_set1_ps(1e-5f), _CMP_NLT_UQ);
+
+        const __m256 f = _mm256_div_ps(_mm256_set1_ps(1.0f), a);
+        const __m256 sx = _mm256_sub_ps(_mm256_set1_ps(ray.origin().x), v0x);
+        const __m256 sy = _mm256_sub_ps(_mm256_set1_ps(ray.origin().y), v0y);
+        const __m256 sz = _mm256_sub_ps(_mm256_set1_ps(ray.origin().z), v0z);
+        const __m256 u = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)), _mm256_mul_ps(sz, pz)));
+        valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(u, _mm256_setzero_ps(), _CMP_NLT_UQ), _mm256_cmp_ps(u, _mm256_set1_ps(1.0f), _CMP_NGT_UQ)));
+
+        const __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+        const __m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+        const __m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+        const __m256 vv = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)));
+        valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(vv, _mm256_setzero_ps(), _CMP_NLT_UQ), _mm256_cmp_ps(_mm256_add_ps(u, vv), _mm256_set1_ps(1.0f), _CMP_NGT_UQ)));
+
+        const __m256 t = _mm256_mul_ps(f, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)));
+        valid = _mm256_and_ps(valid, _mm256_and_ps(_mm256_cmp_ps(t, _mm256_setzero_ps(), _CMP_GT_OQ), _mm256_cmp_ps(t, _mm256_set1_ps(distance), _CMP_LT_OQ)));
+
+        _mm256_storeu_ps(hitDistance, t);
+        return uint32(_mm256_movemask_ps(valid)) & ((1 << count) - 1);
+    }
+
+    bool CpuSupportsAvx()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        return osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+#else
+        return __builtin_cpu_supports("avx");
+#endif
+    }
+#endif
+
+    struct TriangleKernels
+    {
+        IntersectTrianglesFn narrow;                        // used for leaves of up to narrowLanes triangles
+        uint32 narrowLanes;
+        IntersectTrianglesFn wide;
+        uint32 wideLanes;
+    };
+
+    // selected once by the features of the cpu the server runs on
+    const TriangleKernels& GetTriangleKernels()
+    {
+        static const TriangleKernels kernels = []()
+        {
+#ifdef VMAP_SIMD_X86
+            if (CpuSupportsAvx())
+                return TriangleKernels{ IntersectTrianglesSse, SSE_LANES, IntersectTrianglesAvx, AVX_LANES };
+            return TriangleKernels{ IntersectTrianglesSse, SSE_LANES, IntersectTrianglesSse, SSE_LANES };
+#else
+            return TriangleKernels{ IntersectTrianglesScalar, 1, IntersectTrianglesScalar, 1 };
+#endif
+        }();
+        return kernels;
+    }
+
     class TriBoundFunc
     {
         public:
@@ -362,6 +548,32 @@ namespace VMAP
             if (result)  hit = true;
             return hit;
         }
+        // all triangles of a BIH leaf, hits are taken in triangle order like the single triangle tests would
+        bool intersectLeaf(const G3D::Ray& ray, const uint32* entries, uint32 count, float& distance, bool pStopAtFirstHit)
+        {
+            const TriangleKernels& kernels = GetTriangleKernels();
+            const IntersectTrianglesFn kernel = count > kernels.narrowLanes ? kernels.wide : kernels.narrow;
+            const uint32 lanes = count > kernels.narrowLanes ? kernels.wideLanes : kernels.narrowLanes;
+            while (count)
+            {
+                uint32 tested = std::min(count, lanes);
+                float hitDistance[8];
+                uint32 mask = kernel(ray, triangles, entries, tested, vertices, distance, hitDistance);
+                for (uint32 i = 0; mask; ++i, mask >>= 1)
+                {
+                    if (!(mask & 1) || !(hitDistance[i] < distance))
+                        continue;
+
+                    distance = hitDistance[i];
+                    hit = true;
+                    if (pStopAtFirstHit)
+                        return hit;
+                }
+                entries += tested;
+                count -= tested;
+            }
+            return hit;
+        }
         std::vector<Vector3>::const_iterator vertices;
         std::vector<MeshTriangle>::const_iterator triangles;
         bool hit;
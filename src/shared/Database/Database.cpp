@@ -20,6 +20,7 @@
 #include "Config/Config.h"
 #include "Database/SqlOperations.h"
 
+#include <algorithm>
 #include <ctime>
 #include <iostream>
 #include <fstream>
@@ -98,7 +99,7 @@ Database::~Database()
     StopServer();
 }
 
-bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
+bool Database::Initialize(const char* infoString, int nConns /*= 1*/, int nAsyncConns /*= 1*/)
 {
     // Enable logging of SQL commands (usually only GM commands)
     // (See method: PExecuteLog)
@@ -111,6 +112,7 @@ bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
     }
 
     m_pingIntervallms = sConfig.GetIntDefault("MaxPingTime", 30) * (MINUTE * 1000);
+    m_batchStatements = sConfig.GetBoolDefault("DatabaseBatchStatements", false);
 
     // create DB connections
 
@@ -135,10 +137,20 @@ bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
         m_pQueryConnections.push_back(pConn);
     }
 
-    // create and initialize connection for async requests
-    m_pAsyncConn = CreateConnection();
-    if (!m_pAsyncConn->Initialize(infoString))
-        return false;
+    // create and initialize connections for async requests
+    nAsyncConns = std::max(MIN_CONNECTION_POOL_SIZE, std::min(nAsyncConns, MAX_CONNECTION_POOL_SIZE));
+    for (int i = 0; i < nAsyncConns; ++i)
+    {
+        SqlConnection* pConn = CreateConnection();
+        if (!pConn->Initialize(infoString))
+        {
+            delete pConn;
+            return false;
+        }
+
+        m_pAsyncConns.push_back(pConn);
+    }
+    m_pAsyncConn = m_pAsyncConns.front();
 
     m_pResultQueue = new SqlResultQueue;
 
@@ -151,9 +163,11 @@ void Database::StopServer()
     HaltDelayThread();
 
     delete m_pResultQueue;
-    delete m_pAsyncConn;
+    for (auto& pAsyncConn : m_pAsyncConns)
+        delete pAsyncConn;
 
     m_pResultQueue = nullptr;
+    m_pAsyncConns.clear();
     m_pAsyncConn = nullptr;
 
     for (auto& m_pQueryConnection : m_pQueryConnections)
@@ -162,30 +176,44 @@ void Database::StopServer()
     m_pQueryConnections.clear();
 }
 
-SqlDelayThread* Database::CreateDelayThread()
+SqlDelayThread* Database::CreateDelayThread(SqlConnection* conn, bool pingConnections)
 {
-    assert(m_pAsyncConn);
-    return new SqlDelayThread(this, m_pAsyncConn);
+    assert(conn);
+    return new SqlDelayThread(this, conn, pingConnections);
 }
 
 void Database::InitDelayThread()
 {
-    assert(!m_delayThread);
+    assert(m_delayThreads.empty());
 
-    // New delay thread for delay execute
-    m_threadBody = CreateDelayThread();              // will deleted at m_delayThread delete
-    m_delayThread = new MaNGOS::Thread(m_threadBody);
+    // New delay thread for delay execute, the first one also keeps all connections alive
+    for (size_t i = 0; i < m_pAsyncConns.size(); ++i)
+    {
+        SqlDelayThread* threadBody = CreateDelayThread(m_pAsyncConns[i], i == 0);
+        m_threadBodies.push_back(threadBody);
+        m_delayThreads.push_back(new MaNGOS::Thread(threadBody));   // threadBody will be deleted at thread delete
+    }
 }
 
 void Database::HaltDelayThread()
 {
-    if (!m_threadBody || !m_delayThread) return;
+    if (m_delayThreads.empty()) return;
+
+    for (auto& threadBody : m_threadBodies)
+        threadBody->Stop();                                 // Stop event
+
+    for (auto& delayThread : m_delayThreads)
+        delayThread->wait();                                // Wait for flush to DB
+
+    // query holders left over hand their parts to the other thread bodies, so all of them are flushed before any is deleted
+    for (auto& threadBody : m_threadBodies)
+        threadBody->Flush();
+
+    for (auto& delayThread : m_delayThreads)
+        delete delayThread;                                 // This also deletes its thread body
 
-    m_threadBody->Stop();                                   // Stop event
-    m_delayThread->wait();                                  // Wait for flush to DB
-    delete m_delayThread;                                   // This also deletes m_threadBody
-    m_delayThread = nullptr;
-    m_threadBody = nullptr;
+    m_delayThreads.clear();
+    m_threadBodies.clear();
 }
 
 void Database::ThreadStart()
@@ -226,12 +254,22 @@ SqlConnection* Database::getQueryConnection()
     return m_pQueryConnections[nCount % m_nQueryConnPoolSize];
 }
 
+SqlDelayStats Database::GetAsyncStats()
+{
+    SqlDelayStats stats;
+    for (auto& threadBody : m_threadBodies)
+        threadBody->CollectStats(stats);
+
+    return stats;
+}
+
 void Database::Ping()
 {
     const char* sql = "SELECT 1";
 
+    for (auto& pAsyncConn : m_pAsyncConns)
     {
-        SqlConnection::Lock guard(m_pAsyncConn);
+        SqlConnection::Lock guard(pAsyncConn);
         guard->Query(sql);
     }
 
@@ -341,7 +379,7 @@ bool Database::Execute(const char* sql)
             return DirectExecute(sql);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPlainRequest(sql));
+        getDelayThread()->Delay(new SqlPlainRequest(sql));
     }
 
     return true;
@@ -395,42 +433,56 @@ bool Database::BeginTransaction()
     MANGOS_ASSERT(!m_currentTransaction.get());   // if we will get a nested transaction request - we MUST fix code!!!
 
     if (!m_currentTransaction.get())
-        m_currentTransaction.reset(new SqlTransaction);
+        m_currentTransaction.reset(new SqlTransaction());
 
     return m_currentTransaction.get() != nullptr;
 }
 
-bool Database::CommitTransaction()
+bool Database::CommitTransaction(SqlTransactionResultPtr const& result)
 {
     if (!m_pAsyncConn || !m_currentTransaction.get())
+    {
+        if (result)
+            result->SetState(SqlTransactionResult::FAILED);
         return false;
+    }
 
     // if async execution is not available
     if (!m_allowAsyncTransactions)
-        return CommitTransactionDirect();
+        return CommitTransactionDirect(result);
 
     // add SqlTransaction to the async queue
-    m_threadBody->Delay(m_currentTransaction.release());
+    SqlTransaction* pTrans = m_currentTransaction.release();
+    pTrans->SetResult(result);
+    getDelayThread()->Delay(pTrans);
     return true;
 }
 
-bool Database::CommitTransactionDirect()
+bool Database::CommitTransactionDirect(SqlTransactionResultPtr const& result)
 {
-    if (!m_pAsyncConn)
-        return false;
-
     // check if we have pending transaction
-    if (!m_currentTransaction.get())
+    if (!m_pAsyncConn || !m_currentTransaction.get())
+    {
+        if (result)
+            result->SetState(SqlTransactionResult::FAILED);
         return false;
+    }
 
     // directly execute SqlTransaction
     auto const pTrans = m_currentTransaction.release();
+    pTrans->SetResult(result);
     pTrans->Execute(m_pAsyncConn);
     delete pTrans;
 
     return true;
 }
 
+uint32 Database::GetTransactionSize() const
+{
+    SqlTransaction const* pTrans = m_currentTransaction.get();
+    return pTrans ? pTrans->GetSize() : 0;
+}
+
 bool Database::RollbackTransaction()
 {
     if (!m_pAsyncConn)
@@ -564,7 +616,7 @@ bool Database::ExecuteStmt(const SqlStatementID& id, SqlStmtParameters* params)
             return DirectExecuteStmt(id, params);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPreparedRequest(id.ID(), params));
+        getDelayThread()->Delay(new SqlPreparedRequest(id.ID(), params));
     }
 
     return true;
@@ -31,6 +31,7 @@
 #include <memory>
 
 class SqlTransaction;
+class SqlTransactionResult;
 class SqlResultQueue;
 class SqlQueryHolder;
 class SqlStmtParameters;
@@ -62,6 +63,8 @@ class SqlConnection
         virtual bool CommitTransaction() { return true; }
         // can't rollback without transaction support
         virtual bool RollbackTransaction() { return true; }
+        // whether independent statements can share a transaction without a failing one affecting the others
+        virtual bool CanBatchStatements() const { return true; }
 
         // methods to work with prepared statements
         bool ExecuteStmt(int nIndex, const SqlStmtParameters& id);
@@ -106,10 +109,10 @@ class Database
     public:
         virtual ~Database();
 
-        virtual bool Initialize(const char* infoString, int nConns = 1);
-        // start worker thread for async DB request execution
+        virtual bool Initialize(const char* infoString, int nConns = 1, int nAsyncConns = 1);
+        // start worker threads for async DB request execution
         virtual void InitDelayThread();
-        // stop worker thread
+        // stop worker threads
         virtual void HaltDelayThread();
 
         /// Synchronous DB queries
@@ -186,10 +189,13 @@ class Database
         bool PExecuteLog(const char* format, ...) ATTR_PRINTF(2, 3);
 
         bool BeginTransaction();
-        bool CommitTransaction();
+        // result, when given, is set once the transaction was executed
+        bool CommitTransaction(std::shared_ptr<SqlTransactionResult> const& result = nullptr);
         bool RollbackTransaction();
         // for sync transaction execution
-        bool CommitTransactionDirect();
+        bool CommitTransactionDirect(std::shared_ptr<SqlTransactionResult> const& result = nullptr);
+        // number of statements queued in the open transaction of this thread
+        uint32 GetTransactionSize() const;
 
         // PREPARED STATEMENT API
 
@@ -213,10 +219,15 @@ class Database
 
         bool CheckRequiredField(char const* table_name, char const* required_name);
         uint32 GetPingIntervall() const { return m_pingIntervallms; }
+        // adjacent async statements may share one transaction, a failing one then rolls back the others
+        bool IsStatementBatchingEnabled() const { return m_batchStatements; }
 
         // function to ping database connections
         void Ping();
 
+        // queue depth and latency of async requests
+        SqlDelayStats GetAsyncStats();
+
         // set this to allow async transactions
         // you should call it explicitly after your server successfully started up
         // NO ASYNC TRANSACTIONS DURING SERVER STARTUP - ONLY DURING RUNTIME!!!
@@ -225,8 +236,8 @@ class Database
     protected:
         Database() :
             m_nQueryConnPoolSize(1), m_pAsyncConn(nullptr), m_pResultQueue(nullptr),
-            m_threadBody(nullptr), m_delayThread(nullptr), m_allowAsyncTransactions(false),
-            m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0)
+            m_allowAsyncTransactions(false),
+            m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0), m_batchStatements(false)
         {
             m_nQueryCounter = -1;
         }
@@ -236,7 +247,7 @@ class Database
         // factory method to create SqlConnection objects
         virtual SqlConnection* CreateConnection() = 0;
         // factory method to create SqlDelayThread objects
-        virtual SqlDelayThread* CreateDelayThread();
+        virtual SqlDelayThread* CreateDelayThread(SqlConnection* conn, bool pingConnections);
 
         // per-thread based storage for SqlTransaction object initialization - no locking is required
         boost::thread_specific_ptr<SqlTransaction> m_currentTransaction;
@@ -245,8 +256,10 @@ class Database
 
         // round-robin connection selection
         SqlConnection* getQueryConnection();
-        // for now return one single connection for async requests
+        // connection for direct execution of requests that would otherwise be async
         SqlConnection* getAsyncConnection() const { return m_pAsyncConn; }
+        // delay thread executing all async requests in order, the others only help with the queries of holders
+        SqlDelayThread* getDelayThread() const { return m_threadBodies.front(); }
 
         friend class SqlStatement;
         // PREPARED STATEMENT API
@@ -262,12 +275,13 @@ class Database
         typedef std::vector< SqlConnection* > SqlConnectionContainer;
         SqlConnectionContainer m_pQueryConnections;
 
-        // only one single DB connection for transactions
-        SqlConnection* m_pAsyncConn;
+        // connections for transactions and async queries, each one served by its own delay thread
+        SqlConnectionContainer m_pAsyncConns;
+        SqlConnection* m_pAsyncConn;                        ///< first async connection, also used for direct execution
 
         SqlResultQueue*     m_pResultQueue;                 ///< Transaction queues from diff. threads
-        SqlDelayThread*     m_threadBody;                   ///< Pointer to delay sql executer (owned by m_delayThread)
-        MaNGOS::Thread*     m_delayThread;                  ///< Pointer to executer thread
+        std::vector<SqlDelayThread*> m_threadBodies;        ///< Delay sql executers (owned by m_delayThreads)
+        std::vector<MaNGOS::Thread*> m_delayThreads;        ///< Executer threads
 
         std::atomic<bool> m_allowAsyncTransactions;         ///< flag which specifies if async transactions are enabled
 
@@ -287,5 +301,6 @@ class Database
         bool m_logSQL;
         std::string m_logsDir;
         uint32 m_pingIntervallms;
+        bool m_batchStatements;
 };
 #endif
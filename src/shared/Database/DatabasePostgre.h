@@ -50,6 +50,9 @@ class PostgreSQLConnection : public SqlConnection
         bool CommitTransaction() override;
         bool RollbackTransaction() override;
 
+        // a failed statement aborts the whole transaction
+        bool CanBatchStatements() const override { return false; }
+
     private:
         bool _TransactionCmd(const char* sql);
         bool _Query(const char* sql, PGresult** pResult, uint64* pRowCount, uint32* pFieldCount);
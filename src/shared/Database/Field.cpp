@@ -29,3 +29,22 @@ time_t Field::GetTime() const
     ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
     return std::mktime(&tm);
 }
+
+const char* Field::FormatNumeric() const
+{
+    char text[32];
+    if (mStorage == STORAGE_INTEGER)
+        snprintf(text, sizeof(text), SI64FMTD, mInteger);
+    else
+    {
+        // same form as the text conversion of the DBMS: integral reals keep a ".0"
+        int length = snprintf(text, sizeof(text), "%.15g", mReal);
+        if (length > 0 && size_t(length) + 2 < sizeof(text) && strspn(text, "-0123456789") == size_t(length))
+            strcat(text, ".0");
+    }
+
+    // kept until the field gets its next value, as the pointers of the DBMS APIs are
+    mValue = mangos_strdup(text);
+    mOwnsValue = true;
+    return mValue;
+}
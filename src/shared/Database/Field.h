@@ -21,6 +21,8 @@
 
 #include "Common.h"
 
+#include <charconv>
+
 class Field
 {
     public:
@@ -34,33 +36,59 @@ class Field
             DB_TYPE_BOOL    = 0x04
         };
 
-        Field() : mValue(nullptr), mType(DB_TYPE_UNKNOWN) {}
-        Field(const char* value, enum DataTypes type) : mValue(value), mType(type) {}
+        Field() : mValue(nullptr), mInteger(0), mType(DB_TYPE_UNKNOWN), mStorage(STORAGE_NULL), mOwnsValue(false) {}
+        Field(const char* value, enum DataTypes type) : mValue(value), mInteger(0), mType(type), mStorage(value ? STORAGE_TEXT : STORAGE_NULL), mOwnsValue(false) {}
 
-        ~Field() {}
+        ~Field() { FreeValue(); }
 
         enum DataTypes GetType() const { return mType; }
-        bool IsNULL() const { return mValue == nullptr; }
+        bool IsNULL() const { return mStorage == STORAGE_NULL; }
 
         const char* GetString() const
         {
-            return mValue ? mValue : ""; // We need this null check as we do not always null check what we get back from the database everywhere
+            if (mValue)
+                return mValue;
+            // native numeric values only get a text form when asked for one
+            if (mStorage == STORAGE_INTEGER || mStorage == STORAGE_REAL)
+                return FormatNumeric();
+            return ""; // We need this null check as we do not always null check what we get back from the database everywhere
         }
         std::string GetCppString() const
         {
-            return mValue ? mValue : "";                    // std::string s = 0 have undefine result in C++
+            return GetString();                             // std::string s = 0 have undefine result in C++
+        }
+        float GetFloat() const
+        {
+            switch (mStorage)
+            {
+                case STORAGE_INTEGER: return static_cast<float>(mInteger);
+                case STORAGE_REAL:    return static_cast<float>(mReal);
+                case STORAGE_TEXT:    return static_cast<float>(atof(mValue));
+                default:              return 0.0f;
+            }
+        }
+        bool GetBool() const
+        {
+            switch (mStorage)
+            {
+                case STORAGE_INTEGER:
+                case STORAGE_REAL:    return static_cast<int32>(GetInteger()) > 0;
+                case STORAGE_TEXT:    return atoi(mValue) > 0;
+                default:              return false;
+            }
         }
-        float GetFloat() const { return mValue ? static_cast<float>(atof(mValue)) : 0.0f; }
-        bool GetBool() const { return mValue ? atoi(mValue) > 0 : false; }
-        int32 GetInt32() const { return mValue ? static_cast<int32>(atol(mValue)) : int32(0); }
-        uint8 GetUInt8() const { return mValue ? static_cast<uint8>(atol(mValue)) : uint8(0); }
-        uint16 GetUInt16() const { return mValue ? static_cast<uint16>(atol(mValue)) : uint16(0); }
-        int16 GetInt16() const { return mValue ? static_cast<int16>(atol(mValue)) : int16(0); }
-        uint32 GetUInt32() const { return mValue ? static_cast<uint32>(atoll(mValue)) : uint32(0); }
+        int32 GetInt32() const { return static_cast<int32>(GetInteger()); }
+        uint8 GetUInt8() const { return static_cast<uint8>(GetInteger()); }
+        uint16 GetUInt16() const { return static_cast<uint16>(GetInteger()); }
+        int16 GetInt16() const { return static_cast<int16>(GetInteger()); }
+        uint32 GetUInt32() const { return static_cast<uint32>(GetInteger()); }
         uint64 GetUInt64() const
         {
+            if (mStorage != STORAGE_TEXT)
+                return static_cast<uint64>(GetInteger());
+
             uint64 value = 0;
-            if (!mValue || sscanf(mValue, UI64FMTD, &value) == -1)
+            if (sscanf(mValue, UI64FMTD, &value) == -1)
                 return 0;
 
             return value;
@@ -70,13 +98,104 @@ class Field
         void SetType(enum DataTypes type) { mType = type; }
         // no need for memory allocations to store resultset field strings
         // all we need is to cache pointers returned by different DBMS APIs
-        void SetValue(const char* value) { mValue = value; }
+        void SetValue(const char* value)
+        {
+            FreeValue();
+            mValue = value;
+            mStorage = value ? STORAGE_TEXT : STORAGE_NULL;
+        }
+        // text protocol value: numeric columns are decoded here once per row instead of in every accessor call
+        void SetValue(const char* value, size_t length)
+        {
+            SetValue(value);
+            if (!value)
+                return;
+
+            if (mType == DB_TYPE_INTEGER)
+                DecodeInteger(value, length);
+            else if (mType == DB_TYPE_FLOAT)
+                DecodeReal(value, length);
+        }
+        // native values as returned by DBMS APIs with typed columns
+        void SetInteger(int64 value)
+        {
+            FreeValue();
+            mValue = nullptr;
+            mInteger = value;
+            mStorage = STORAGE_INTEGER;
+        }
+        void SetReal(double value)
+        {
+            FreeValue();
+            mValue = nullptr;
+            mReal = value;
+            mStorage = STORAGE_REAL;
+        }
 
     private:
         Field(Field const&);
         Field& operator=(Field const&);
 
-        const char* mValue;
+        enum Storage : uint8
+        {
+            STORAGE_NULL,
+            STORAGE_TEXT,                                   // only mValue is set, accessors parse it
+            STORAGE_INTEGER,                                // mInteger holds the decoded value, mValue may hold its text
+            STORAGE_REAL,                                   // mReal holds the decoded value, mValue may hold its text
+        };
+
+        int64 GetInteger() const
+        {
+            switch (mStorage)
+            {
+                case STORAGE_INTEGER: return mInteger;
+                case STORAGE_REAL:    return static_cast<int64>(mReal);
+                case STORAGE_TEXT:    return atoll(mValue);
+                default:              return 0;
+            }
+        }
+
+        void DecodeInteger(const char* value, size_t length)
+        {
+            std::from_chars_result res = std::from_chars(value, value + length, mInteger);
+            // unsigned bigint above INT64_MAX, keep the bit pattern like the unsigned parse did
+            if (res.ec == std::errc::result_out_of_range)
+            {
+                uint64 unsignedValue = 0;
+                res = std::from_chars(value, value + length, unsignedValue);
+                mInteger = static_cast<int64>(unsignedValue);
+            }
+            // anything else keeps the text form and the accessors' parsing
+            if (res.ec == std::errc() && res.ptr == value + length)
+                mStorage = STORAGE_INTEGER;
+        }
+
+        void DecodeReal(const char* value, size_t length)
+        {
+            std::from_chars_result res = std::from_chars(value, value + length, mReal);
+            if (res.ec == std::errc() && res.ptr == value + length)
+                mStorage = STORAGE_REAL;
+        }
+
+        const char* FormatNumeric() const;
+
+        void FreeValue()
+        {
+            if (mOwnsValue)
+            {
+                delete[] const_cast<char*>(mValue);
+                mOwnsValue = false;
+            }
+        }
+
+        mutable const char* mValue;                         // for native numeric values the text form, built on demand
+        union
+        {
+            int64 mInteger;
+            double mReal;
+        };
         enum DataTypes mType;
+        Storage mStorage;
+        mutable bool mOwnsValue;                            // mValue was allocated by FormatNumeric, fits in the padding
 };
 #endif
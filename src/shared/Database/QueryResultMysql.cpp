@@ -49,8 +49,10 @@ bool QueryResultMysql::NextRow()
         return false;
     }
 
+    // numeric columns are decoded once here, the Field accessors then only load them
+    unsigned long* lengths = mysql_fetch_lengths(mResult);
     for (uint32 i = 0; i < mFieldCount; ++i)
-        mCurrentRow[i].SetValue(row[i]);
+        mCurrentRow[i].SetValue(row[i], lengths[i]);
 
     return true;
 }
@@ -64,12 +64,27 @@ bool QueryResultSqlite::NextRow()
         return false;
     }
 
+    // use the native column values, text is only fetched for text and blob columns
     for (int i = 0; i < mFieldCount; ++i)
     {
-        const unsigned char* value = sqlite3_column_text(*mStmt, i);
+        int type = sqlite3_column_type(*mStmt, i);
+        mCurrentRow[i].SetType(ConvertNativeType(type));
 
-        mCurrentRow[i].SetValue(value ? reinterpret_cast<const char*>(value) : nullptr);
-        mCurrentRow[i].SetType(ConvertNativeType(sqlite3_column_type(*mStmt, i)));
+        switch (type)
+        {
+            case SQLITE_INTEGER:
+                mCurrentRow[i].SetInteger(sqlite3_column_int64(*mStmt, i));
+                break;
+            case SQLITE_FLOAT:
+                mCurrentRow[i].SetReal(sqlite3_column_double(*mStmt, i));
+                break;
+            default:
+            {
+                const unsigned char* value = sqlite3_column_text(*mStmt, i);
+                mCurrentRow[i].SetValue(value ? reinterpret_cast<const char*>(value) : nullptr);
+                break;
+            }
+        }
     }
 
     return true;
@@ -20,7 +20,13 @@
 #include "Database/SqlOperations.h"
 #include "DatabaseEnv.h"
 
-SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn) : m_dbEngine(db), m_dbConnection(conn), m_running(true)
+#include <algorithm>
+
+// longest run of single statements committed together
+static const size_t MAX_STATEMENT_BATCH = 64;
+
+SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn, bool pingConnections) : m_dbEngine(db), m_dbConnection(conn), m_running(true),
+    m_pingConnections(pingConnections), m_queued(0), m_executed(0), m_latencySumUs(0), m_latencyMaxUs(0)
 {
 }
 
@@ -38,23 +44,28 @@ void SqlDelayThread::run()
 #endif
 #endif
 
-    const uint32 loopSleepms = 10;
-
-    const uint32 pingEveryLoop = m_dbEngine->GetPingIntervall() / loopSleepms;
+    auto const pingInterval = std::chrono::milliseconds(std::max<uint32>(m_dbEngine->GetPingIntervall(), 1000));
+    auto nextPing = std::chrono::steady_clock::now() + pingInterval;
 
-    uint32 loopCounter = 0;
     while (m_running)
     {
+        // sleep until work is queued, the thread is stopped or the connections need a ping
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            if (m_pingConnections)
+                m_queueCondition.wait_until(lock, nextPing, [this] { return !m_sqlQueue.empty() || !m_running; });
+            else
+                m_queueCondition.wait(lock, [this] { return !m_sqlQueue.empty() || !m_running; });
+        }
+
         // if the running state gets turned off while sleeping
         // empty the queue before exiting
-        MaNGOS::Thread::Sleep(loopSleepms);
-
         ProcessRequests();
 
-        if ((loopCounter++) >= pingEveryLoop)
+        if (m_pingConnections && std::chrono::steady_clock::now() >= nextPing)
         {
-            loopCounter = 0;
             m_dbEngine->Ping();
+            nextPing = std::chrono::steady_clock::now() + pingInterval;
         }
     }
 
@@ -67,12 +78,36 @@ void SqlDelayThread::run()
 
 void SqlDelayThread::Stop()
 {
-    m_running = false;
+    {
+        std::lock_guard<std::mutex> guard(m_queueMutex);
+        m_running = false;
+    }
+    m_queueCondition.notify_one();
+}
+
+void SqlDelayThread::OnExecute(QueuedOperation const& queued)
+{
+    uint64 latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queued.queueTime).count();
+
+    --m_queued;
+    ++m_executed;
+    m_latencySumUs += latency;
+
+    uint64 latencyMax = m_latencyMaxUs;
+    while (latency > latencyMax && !m_latencyMaxUs.compare_exchange_weak(latencyMax, latency)) {}
+}
+
+void SqlDelayThread::CollectStats(SqlDelayStats& stats)
+{
+    stats.queued += m_queued;
+    stats.executed += m_executed.exchange(0);
+    stats.latencySumUs += m_latencySumUs.exchange(0);
+    stats.latencyMaxUs = std::max<uint64>(stats.latencyMaxUs, m_latencyMaxUs.exchange(0));
 }
 
 void SqlDelayThread::ProcessRequests()
 {
-    std::queue<std::unique_ptr<SqlOperation>> sqlQueue;
+    std::deque<QueuedOperation> sqlQueue;
 
     // we need to move the contents of the queue to a local copy because executing these statements with the
     // lock in place can result in a deadlock with the world thread which calls Database::ProcessResultQueue()
@@ -83,8 +118,27 @@ void SqlDelayThread::ProcessRequests()
 
     while (!sqlQueue.empty())
     {
+        // adjacent single statements share one transaction if enabled, so the database commits once for the whole run
+        if (sqlQueue.size() > 1 && sqlQueue[0].operation->IsBatchable() && sqlQueue[1].operation->IsBatchable() &&
+            m_dbEngine->IsStatementBatchingEnabled() && m_dbConnection->CanBatchStatements())
+        {
+            SqlConnection::Lock guard(m_dbConnection);
+            guard->BeginTransaction();
+
+            for (size_t count = 0; count < MAX_STATEMENT_BATCH && !sqlQueue.empty() && sqlQueue.front().operation->IsBatchable(); ++count)
+            {
+                OnExecute(sqlQueue.front());
+                sqlQueue.front().operation->Execute(m_dbConnection);
+                sqlQueue.pop_front();
+            }
+
+            guard->CommitTransaction();
+            continue;
+        }
+
         auto const s = std::move(sqlQueue.front());
-        sqlQueue.pop();
-        s->Execute(m_dbConnection);
+        sqlQueue.pop_front();
+        OnExecute(s);
+        s.operation->Execute(m_dbConnection);
     }
 }
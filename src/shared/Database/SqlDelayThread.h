@@ -23,38 +23,74 @@
 #include "SqlOperations.h"
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
-#include <queue>
 
 class Database;
 class SqlOperation;
 class SqlConnection;
 
+// async queue figures, summed over the delay threads of a database
+struct SqlDelayStats
+{
+    uint32 queued = 0;                                      // operations waiting to be executed
+    uint64 executed = 0;                                    // operations started since the last collection
+    uint64 latencySumUs = 0;                                // time executed operations spent in the queue
+    uint64 latencyMaxUs = 0;
+};
+
 class SqlDelayThread : public MaNGOS::Runnable
 {
     private:
+        struct QueuedOperation
+        {
+            std::unique_ptr<SqlOperation> operation;
+            std::chrono::steady_clock::time_point queueTime;
+        };
+
         std::mutex m_queueMutex;
-        std::queue<std::unique_ptr<SqlOperation>> m_sqlQueue;   ///< Queue of SQL statements
+        std::condition_variable m_queueCondition;               ///< Signaled when work is queued or the thread is stopped
+        std::deque<QueuedOperation> m_sqlQueue;                 ///< Queue of SQL statements
         Database* m_dbEngine;                                   ///< Pointer to used Database engine
         SqlConnection* m_dbConnection;                          ///< Pointer to DB connection
         std::atomic<bool> m_running;
+        bool m_pingConnections;                                 ///< Only one delay thread per database pings
+
+        std::atomic<uint32> m_queued;
+        std::atomic<uint64> m_executed;
+        std::atomic<uint64> m_latencySumUs;
+        std::atomic<uint64> m_latencyMaxUs;
 
         // process all enqueued requests
         void ProcessRequests();
+        void OnExecute(QueuedOperation const& queued);
 
     public:
-        SqlDelayThread(Database* db, SqlConnection* conn);
+        SqlDelayThread(Database* db, SqlConnection* conn, bool pingConnections = true);
         ~SqlDelayThread();
 
         ///< Put sql statement to delay queue
         bool Delay(SqlOperation* sql)
         {
-            std::lock_guard<std::mutex> guard(m_queueMutex);
-            m_sqlQueue.push(std::unique_ptr<SqlOperation>(sql));
+            {
+                std::lock_guard<std::mutex> guard(m_queueMutex);
+                m_sqlQueue.push_back({std::unique_ptr<SqlOperation>(sql), std::chrono::steady_clock::now()});
+                ++m_queued;
+            }
+            m_queueCondition.notify_one();
             return true;
         }
 
+        bool IsRunning() const { return m_running; }
+        ///< Execute what was queued after the thread stopped
+        void Flush() { ProcessRequests(); }
+
+        // add queue figures to stats and reset the per collection counters
+        void CollectStats(SqlDelayStats& stats);
+
         virtual void Stop();                                ///< Stop event
         virtual void run();                                 ///< Main Thread loop
 };
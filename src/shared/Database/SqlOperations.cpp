@@ -21,10 +21,14 @@
 #include "DatabaseEnv.h"
 #include "DatabaseImpl.h"
 
+#include <algorithm>
 #include <cstdarg>
 
 #define LOCK_DB_CONN(conn) SqlConnection::Lock guard(conn)
 
+// smallest share of a query holder worth handing to another delay thread
+static const size_t MIN_HOLDER_QUERIES_PER_PART = 4;
+
 /// ---- ASYNC STATEMENTS / TRANSACTIONS ----
 
 bool SqlPlainRequest::Execute(SqlConnection* conn)
@@ -44,6 +48,14 @@ SqlTransaction::~SqlTransaction()
 }
 
 bool SqlTransaction::Execute(SqlConnection* conn)
+{
+    bool committed = ExecuteStatements(conn);
+    if (m_result)
+        m_result->SetState(committed ? SqlTransactionResult::COMMITTED : SqlTransactionResult::FAILED);
+    return committed;
+}
+
+bool SqlTransaction::ExecuteStatements(SqlConnection* conn)
 {
     if (m_queue.empty())
         return true;
@@ -117,14 +129,19 @@ void SqlResultQueue::Add(MaNGOS::IQueryCallback* callback)
     m_queue.push(std::unique_ptr<MaNGOS::IQueryCallback>(callback));
 }
 
-bool SqlQueryHolder::Execute(MaNGOS::IQueryCallback* callback, SqlDelayThread* thread, SqlResultQueue* queue)
+bool SqlQueryHolder::Execute(MaNGOS::IQueryCallback* callback, SqlDelayThread* thread, std::vector<SqlDelayThread*> const& helpers, SqlResultQueue* queue)
 {
     if (!callback || !thread || !queue)
         return false;
 
+    std::vector<SqlDelayThread*> otherThreads;
+    for (SqlDelayThread* helper : helpers)
+        if (helper != thread)
+            otherThreads.push_back(helper);
+
     /// delay the execution of the queries, sync them with the delay thread
     /// which will in turn resync on execution (via the queue) and call back
-    SqlQueryHolderEx* holderEx = new SqlQueryHolderEx(this, callback, queue);
+    SqlQueryHolderEx* holderEx = new SqlQueryHolderEx(this, callback, queue, std::move(otherThreads));
     thread->Delay(holderEx);
     return true;
 }
@@ -219,18 +236,51 @@ bool SqlQueryHolderEx::Execute(SqlConnection* conn)
     if (!m_holder || !m_callback || !m_queue)
         return false;
 
-    LOCK_DB_CONN(conn);
-    /// we can do this, we are friends
-    std::vector<SqlQueryHolder::SqlResultPair>& queries = m_holder->m_queries;
-    for (size_t i = 0; i < queries.size(); ++i)
+    // everything queued before on this thread is done, so the other threads can take a share without overtaking
+    // a write
+    std::vector<SqlDelayThread*> helpers;
+    for (SqlDelayThread* helper : m_helpers)
+        if (helper->IsRunning())
+            helpers.push_back(helper);
+
+    size_t const queryCount = m_holder->m_queries.size();
+    size_t parts = std::min(helpers.size() + 1, queryCount / MIN_HOLDER_QUERIES_PER_PART);
+    if (parts <= 1)
     {
-        /// execute all queries in the holder and pass the results
-        char const* sql = queries[i].first;
-        if (sql) m_holder->SetResult(i, conn->Query(sql));
+        SqlQueryHolderBatch(m_holder, m_callback, m_queue, 1).Execute(conn, 0, queryCount);
+        return true;
     }
 
-    /// sync with the caller thread
-    m_queue->Add(m_callback);
+    auto batch = std::make_shared<SqlQueryHolderBatch>(m_holder, m_callback, m_queue, uint32(parts));
+    size_t const partSize = (queryCount + parts - 1) / parts;
+    for (size_t part = 1; part < parts; ++part)
+        helpers[part - 1]->Delay(new SqlQueryHolderPart(batch, part * partSize, std::min(queryCount, (part + 1) * partSize)));
 
+    batch->Execute(conn, 0, partSize);
     return true;
 }
+
+bool SqlQueryHolderPart::Execute(SqlConnection* conn)
+{
+    m_batch->Execute(conn, m_begin, m_end);
+    return true;
+}
+
+void SqlQueryHolderBatch::Execute(SqlConnection* conn, size_t begin, size_t end)
+{
+    {
+        LOCK_DB_CONN(conn);
+        /// we can do this, we are friends
+        std::vector<SqlQueryHolder::SqlResultPair>& queries = holder->m_queries;
+        for (size_t i = begin; i < end; ++i)
+        {
+            /// execute all queries in the holder and pass the results
+            char const* sql = queries[i].first;
+            if (sql) holder->SetResult(i, conn->Query(sql));
+        }
+    }
+
+    /// sync with the caller thread
+    if (--pendingParts == 0)
+        queue->Add(callback);
+}
@@ -22,6 +22,7 @@
 #include "Common.h"
 #include "Utilities/Callback.h"
 
+#include <atomic>
 #include <queue>
 #include <vector>
 #include <mutex>
@@ -39,6 +40,8 @@ class SqlOperation
     public:
         virtual void OnRemove() { delete this; }
         virtual bool Execute(SqlConnection* conn) = 0;
+        // single write statement, the delay thread may run it in one transaction with its neighbours
+        virtual bool IsBatchable() const { return false; }
         virtual ~SqlOperation() {}
 };
 
@@ -52,18 +55,46 @@ class SqlPlainRequest : public SqlOperation
         SqlPlainRequest(const char* sql) : m_sql(mangos_strdup(sql)) {}
         ~SqlPlainRequest() { char* tofree = const_cast<char*>(m_sql); delete[] tofree; }
         bool Execute(SqlConnection* conn) override;
+        bool IsBatchable() const override { return true; }
 };
 
+// outcome of an async transaction, the committing thread checks it later as the transaction may not run yet
+class SqlTransactionResult
+{
+    public:
+        enum State
+        {
+            PENDING,
+            COMMITTED,
+            FAILED
+        };
+
+        SqlTransactionResult() : m_state(PENDING) {}
+
+        State GetState() const { return m_state.load(std::memory_order_acquire); }
+        void SetState(State state) { m_state.store(state, std::memory_order_release); }
+
+    private:
+        std::atomic<State> m_state;
+};
+
+typedef std::shared_ptr<SqlTransactionResult> SqlTransactionResultPtr;
+
 class SqlTransaction : public SqlOperation
 {
     private:
         std::vector<SqlOperation* > m_queue;
+        SqlTransactionResultPtr m_result;
+
+        bool ExecuteStatements(SqlConnection* conn);
 
     public:
         SqlTransaction() {}
         ~SqlTransaction();
 
         void DelayExecute(SqlOperation* sql) { m_queue.push_back(sql); }
+        uint32 GetSize() const { return uint32(m_queue.size()); }
+        void SetResult(SqlTransactionResultPtr const& result) { m_result = result; }
 
         bool Execute(SqlConnection* conn) override;
 };
@@ -75,6 +106,7 @@ class SqlPreparedRequest : public SqlOperation
         ~SqlPreparedRequest();
 
         bool Execute(SqlConnection* conn) override;
+        bool IsBatchable() const override { return true; }
 
     private:
         const int m_nIndex;
@@ -119,6 +151,7 @@ class SqlQuery : public SqlOperation
 class SqlQueryHolder
 {
         friend class SqlQueryHolderEx;
+        friend struct SqlQueryHolderBatch;
     private:
         typedef std::pair<const char*, std::unique_ptr<QueryResult>> SqlResultPair;
         std::vector<SqlResultPair> m_queries;
@@ -130,7 +163,23 @@ class SqlQueryHolder
         void SetSize(size_t size);
         std::unique_ptr<QueryResult> GetResult(size_t index);
         void SetResult(size_t index, std::unique_ptr<QueryResult> queryResult);
-        bool Execute(MaNGOS::IQueryCallback* callback, SqlDelayThread* thread, SqlResultQueue* queue);
+        // runs on thread after everything queued before it, the queries are then split with the other running
+        // delay threads of helpers
+        bool Execute(MaNGOS::IQueryCallback* callback, SqlDelayThread* thread, std::vector<SqlDelayThread*> const& helpers, SqlResultQueue* queue);
+};
+
+// shared by the parts of a query holder executed on several delay threads, the last part to finish calls back
+struct SqlQueryHolderBatch
+{
+    SqlQueryHolderBatch(SqlQueryHolder* holder, MaNGOS::IQueryCallback* callback, SqlResultQueue* queue, uint32 parts)
+        : holder(holder), callback(callback), queue(queue), pendingParts(parts) {}
+
+    void Execute(SqlConnection* conn, size_t begin, size_t end);
+
+    SqlQueryHolder* holder;
+    MaNGOS::IQueryCallback* callback;
+    SqlResultQueue* queue;
+    std::atomic<uint32> pendingParts;
 };
 
 class SqlQueryHolderEx : public SqlOperation
@@ -139,9 +188,22 @@ class SqlQueryHolderEx : public SqlOperation
         SqlQueryHolder* m_holder;
         MaNGOS::IQueryCallback* m_callback;
         SqlResultQueue* m_queue;
+        std::vector<SqlDelayThread*> m_helpers;
+    public:
+        SqlQueryHolderEx(SqlQueryHolder* holder, MaNGOS::IQueryCallback* callback, SqlResultQueue* queue, std::vector<SqlDelayThread*> helpers)
+            : m_holder(holder), m_callback(callback), m_queue(queue), m_helpers(std::move(helpers)) {}
+        bool Execute(SqlConnection* conn) override;
+};
+
+class SqlQueryHolderPart : public SqlOperation
+{
+    private:
+        std::shared_ptr<SqlQueryHolderBatch> m_batch;
+        size_t m_begin;
+        size_t m_end;
     public:
-        SqlQueryHolderEx(SqlQueryHolder* holder, MaNGOS::IQueryCallback* callback, SqlResultQueue* queue)
-            : m_holder(holder), m_callback(callback), m_queue(queue) {}
+        SqlQueryHolderPart(std::shared_ptr<SqlQueryHolderBatch> batch, size_t begin, size_t end)
+            : m_batch(std::move(batch)), m_begin(begin), m_end(end) {}
         bool Execute(SqlConnection* conn) override;
 };
 #endif                                                      //__SQLOPERATIONS_H
@@ -28,6 +28,7 @@
 #include <iostream>
 #include <thread>
 #include <cstdarg>
+#include <algorithm>
 
 #include <boost/stacktrace.hpp>
 
@@ -68,9 +69,90 @@ enum LogType
 
 const int LogType_count = int(LogError) + 1;
 
+enum LogConsole
+{
+    LOG_CONSOLE_NONE   = 0,
+    LOG_CONSOLE_STDOUT = 1,
+    LOG_CONSOLE_STDERR = 2
+};
+
+struct LogRecord
+{
+    time_t time;
+    uint8 type;                                             // LogType, selects the console color
+    uint8 console;                                          // LogConsole
+    bool toLogfile;
+    FILE* extraFile;                                        // specific error log, gets the text without prefix
+    size_t prefixLength;                                    // logfile only prefix at the start of text
+    std::string text;
+};
+
+// Single producer (the owning thread), single consumer (the writer thread) ring of log records.
+// Slots keep their string capacity, so a warmed up ring formats messages without allocating.
+class LogRing
+{
+    public:
+        explicit LogRing(size_t size) : m_records(size), m_mask(size - 1), m_head(0), m_tail(0), m_orphaned(false) {}
+
+        LogRecord* Reserve()
+        {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) > m_mask)
+                return nullptr;
+
+            return &m_records[head & m_mask];
+        }
+
+        void Commit() { m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+        template<typename F>
+        size_t Drain(F const& write)
+        {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            size_t head = m_head.load(std::memory_order_acquire);
+            size_t count = head - tail;
+
+            for (; tail != head; ++tail)
+                write(m_records[tail & m_mask]);
+
+            m_tail.store(tail, std::memory_order_release);
+            return count;
+        }
+
+        bool IsEmpty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+
+        // set when the owning thread exits, the writer drops the ring once it is drained
+        void SetOrphaned() { m_orphaned = true; }
+        bool IsOrphaned() const { return m_orphaned; }
+
+    private:
+        std::vector<LogRecord> m_records;
+        size_t m_mask;
+        std::atomic<size_t> m_head;
+        std::atomic<size_t> m_tail;
+        std::atomic<bool> m_orphaned;
+};
+
+namespace
+{
+    struct LogRingHolder
+    {
+        std::shared_ptr<LogRing> ring;
+
+        ~LogRingHolder()
+        {
+            if (ring)
+                ring->SetOrphaned();
+        }
+    };
+
+    thread_local LogRingHolder t_logRing;
+}
+
 Log::Log() :
     raLogfile(nullptr), logfile(nullptr), gmLogfile(nullptr), charLogfile(nullptr), dberLogfile(nullptr),
-    eventAiErLogfile(nullptr), scriptErrLogFile(nullptr), worldLogfile(nullptr), customLogFile(nullptr), m_colored(false), m_includeTime(false), m_gmlog_per_account(false), m_scriptLibName(nullptr)
+    eventAiErLogfile(nullptr), scriptErrLogFile(nullptr), worldLogfile(nullptr), customLogFile(nullptr), m_colored(false), m_includeTime(false), m_gmlog_per_account(false), m_scriptLibName(nullptr),
+    m_scriptLibErrorPrefix("<Scripting Library ERROR>: "), m_async(false), m_asyncQueueSize(0), m_asyncOverflow(LOG_OVERFLOW_DROP), m_asyncStop(false), m_asyncDropped(0), m_asyncDroppedTotal(0)
 {
     Initialize();
 }
@@ -287,6 +369,14 @@ void Log::Initialize()
 
     // Char log settings
     m_charLog_Dump = sConfig.GetBoolDefault("CharLogDump", false);
+
+    // Async mode settings, the writer thread is kept on re-initialization
+    if (!m_async && sConfig.GetBoolDefault("LogAsync", false))
+    {
+        int32 queueSize = sConfig.GetIntDefault("LogAsyncQueueSize", 1024);
+        int32 overflow = sConfig.GetIntDefault("LogAsyncOverflow", LOG_OVERFLOW_DROP);
+        StartAsync(queueSize > 0 ? uint32(queueSize) : 1024, overflow == LOG_OVERFLOW_BLOCK ? LOG_OVERFLOW_BLOCK : LOG_OVERFLOW_DROP);
+    }
 }
 
 FILE* Log::openLogFile(char const* configFileName, char const* configTimeStampFlag, char const* mode)
@@ -319,7 +409,11 @@ FILE* Log::openGmlogPerAccount(uint32 account)
 
 void Log::outTimestamp(FILE* file)
 {
-    time_t t = time(nullptr);
+    outTimestamp(file, time(nullptr));
+}
+
+void Log::outTimestamp(FILE* file, time_t t)
+{
     tm* aTm = localtime(&t);
     //       YYYY   year
     //       MM     month (2 digits 01-12)
@@ -362,6 +456,12 @@ std::string Log::GetTimestampStr()
 
 void Log::outString()
 {
+    if (m_async)
+    {
+        QueueRecord(LogNormal, LOG_CONSOLE_STDOUT, logfile != nullptr, "", nullptr, "%s", "");
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(m_worldLogMtx);
     if (m_includeTime)
         outTime();
@@ -381,6 +481,15 @@ void Log::outString(const char* str, ...)
     if (!str)
         return;
 
+    if (m_async)
+    {
+        va_list ap;
+        va_start(ap, str);
+        QueueRecord(LogNormal, LOG_CONSOLE_STDOUT, logfile != nullptr, "", nullptr, str, ap);
+        va_end(ap);
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(m_worldLogMtx);
 
     if (m_colored)
@@ -420,6 +529,15 @@ void Log::outError(const char* err, ...)
     if (!err)
         return;
 
+    if (m_async)
+    {
+        va_list ap;
+        va_start(ap, err);
+        QueueRecord(LogError, LOG_CONSOLE_STDERR, logfile != nullptr, "ERROR:", nullptr, err, ap);
+        va_end(ap);
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(m_worldLogMtx);
 
     if (m_colored)
@@ -456,6 +574,12 @@ void Log::outError(const char* err, ...)
 
 void Log::outErrorDb()
 {
+    if (m_async)
+    {
+        QueueRecord(LogError, LOG_CONSOLE_STDERR, logfile != nullptr, "ERROR:", dberLogfile, "%s", "");
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(m_worldLogMtx);
 
     if (m_includeTime)
@@ -485,6 +609,15 @@ void Log::outErrorDb(const char* err, ...)
     if (!err)
         return;
 
+    if (m_async)
+    {
+        va_list ap;
+        va_start(ap, err);
+        QueueRecord(LogError, LOG_CONSOLE_STDERR, logfile != nullptr, "ERROR:", dberLogfile, err, ap);
+        va_end(ap);
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(m_worldLogMtx);
 
     if (m_colored)
@@ -535,6 +668,12 @@ void Log::outErrorDb(const char* err, ...)
 
 void Log::outErrorEventAI()
 {
+    if (m_async)
+    {
+        QueueRecord(LogError, LOG_CONSOLE_STDERR, logfile != nullptr, "ERROR CreatureEventAI", eventAiErLogfile, "%s", "");
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(m_worldLogMtx);
 
     if (m_includeTime)
@@ -564,6 +703,15 @@ void Log::outErrorEventAI(const char* err, ...)
     if (!err)
         return;
 
+    if (m_async)
+    {
+        va_list ap;
+        va_start(ap, err);
+        QueueRecord(LogError, LOG_CONSOLE_STDERR, logfile != nullptr, "ERROR CreatureEventAI: ", eventAiErLogfile, err, ap);
+        va_end(ap);
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(m_worldLogMtx);
     if (m_colored)
         SetColor(false, m_colors[LogError]);
@@ -616,6 +764,20 @@ void Log::outBasic(const char* str, ...)
     if (!str)
         return;
 
+    if (m_async)
+    {
+        uint8 console = m_logLevel >= LOG_LVL_BASIC ? LOG_CONSOLE_STDOUT : LOG_CONSOLE_NONE;
+        bool toLogfile = logfile && m_logFileLevel >= LOG_LVL_BASIC;
+        if (console == LOG_CONSOLE_NONE && !toLogfile)
+            return;
+
+        va_list ap;
+        va_start(ap, str);
+        QueueRecord(LogDetails, console, toLogfile, "", nullptr, str, ap);
+        va_end(ap);
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(m_worldLogMtx);
     if (m_logLevel >= LOG_LVL_BASIC)
     {
@@ -655,6 +817,20 @@ void Log::outDetail(const char* str, ...)
     if (!str)
         return;
 
+    if (m_async)
+    {
+        uint8 console = m_logLevel >= LOG_LVL_DETAIL ? LOG_CONSOLE_STDOUT : LOG_CONSOLE_NONE;
+        bool toLogfile = logfile && m_logFileLevel >= LOG_LVL_DETAIL;
+        if (console == LOG_CONSOLE_NONE && !toLogfile)
+            return;
+
+        va_list ap;
+        va_start(ap, str);
+        QueueRecord(LogDetails, console, toLogfile, "", nullptr, str, ap);
+        va_end(ap);
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(m_worldLogMtx);
     if (m_logLevel >= LOG_LVL_DETAIL)
     {
@@ -696,6 +872,20 @@ void Log::outDebug(const char* str, ...)
     if (!str)
         return;
 
+    if (m_async)
+    {
+        uint8 console = m_logLevel >= LOG_LVL_DEBUG ? LOG_CONSOLE_STDOUT : LOG_CONSOLE_NONE;
+        bool toLogfile = logfile && m_logFileLevel >= LOG_LVL_DEBUG;
+        if (console == LOG_CONSOLE_NONE && !toLogfile)
+            return;
+
+        va_list ap;
+        va_start(ap, str);
+        QueueRecord(LogDebug, console, toLogfile, "", nullptr, str, ap);
+        va_end(ap);
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(m_worldLogMtx);
     if (m_logLevel >= LOG_LVL_DEBUG)
     {
@@ -815,6 +1005,12 @@ void Log::outChar(const char* str, ...)
 
 void Log::outErrorScriptLib()
 {
+    if (m_async)
+    {
+        QueueRecord(LogError, LOG_CONSOLE_STDERR, logfile != nullptr, m_scriptLibErrorPrefix.c_str(), scriptErrLogFile, "%s", "");
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(m_worldLogMtx);
     if (m_includeTime)
         outTime();
@@ -846,6 +1042,15 @@ void Log::outErrorScriptLib(const char* err, ...)
     if (!err)
         return;
 
+    if (m_async)
+    {
+        va_list ap;
+        va_start(ap, err);
+        QueueRecord(LogError, LOG_CONSOLE_STDERR, logfile != nullptr, m_scriptLibErrorPrefix.c_str(), scriptErrLogFile, err, ap);
+        va_end(ap);
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(m_worldLogMtx);
     if (m_colored)
         SetColor(false, m_colors[LogError]);
@@ -973,6 +1178,211 @@ void Log::outCustomLog(const char* str, ...)
     fflush(stdout);
 }
 
+void Log::StartAsync(uint32 queueSize, LogOverflowPolicy overflow)
+{
+    // ring indexes are masked, round up to a power of two
+    uint32 size = 64;
+    while (size < queueSize)
+        size <<= 1;
+
+    m_asyncQueueSize = size;
+    m_asyncOverflow = overflow;
+    m_asyncStop = false;
+    m_asyncWriter = std::thread(&Log::AsyncWriterThread, this);
+    m_async = true;
+}
+
+void Log::StopAsync()
+{
+    if (!m_async)
+        return;
+
+    m_asyncStop = true;
+    m_asyncWake.notify_one();
+    m_asyncWriter.join();
+    m_async = false;
+}
+
+LogRing* Log::GetThreadRing()
+{
+    if (!t_logRing.ring)
+    {
+        t_logRing.ring = std::make_shared<LogRing>(m_asyncQueueSize);
+
+        std::lock_guard<std::mutex> guard(m_asyncRingsMtx);
+        m_asyncRings.push_back(t_logRing.ring);
+    }
+
+    return t_logRing.ring.get();
+}
+
+void Log::QueueRecord(uint8 type, uint8 console, bool toLogfile, char const* prefix, FILE* extraFile, char const* format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    QueueRecord(type, console, toLogfile, prefix, extraFile, format, ap);
+    va_end(ap);
+}
+
+void Log::QueueRecord(uint8 type, uint8 console, bool toLogfile, char const* prefix, FILE* extraFile, char const* format, va_list ap)
+{
+    LogRing* ring = GetThreadRing();
+
+    LogRecord* record = ring->Reserve();
+    while (!record)
+    {
+        if (m_asyncOverflow == LOG_OVERFLOW_DROP || m_asyncStop)
+        {
+            ++m_asyncDropped;
+            ++m_asyncDroppedTotal;
+            return;
+        }
+
+        m_asyncWake.notify_one();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        record = ring->Reserve();
+    }
+
+    record->time = time(nullptr);
+    record->type = type;
+    record->console = console;
+    record->toLogfile = toLogfile;
+    record->extraFile = extraFile;
+
+    // format straight into the slot string, reusing its capacity from earlier messages
+    std::string& text = record->text;
+    text.assign(prefix);
+    record->prefixLength = text.size();
+
+    va_list apCopy;
+    va_copy(apCopy, ap);
+
+    size_t available = std::max<size_t>(text.capacity(), 256) - record->prefixLength;
+    text.resize(record->prefixLength + available);
+    int length = vsnprintf(&text[record->prefixLength], available + 1, format, ap);
+    if (length < 0)
+        length = 0;
+    else if (size_t(length) > available)
+    {
+        text.resize(record->prefixLength + length);
+        vsnprintf(&text[record->prefixLength], length + 1, format, apCopy);
+    }
+    text.resize(record->prefixLength + length);
+
+    va_end(apCopy);
+
+    ring->Commit();
+}
+
+void Log::WriteRecord(LogRecord const& record)
+{
+    if (record.console != LOG_CONSOLE_NONE)
+    {
+        bool stdout_stream = record.console == LOG_CONSOLE_STDOUT;
+        FILE* out = stdout_stream ? stdout : stderr;
+
+        if (m_colored)
+            SetColor(stdout_stream, m_colors[record.type]);
+
+        if (m_includeTime)
+        {
+            tm* aTm = localtime(&record.time);
+            printf("%02d:%02d:%02d ", aTm->tm_hour, aTm->tm_min, aTm->tm_sec);
+        }
+
+        utf8printf(out, "%s", record.text.c_str() + record.prefixLength);
+
+        if (m_colored)
+            ResetColor(stdout_stream);
+
+        fprintf(out, "\n");
+    }
+
+    if (record.toLogfile && logfile)
+    {
+        outTimestamp(logfile, record.time);
+        fprintf(logfile, "%s\n", record.text.c_str());
+    }
+
+    if (record.extraFile)
+    {
+        outTimestamp(record.extraFile, record.time);
+        fprintf(record.extraFile, "%s\n", record.text.c_str() + record.prefixLength);
+    }
+}
+
+void Log::AsyncWriterThread()
+{
+    std::vector<std::shared_ptr<LogRing>> rings;
+    std::vector<FILE*> touchedFiles;
+
+    while (true)
+    {
+        // read the flag before draining so nothing queued ahead of the stop request is lost
+        bool stop = m_asyncStop;
+
+        {
+            std::lock_guard<std::mutex> guard(m_asyncRingsMtx);
+            rings = m_asyncRings;
+        }
+
+        size_t written = 0;
+        {
+            // sync only outputs (gm, char, packet logs) still write under this lock
+            std::lock_guard<std::mutex> guard(m_worldLogMtx);
+
+            for (auto& ring : rings)
+            {
+                written += ring->Drain([&](LogRecord const& record)
+                {
+                    WriteRecord(record);
+                    if (record.extraFile && std::find(touchedFiles.begin(), touchedFiles.end(), record.extraFile) == touchedFiles.end())
+                        touchedFiles.push_back(record.extraFile);
+                });
+            }
+
+            if (uint64 dropped = m_asyncDropped.exchange(0))
+            {
+                LogRecord record = { time(nullptr), LogError, LOG_CONSOLE_STDERR, true, nullptr, 6, "ERROR:Async log queue full, " + std::to_string(dropped) + " messages dropped" };
+                WriteRecord(record);
+                ++written;
+            }
+
+            // one flush per batch instead of one per message
+            if (written)
+            {
+                if (logfile)
+                    fflush(logfile);
+
+                for (FILE* file : touchedFiles)
+                    fflush(file);
+                touchedFiles.clear();
+
+                fflush(stdout);
+                fflush(stderr);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(m_asyncRingsMtx);
+            m_asyncRings.erase(std::remove_if(m_asyncRings.begin(), m_asyncRings.end(), [](std::shared_ptr<LogRing> const& ring)
+            {
+                return ring->IsOrphaned() && ring->IsEmpty();
+            }), m_asyncRings.end());
+        }
+        rings.clear();
+
+        if (stop)
+            break;
+
+        if (!written)
+        {
+            std::unique_lock<std::mutex> lock(m_asyncWakeMtx);
+            m_asyncWake.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+}
+
 void Log::WaitBeforeContinueIfNeed()
 {
     int mode = sConfig.GetIntDefault("WaitAtStartupError", 0);
@@ -999,6 +1409,7 @@ void Log::WaitBeforeContinueIfNeed()
 void Log::setScriptLibraryErrorFile(char const* fname, char const* libName)
 {
     m_scriptLibName = libName;
+    m_scriptLibErrorPrefix = libName ? std::string("<") + libName + " ERROR>: " : "<Scripting Library ERROR>: ";
 
     if (scriptErrLogFile)
         fclose(scriptErrLogFile);
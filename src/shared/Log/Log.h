@@ -22,10 +22,18 @@
 #include "Common.h"
 #include "Policies/Singleton.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 class Config;
 class ByteBuffer;
+class LogRing;
+struct LogRecord;
 
 enum LogLevel
 {
@@ -93,6 +101,13 @@ enum Color
 
 const int Color_count = int(WHITE) + 1;
 
+// what a thread does when its async log queue is full
+enum LogOverflowPolicy
+{
+    LOG_OVERFLOW_DROP  = 0,                                 // discard the message and count it
+    LOG_OVERFLOW_BLOCK = 1                                  // wait for the writer thread to make room
+};
+
 class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, std::mutex> >
 {
         friend class MaNGOS::OperatorNew<Log>;
@@ -100,6 +115,8 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, std::m
 
         ~Log()
         {
+            StopAsync();
+
             if (logfile != nullptr)
                 fclose(logfile);
             logfile = nullptr;
@@ -194,10 +211,24 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, std::m
 
         void traceLog();
 
+        bool IsAsync() const { return m_async; }
+        uint64 GetAsyncDroppedCount() const { return m_asyncDroppedTotal; }
+
     private:
         FILE* openLogFile(char const* configFileName, char const* configTimeStampFlag, char const* mode);
         FILE* openGmlogPerAccount(uint32 account);
 
+        static void outTimestamp(FILE* file, time_t t);
+
+        // async mode: formatted records go to a per thread ring and are written in batches by m_asyncWriter
+        void StartAsync(uint32 queueSize, LogOverflowPolicy overflow);
+        void StopAsync();
+        void QueueRecord(uint8 type, uint8 console, bool toLogfile, char const* prefix, FILE* extraFile, char const* format, va_list ap);
+        void QueueRecord(uint8 type, uint8 console, bool toLogfile, char const* prefix, FILE* extraFile, char const* format, ...) ATTR_PRINTF(7, 8);
+        LogRing* GetThreadRing();
+        void AsyncWriterThread();
+        void WriteRecord(LogRecord const& record);
+
         FILE* raLogfile;
         FILE* logfile;
         FILE* gmLogfile;
@@ -231,6 +262,20 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, std::m
         std::string m_gmlog_filename_format;
 
         char const* m_scriptLibName;
+        std::string m_scriptLibErrorPrefix;
+
+        // async mode control
+        bool m_async;
+        uint32 m_asyncQueueSize;
+        LogOverflowPolicy m_asyncOverflow;
+        std::vector<std::shared_ptr<LogRing>> m_asyncRings;
+        std::mutex m_asyncRingsMtx;
+        std::thread m_asyncWriter;
+        std::atomic<bool> m_asyncStop;
+        std::mutex m_asyncWakeMtx;
+        std::condition_variable m_asyncWake;
+        std::atomic<uint64> m_asyncDropped;                 // dropped since the writer last reported it
+        std::atomic<uint64> m_asyncDroppedTotal;
 };
 
 #define sLog MaNGOS::Singleton<Log>::Instance()
@@ -39,9 +39,12 @@ namespace MaNGOS
             void ReadUntil(std::string& buffer, char delimiter, std::function<void(const boost::system::error_code&, std::size_t)>&& callback);
             void ReadSkip(size_t skipSize, std::function<void(const boost::system::error_code&, std::size_t)>&& callback);
             void Write(const char* buffer, size_t length, std::function<void(const boost::system::error_code&, std::size_t)>&& callback);
+            // gather write, the buffers have to stay valid until the callback is called
+            void Write(std::vector<boost::asio::const_buffer> const& buffers, std::function<void(const boost::system::error_code&, std::size_t)>&& callback);
 
             bool Start();
-            void Close()
+            // derived sockets may delay closing, AsyncSocket::Close() closes at once
+            virtual void Close()
             {
                 std::lock_guard<std::mutex> guard(m_closeMutex);
                 if (IsClosed())
@@ -114,6 +117,12 @@ namespace MaNGOS
         boost::asio::async_write(m_socket, boost::asio::buffer(buffer, length), callback);
     }
 
+    template <typename SocketType>
+    void MaNGOS::AsyncSocket<SocketType>::Write(std::vector<boost::asio::const_buffer> const& buffers, std::function<void(const boost::system::error_code&, std::size_t)>&& callback)
+    {
+        boost::asio::async_write(m_socket, buffers, callback);
+    }
+
     template <typename SocketType>
     bool MaNGOS::AsyncSocket<SocketType>::AsyncSocket::Start()
     {